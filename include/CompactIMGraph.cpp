@@ -0,0 +1,68 @@
+#include <CompactIMGraph.h>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+CompactIMGraph::CompactIMGraph(const std::vector<degree_t> &degreeSequence)
+    : CompactIMGraph(std::accumulate(degreeSequence.cbegin(), degreeSequence.cend(), int_t(0)) / 2)
+{ }
+
+CompactIMGraph::CompactIMGraph(int_t num_edges) {
+    if (UNLIKELY(num_edges > CompactIMGraph::maxEdges())) {
+        throw std::runtime_error("Error, too many edges for internal graph. The compact internal graph supports at maximum 4 billion edges");
+    }
+
+    _edges.reserve(num_edges);
+
+    const uint64_t size = _table_size(num_edges);
+    _table.assign(size, edge_ref_t(_empty_ref));
+    _mask = size - 1;
+    _shift = 64;
+    for (uint64_t s = size; s > 1; s /= 2)
+        --_shift;
+}
+
+SwapResult CompactIMGraph::swapEdges(const edgeid_t eid0, const edgeid_t eid1, bool direction) {
+    SwapResult result;
+
+    const edge_t e[2] = {_edges[eid0], _edges[eid1]};
+    edge_t t[2];
+    std::tie(t[0], t[1]) = _swap_edges(e[0], e[1], direction);
+
+    result.edges[0] = t[0];
+    result.edges[1] = t[1];
+
+    // check for conflict: loop
+    if (t[0].first == t[0].second || t[1].first == t[1].second) {
+        result.loop = true;
+    } else { // check for conflict edges
+        result.loop = false;
+        for (unsigned char pos = 0; pos < 2; ++pos) {
+            result.conflictDetected[pos] = hasEdge(t[pos].first, t[pos].second);
+        }
+    }
+
+    result.performed = !result.loop && !(result.conflictDetected[0] || result.conflictDetected[1]);
+
+    if (result.performed) {
+        _erase_ref(static_cast<edge_ref_t>(eid0));
+        _erase_ref(static_cast<edge_ref_t>(eid1));
+
+        _edges[eid0] = t[0];
+        _edges[eid1] = t[1];
+
+        _insert_ref(static_cast<edge_ref_t>(eid0));
+        _insert_ref(static_cast<edge_ref_t>(eid1));
+
+        assert(hasEdge(t[0].first, t[0].second) && hasEdge(t[1].first, t[1].second));
+        assert(!hasEdge(e[0].first, e[0].second) && !hasEdge(e[1].first, e[1].second));
+    }
+
+    result.normalize();
+
+    return result;
+}
+
+CompactIMGraph::IMEdgeStream CompactIMGraph::getEdges() const {
+    return IMEdgeStream(*this);
+}
@@ -0,0 +1,197 @@
+/**
+ * @file
+ * @brief Internal memory graph with hashed edge existence in O(|E|) space
+ * @copyright to be decided
+ */
+#pragma once
+#include <vector>
+#include <cassert>
+#include <limits>
+#include <defs.h>
+#include <stxxl/random>
+#include <EdgeSwaps/EdgeSwapBase.h>
+
+/**
+ * @brief Drop-in alternative to IMGraph without an adjacency matrix.
+ *
+ * The edges are stored as an edge-id-indexed array of normalized edges. Existence is
+ * answered by a linear probing hash table which contains 32 bit edge ids (the key of an
+ * entry is the edge it refers to), so no node needs a dedicated adjacency structure.
+ * Removals use backward shifting, hence the table does not degrade during swaps.
+ * The memory consumption is 8 bytes per edge plus 5.3 to 10.7 bytes per edge for the table,
+ * independent of the degree sequence.
+ */
+class CompactIMGraph : private EdgeSwapBase {
+private:
+    class IMEdgeStream {
+    private:
+        const CompactIMGraph &_graph;
+        size_t pos;
+    public:
+        IMEdgeStream(const CompactIMGraph &graph) : _graph(graph), pos(0) {}
+
+        const edge_t & operator * () const {
+            return _graph._edges[pos];
+        };
+
+        const edge_t * operator -> () const {
+            return &_graph._edges[pos];
+        };
+
+        IMEdgeStream & operator++ () {
+            ++pos;
+            return *this;
+        }
+
+        bool empty() const {
+            return pos >= _graph.numEdges();
+        };
+    };
+
+    using edge_ref_t = uint32_t;
+    constexpr static edge_ref_t _empty_ref = std::numeric_limits<edge_ref_t>::max();
+
+    std::vector<edge_t> _edges;
+    std::vector<edge_ref_t> _table;
+    uint64_t _mask;
+    unsigned int _shift;
+    stxxl::random_number64 _random_integer;
+
+    static uint64_t _table_size(uint_t numEdges) {
+        // load factor at most 3/4
+        uint64_t size = 1;
+        while (3 * size < 4 * numEdges + 4) size *= 2;
+        return size;
+    }
+
+    uint64_t _home(const edge_t & e) const {
+        const uint64_t key = (static_cast<uint64_t>(e.first) << 32) | static_cast<uint32_t>(e.second);
+        return (key * 0x9E3779B97F4A7C15llu) >> _shift;
+    }
+
+    //! Returns the slot referring to e or the empty slot terminating its probe sequence
+    uint64_t _find_slot(const edge_t & e) const {
+        uint64_t pos = _home(e);
+        while (_table[pos] != _empty_ref && _edges[_table[pos]] != e)
+            pos = (pos + 1) & _mask;
+        return pos;
+    }
+
+    void _insert_ref(edge_ref_t eid) {
+        const uint64_t pos = _find_slot(_edges[eid]);
+        assert(_table[pos] == _empty_ref);
+        _table[pos] = eid;
+    }
+
+    //! Removes the reference to eid; _edges[eid] has to be unchanged since the insertion
+    void _erase_ref(edge_ref_t eid) {
+        uint64_t hole = _find_slot(_edges[eid]);
+        assert(_table[hole] == eid);
+
+        // backward shift: move entries whose home is not in (hole, pos] into the hole
+        for (uint64_t pos = (hole + 1) & _mask; _table[pos] != _empty_ref; pos = (pos + 1) & _mask) {
+            const uint64_t home = _home(_edges[_table[pos]]);
+            const bool stays = (hole <= pos) ? (hole < home && home <= pos)
+                                             : (hole < home || home <= pos);
+            if (!stays) {
+                _table[hole] = _table[pos];
+                hole = pos;
+            }
+        }
+
+        _table[hole] = _empty_ref;
+    }
+
+public:
+    /**
+     * Constructs a new internal memory graph; the degree sequence is only used to reserve memory.
+     */
+    CompactIMGraph(const std::vector<degree_t> &degreeSequence);
+
+    /**
+     * Constructs a new internal memory graph with room for the given number of edges.
+     */
+    explicit CompactIMGraph(int_t numEdges);
+
+    /**
+     * Adds a new edge to the graph.
+     *
+     * The caller must ensure that the edge does not exist yet. The edge is stored normalized.
+     *
+     * @param e The edge to add
+     */
+    void addEdge(edge_t e) {
+        e.normalize();
+        assert(!hasEdge(e.first, e.second));
+        assert(_edges.size() < static_cast<size_t>(maxEdges()));
+
+        _edges.push_back(e);
+        _insert_ref(static_cast<edge_ref_t>(_edges.size() - 1));
+    }
+
+    /**
+     * Get a random edge id.
+     *
+     * @return A random edge id
+     */
+    edgeid_t randomEdge() const {
+        return _random_integer(_edges.size());
+    }
+
+    /**
+     * Get the edge that is identified by the given edge id.
+     *
+     * @param eid The id fo the edge to return
+     * @return The requested (normalized) edge
+     */
+    edge_t getEdge(edgeid_t eid) const {
+        return _edges[eid];
+    }
+
+    static constexpr int_t maxEdges() {
+        return std::numeric_limits<edge_ref_t>::max() - 1;
+    }
+
+    static uint_t memoryUsage(uint_t numNodes, uint_t numEdges) {
+        stxxl::STXXL_UNUSED(numNodes);
+        return sizeof(edge_t) * numEdges + sizeof(edge_ref_t) * _table_size(numEdges) + sizeof(CompactIMGraph);
+    }
+
+    /**
+     * Checks if the given edge exists in expected constant time.
+     *
+     * @param u The source node
+     * @param v The target node
+     * @return If the edge exists
+     */
+    bool hasEdge(node_t u, node_t v) const {
+        edge_t e(u, v);
+        e.normalize();
+        return _table[_find_slot(e)] != _empty_ref;
+    }
+
+    /**
+     * Get the number of edges the graph has.
+     *
+     * @return The number of edges.
+     */
+    uint_t numEdges() const {
+        return _edges.size();
+    }
+
+    /**
+     * Swap the two edges that are identified by the given edge ids.
+     *
+     * @param eid0 The id of the first swap candidate
+     * @param eid1 The id of the second swap candidate
+     * @return If the swap was successfull, i.e. did not create any conflict.
+     */
+    SwapResult swapEdges(const edgeid_t eid0, const edgeid_t eid1, bool direction);
+
+    /**
+     * Get a stream of normalized edges. The edges are unsorted.
+     *
+     * @return An implementation of the STXXL stream interface with all normalized edges (unsorted).
+     */
+    IMEdgeStream getEdges() const;
+};
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @brief Checkpoints of EM-Curveball between two global trades
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "defs.h"
+
+namespace Curveball {
+
+	/**
+	 * File layout of a checkpoint:
+	 * header, the hash-functions of the remaining rounds (the current one
+	 * first, the identity last) and the messages of the current round as
+	 * <target, neighbour> pairs.
+	 * The targets are hashed by the current hash-function, hence if only the
+	 * identity remains, i.e. the run is finished, the messages are the edges.
+	 */
+	struct EMCheckpointHeader {
+		static constexpr uint64_t MAGIC = 0x3130544b43424d45ull; // "EMBCKT01"
+
+		uint64_t magic = MAGIC;
+		uint64_t num_msgs = 0;
+		uint32_t hash_size = 0;
+		uint32_t num_hash_funcs = 0;
+		node_t num_nodes = 0;
+		uint32_t padding = 0;
+	};
+
+	/**
+	 * Writes a checkpoint; the messages are received by push() as provided
+	 * by EMDualContainer::forward_unsorted_edges(). The file is written to a
+	 * temporary file first and replaces the previous checkpoint in finish(),
+	 * so an interruption never leaves a partial checkpoint behind.
+	 * @tparam HashFactory Type of hash-functions, has to be trivially copyable.
+	 */
+	template <typename HashFactory>
+	class EMCheckpointWriter {
+		static_assert(std::is_trivially_copyable<HashFactory>::value,
+					  "Hash-functions are stored bytewise in checkpoints");
+
+	protected:
+		static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+		const std::string _filename;
+		const std::string _tmp_filename;
+		std::ofstream _out;
+		EMCheckpointHeader _header;
+		std::vector<NeighbourMsg> _buffer;
+
+		void _flush() {
+			_out.write(reinterpret_cast<const char*>(_buffer.data()),
+					   static_cast<std::streamsize>(_buffer.size() * sizeof(NeighbourMsg)));
+			_buffer.clear();
+		}
+
+		//! Forces the temporary file to the disk, otherwise the rename may
+		//! survive a crash while the contents do not
+		bool _sync() const {
+			const int fd = ::open(_tmp_filename.c_str(), O_RDONLY);
+			if (fd < 0)
+				return false;
+
+			const bool synced = !::fsync(fd);
+			return !::close(fd) && synced;
+		}
+
+	public:
+		/**
+		 * @param filename Name of the checkpoint.
+		 * @param num_nodes Number of nodes.
+		 * @param hash_funcs Hash-functions from the current round on.
+		 */
+		EMCheckpointWriter(const std::string &filename,
+						   const node_t num_nodes,
+						   const std::vector<HashFactory> &hash_funcs)
+			: _filename(filename),
+			  _tmp_filename(filename + ".tmp"),
+			  _out(_tmp_filename, std::ios::trunc | std::ios::binary) {
+			if (!_out)
+				throw std::runtime_error("Error, cannot write Curveball checkpoint " + _tmp_filename);
+
+			_header.hash_size = sizeof(HashFactory);
+			_header.num_hash_funcs = static_cast<uint32_t>(hash_funcs.size());
+			_header.num_nodes = num_nodes;
+
+			// the number of messages is patched in finish()
+			_out.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+			_out.write(reinterpret_cast<const char*>(hash_funcs.data()),
+					   static_cast<std::streamsize>(hash_funcs.size() * sizeof(HashFactory)));
+
+			_buffer.reserve(BUFFER_SIZE);
+		}
+
+		void push(const edge_t &msg) {
+			_buffer.emplace_back(msg.first, msg.second);
+			_header.num_msgs++;
+
+			if (_buffer.size() == BUFFER_SIZE)
+				_flush();
+		}
+
+		/**
+		 * Completes the checkpoint and replaces the previous one.
+		 */
+		void finish() {
+			_flush();
+
+			_out.seekp(0);
+			_out.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+			_out.close();
+
+			if (!_out || !_sync() || std::rename(_tmp_filename.c_str(), _filename.c_str()))
+				throw std::runtime_error("Error, cannot write Curveball checkpoint " + _filename);
+		}
+	};
+
+	/**
+	 * Reads a checkpoint written by EMCheckpointWriter, the messages are
+	 * provided by a reading streaming interface.
+	 * @tparam HashFactory Type of hash-functions used to write the checkpoint.
+	 */
+	template <typename HashFactory>
+	class EMCheckpointReader {
+	protected:
+		static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+		std::ifstream _in;
+		EMCheckpointHeader _header;
+		std::vector<HashFactory> _hash_funcs;
+
+		std::vector<NeighbourMsg> _buffer;
+		size_t _buffer_pos = 0;
+		uint64_t _num_unread_msgs = 0;
+
+		void _fill() {
+			const auto num_msgs = static_cast<size_t>(std::min<uint64_t>(_num_unread_msgs, BUFFER_SIZE));
+			_buffer.resize(num_msgs);
+			_in.read(reinterpret_cast<char*>(_buffer.data()),
+					 static_cast<std::streamsize>(num_msgs * sizeof(NeighbourMsg)));
+			if (!_in)
+				throw std::runtime_error("Error, Curveball checkpoint is truncated");
+
+			_num_unread_msgs -= num_msgs;
+			_buffer_pos = 0;
+		}
+
+	public:
+		/**
+		 * @param filename Name of the checkpoint.
+		 */
+		explicit EMCheckpointReader(const std::string &filename)
+			: _in(filename, std::ios::binary) {
+			if (!_in)
+				throw std::runtime_error("Error, cannot read Curveball checkpoint " + filename);
+
+			_in.read(reinterpret_cast<char*>(&_header), sizeof(_header));
+			if (!_in || _header.magic != EMCheckpointHeader::MAGIC)
+				throw std::runtime_error("Error, " + filename + " is no Curveball checkpoint");
+			if (_header.hash_size != sizeof(HashFactory) || !_header.num_hash_funcs)
+				throw std::runtime_error("Error, Curveball checkpoint " + filename + " uses other hash-functions");
+
+			_hash_funcs.resize(_header.num_hash_funcs);
+			_in.read(reinterpret_cast<char*>(_hash_funcs.data()),
+					 static_cast<std::streamsize>(_hash_funcs.size() * sizeof(HashFactory)));
+
+			_num_unread_msgs = _header.num_msgs;
+			_fill();
+		}
+
+		node_t num_nodes() const {
+			return _header.num_nodes;
+		}
+
+		edgeid_t num_msgs() const {
+			return static_cast<edgeid_t>(_header.num_msgs);
+		}
+
+		//! Number of global trades the checkpointed run has not yet processed
+		tradeid_t remaining_rounds() const {
+			return static_cast<tradeid_t>(_hash_funcs.size() - 1);
+		}
+
+		//! Hash-functions from the current round on, the last one is the identity
+		const std::vector<HashFactory> &hash_funcs() const {
+			return _hash_funcs;
+		}
+
+		const NeighbourMsg &operator*() const {
+			assert(!empty());
+			return _buffer[_buffer_pos];
+		}
+
+		EMCheckpointReader &operator++() {
+			assert(!empty());
+			if (++_buffer_pos == _buffer.size() && _num_unread_msgs)
+				_fill();
+			return *this;
+		}
+
+		bool empty() const {
+			return _buffer_pos == _buffer.size();
+		}
+	};
+
+}
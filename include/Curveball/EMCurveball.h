@@ -17,6 +17,11 @@
 #include <GenericComparator.h>
 #include "Utils/Hashfuncs.h"
 #include "EMTargetInformation.h"
+#include "EMParameterEstimation.h"
+#include "EMCheckpoint.h"
+#include "EdgeRelabeller.h"
+#include <stdexcept>
+#include <string>
 
 namespace Curveball {
 
@@ -29,6 +34,7 @@ namespace Curveball {
 	 * 	- hash()
 	 * 	- min_value(), see STXXL comparator requirements
 	 * 	- max_value(), see STXXL comparator requirements
+	 * e.g. ModHash or FeistelHash, see Utils/NodeHash.h.
 	 *
 	 * InputStream has to support a reading streaming interface:
 	 * 	- operator*()
@@ -39,6 +45,10 @@ namespace Curveball {
 	 * 	- push()
 	 * 	- empty()
 	 *
+	 * With unsorted output the edges of the last round are pushed directly
+	 * into the receiver, e.g. an EdgeRelabeller mapping them to the caller's
+	 * node-ids, which saves the final sort.
+	 *
 	 * @tparam HashFactory
 	 * @tparam InputStream Incoming edges.
 	 * @tparam OutReceiver Randomized edge output
@@ -49,48 +59,8 @@ namespace Curveball {
 		using NodeSorter = stxxl::sorter<node_t, NodeComparator>;
 		using EdgeSorter = stxxl::sorter<edge_t, EdgeComparator>;
 
-		/**
-		 * Given the number of edges, number of nodes, number of global trade
-		 * rounds, the number of threads and the size of the internal memory
-		 * in Byte this class estimates (potentially) suboptimal internal
-		 * parameters.
-		 */
-		class ParameterEstimation {
-		public:
-			chunkid_t num_macrochunks() const   {return std::get<0>(_param_est);}
-			chunkid_t num_batches() const       {return std::get<1>(_param_est);}
-			chunkid_t num_fanout() const        {return std::get<2>(_param_est);}
-			size_t size_insertionbuffer() const {return std::get<3>(_param_est);}
-
-			ParameterEstimation() = default;
-			ParameterEstimation(const size_t mem, const edgeid_t num_edges, const int num_threads)
-					: _param_est(_compute(mem, num_edges, num_threads))
-			{}
-
-		protected:
-			using parameter_type = std::tuple<chunkid_t, chunkid_t, chunkid_t, size_t>;
-			const parameter_type _param_est;
-
-		protected:
-			parameter_type _compute(const size_t mem, const edgeid_t num_edges, const int num_threads) const {
-				const chunkid_t num_macrochunks = std::max(2u, static_cast<chunkid_t>(2*num_edges/mem));
-				const chunkid_t num_batches = 8 * num_macrochunks * num_threads;
-				const chunkid_t num_fanout = 1;
-				const size_t size_insertionbuffer = std::max(32ul, static_cast<size_t>(num_threads*16));
-
-				assert(num_batches < num_edges);
-
-				std::cout << "Using the following estimated parameters for Curveball:\n"
-						  << "num_macrochunks:     \t" << num_macrochunks << "\n"
-						  << "num batches:         \t" << num_batches << "\n"
-						  << "num_fanout:          \t" << num_fanout << "\n"
-						  << "size_insertionbuffer:\t" << size_insertionbuffer << std::endl;
-				return std::make_tuple(num_macrochunks, num_batches, num_fanout, size_insertionbuffer);
-			}
-		};
-
 	protected:
-		ParameterEstimation _param_est;
+		EMParameterEstimation _param_est;
 
 		InputStream &_edges;
 		DegreeInputStream &_degrees;
@@ -108,6 +78,12 @@ namespace Curveball {
 
 		EdgeSorter _edge_sorter;
 		const bool _sorted_output;
+		bool _compressed_msgs = false;
+		degree_t _min_heavy_trade_degree = MIN_HEAVY_TRADE_DEGREE;
+
+		std::string _checkpoint_file;
+		tradeid_t _checkpoint_interval = 1;
+		bool _keep_checkpoints = false;
 
 #ifndef NDEBUG
 		NodeSorter _debug_node_tokens;
@@ -186,6 +162,8 @@ namespace Curveball {
 		 * @param num_rounds Number of global trade rounds
 		 * @param mem Size of main memory in Byte
 		 * @param num_threads Number of threads
+		 * @param sorted_output Whether the edges are provided in sorted order
+		 * @param calibration Constants of the memory and I/O model used by the estimation
 		 */
 		EMCurveball(InputStream &edges,
 					DegreeInputStream &degrees,
@@ -194,9 +172,10 @@ namespace Curveball {
 					OutReceiver &out_edges,
 					const int num_threads,
 					const size_t mem,
-					const bool sorted_output
+					const bool sorted_output,
+					const CurveballCalibration &calibration = CurveballCalibration()
 		) :
-				_param_est(mem, edges.size(), num_threads),
+				_param_est(degrees, num_nodes, edges.size(), num_rounds, mem, num_threads, calibration),
 				_edges(edges),
 				_degrees(degrees),
 				_num_nodes(num_nodes),
@@ -225,6 +204,43 @@ namespace Curveball {
 			assert(_num_splits < _edges.size());
 		}
 
+		/**
+		 * Stores the messages of the macrochunks in compressed blocks, which
+		 * trades CPU time for less I/O volume per round.
+		 * @param compressed Flag whether to compress messages.
+		 */
+		void set_compressed_messages(const bool compressed) {
+			_compressed_msgs = compressed;
+		}
+
+		/**
+		 * Sets the number of neighbours a pair needs at least to be traded
+		 * by all threads together, pairs below are traded by a single thread.
+		 * @param degree Minimal total degree of a heavy trade.
+		 */
+		void set_min_heavy_trade_degree(const degree_t degree) {
+			assert(degree > 0);
+			_min_heavy_trade_degree = degree;
+		}
+
+		/**
+		 * Writes a checkpoint after every given number of global trades and
+		 * after the last one, see resume(). A checkpoint replaces the
+		 * previous one unless all are kept.
+		 * @param filename Name of the checkpoint.
+		 * @param interval Number of global trades between two checkpoints.
+		 * @param keep Flag whether to keep all checkpoints, the one written
+		 *        after global trade r is named filename.r (counting from 1).
+		 */
+		void set_checkpointing(const std::string &filename, const tradeid_t interval = 1,
+							   const bool keep = false) {
+			assert(interval > 0);
+
+			_checkpoint_file = filename;
+			_checkpoint_interval = interval;
+			_keep_checkpoints = keep;
+		}
+
 		/**
 		 * Runs the algorithm.
 		 * The output is put into the given output edge stream.
@@ -233,6 +249,100 @@ namespace Curveball {
 			// initialize k random hash functions and last as identity
 			Hashfuncs<HashFactory> hash_funcs(_num_nodes, _num_rounds);
 
+			_randomise(hash_funcs, _num_rounds, [&] (EMDualContainer<HashFactory> &msgs_container) {
+				// push neighbour messages into data structure
+				// directed according to earlier trade
+				for (; !_edges.empty(); ++_edges)
+					_push_edge(msgs_container, hash_funcs, *_edges);
+			});
+		}
+
+		/**
+		 * Continues a run from a checkpoint instead of reading the edges,
+		 * the degree sequence is still required.
+		 * The remaining global trades of the checkpointed run are processed,
+		 * followed by the given number of additional ones, which also allows
+		 * to extend a finished run.
+		 * The output is put into the given output edge stream.
+		 * @param filename Name of the checkpoint.
+		 * @param additional_rounds Number of global trades added to the run.
+		 */
+		void resume(const std::string &filename, const tradeid_t additional_rounds = 0) {
+			EMCheckpointReader<HashFactory> checkpoint(filename);
+
+			if (checkpoint.num_nodes() != _num_nodes)
+				throw std::runtime_error("Error, Curveball checkpoint " + filename + " belongs to another graph");
+			if (!checkpoint.remaining_rounds() && !additional_rounds)
+				throw std::runtime_error("Error, Curveball checkpoint " + filename + " has no rounds left");
+
+			if (!checkpoint.remaining_rounds()) {
+				// the run is finished, hence the messages are the edges
+				Hashfuncs<HashFactory> hash_funcs(_num_nodes, additional_rounds);
+
+				_randomise(hash_funcs, additional_rounds, [&] (EMDualContainer<HashFactory> &msgs_container) {
+					for (; !checkpoint.empty(); ++checkpoint)
+						_push_edge(msgs_container, hash_funcs, edge_t{(*checkpoint).target, (*checkpoint).neighbour});
+				});
+				return;
+			}
+
+			// the messages are directed by the first remaining hash-function,
+			// new ones are inserted before the identity
+			auto funcs = checkpoint.hash_funcs();
+			funcs.pop_back();
+			for (tradeid_t round = 0; round < additional_rounds; round++)
+				funcs.push_back(HashFactory::get_random(_num_nodes));
+			funcs.push_back(HashFactory::get_identity(_num_nodes));
+
+			const auto num_rounds = static_cast<tradeid_t>(funcs.size() - 1);
+			Hashfuncs<HashFactory> hash_funcs(_num_nodes, std::move(funcs));
+
+			_randomise(hash_funcs, num_rounds, [&] (EMDualContainer<HashFactory> &msgs_container) {
+				for (; !checkpoint.empty(); ++checkpoint)
+					msgs_container.push(*checkpoint);
+			});
+		}
+
+	protected:
+		/**
+		 * Pushes the message of an edge to the endpoint with smaller hash.
+		 * @param msgs_container Container of the first round.
+		 * @param hash_funcs Hash-functions of the run.
+		 * @param edge Edge of the input graph.
+		 */
+		void _push_edge(EMDualContainer<HashFactory> &msgs_container,
+						const Hashfuncs<HashFactory> &hash_funcs,
+						const edge_t &edge) const {
+			assert(edge.first != edge.second); // no self-loops
+			assert(edge.first >= 0);
+			assert(edge.first <= _num_nodes);
+			assert(edge.second >= 0);
+			assert(edge.second <= _num_nodes);
+
+			const hnode_t h_fst = hash_funcs.current_hash(edge.first);
+			const hnode_t h_snd = hash_funcs.current_hash(edge.second);
+
+			assert(h_fst >= 0);
+			assert(h_snd >= 0);
+
+			// compare targets, and direct accordingly
+			if (h_fst < h_snd)
+				msgs_container.push(NeighbourMsg{h_fst, edge.second});
+			else
+				msgs_container.push(NeighbourMsg{h_snd, edge.first});
+		}
+
+		/**
+		 * Processes the global trades of the given hash-functions.
+		 * @param hash_funcs Hash-functions of the rounds, the last one is the identity.
+		 * @param num_rounds Number of global trades.
+		 * @param push_initial Callback pushing the messages of the first
+		 *        round into the container.
+		 */
+		template <typename InitialPusher>
+		void _randomise(Hashfuncs<HashFactory> &hash_funcs,
+						const tradeid_t num_rounds,
+						InitialPusher push_initial) {
 			EMTargetInformation target_infos(_num_chunks, _num_nodes);
 
 
@@ -268,49 +378,30 @@ namespace Curveball {
 														_num_nodes,
 														max_degree,
 														hash_funcs,
-														CurveballParams{_num_rounds,
+														CurveballParams{num_rounds,
 																		_num_chunks,
 																		_num_splits,
 																		_num_fanout,
 																		_token_sorter_mem_size,
 																		_msg_limit,
 																		_num_threads,
-																		_insertion_buffer_size});
+																		_insertion_buffer_size,
+																		_compressed_msgs,
+																		_min_heavy_trade_degree});
 
 
 			ds_init_report.report("DualContainerInit");
 
 			{
 				IOStatistics first_msgs_push_report("InitialMessagePush");
-				// push neighbour messages into data structure
-				// directed according to earlier trade
-				for (; !_edges.empty(); ++_edges) {
-					const edge_t edge = *_edges;
-
-					assert(edge.first != edge.second); // no self-loops
-					assert(edge.first >= 0);
-					assert(edge.first <= _num_nodes);
-					assert(edge.second >= 0);
-					assert(edge.second <= _num_nodes);
-
-					const hnode_t h_fst = hash_funcs.current_hash(edge.first);
-					const hnode_t h_snd = hash_funcs.current_hash(edge.second);
-
-					assert(h_fst >= 0);
-					assert(h_snd >= 0);
-
-					// compare targets, and direct accordingly
-					if (h_fst < h_snd)
-						msgs_container.push(NeighbourMsg{h_fst, edge.second});
-					else
-						msgs_container.push(NeighbourMsg{h_snd, edge.first});
-				}
+				push_initial(msgs_container);
 			}
 
 			// process all global trades one by one
-			for (tradeid_t round = 0; round < _num_rounds; round++) {
+			for (tradeid_t round = 0; round < num_rounds; round++) {
 				// process the global trade
 				msgs_container.process_active();
+				_param_est.report_round(round, msgs_container.get_max_mc_num_msgs());
 
 				// reinitialize data structures
 				++hash_funcs; // move to next hash-function
@@ -320,7 +411,7 @@ namespace Curveball {
 				target_infos.swap();
 
 				// push new auxiliary info into helper
-				if (round < _num_rounds - 1) {
+				if (round < num_rounds - 1) {
 					IOStatistics next_infos("NextInfos");
 
 					// clear obsolete containers
@@ -339,6 +430,21 @@ namespace Curveball {
 
 					msgs_container.set_new_bounds(new_bounds);
 				}
+
+				// persist the messages of the next round
+				if (!_checkpoint_file.empty()
+					&& ((round + 1) % _checkpoint_interval == 0 || round == num_rounds - 1)) {
+					IOStatistics checkpoint_report("Checkpoint");
+
+					msgs_container.finalize();
+
+					const std::string filename = (_keep_checkpoints
+												  ? _checkpoint_file + "." + std::to_string(round + 1)
+												  : _checkpoint_file);
+					EMCheckpointWriter<HashFactory> checkpoint(filename, _num_nodes, hash_funcs.remaining());
+					msgs_container.forward_unsorted_edges(checkpoint);
+					checkpoint.finish();
+				}
 			}
 			// check whether all hash-functions have been processed
 			assert(hash_funcs.at_last());
@@ -9,6 +9,9 @@
 #include <atomic>
 #include "defs.h"
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <parallel/algorithm>
 #include <parallel/numeric>
 #include <Utils/IOStatistics.h>
@@ -18,8 +21,10 @@
 #include "EMTargetInformation.h"
 #include <Utils/ScopedTimer.h>
 #include <Utils/IntSort.h>
-#include <Utils/AlignedRNGs.h>
+#include <Utils/PhiloxRNG.h>
+#include <Utils/RandomSeed.h>
 #include "CurveballHelper.h"
+#include "SortedSetPartition.h"
 
 namespace Curveball {
 
@@ -153,6 +158,51 @@ namespace Curveball {
         return ThreadBounds(lower_bounds, upper_bounds);
     }
 
+    /**
+     * Returns a struct holding the bounds for the microchunks, such that
+     * each microchunk holds roughly the same trading work, i.e. the same sum
+     * of degrees. A microchunk may be empty if few nodes carry most of the
+     * work; those nodes are then the only ones of their microchunk.
+     * @param degs_psum Prefix sum of the degrees, starting with 0.
+     * @param mc_num_nodes Number of nodes in the macrochunk.
+     * @param num_microchunks Number of microchunks.
+     * @param fanout Multiplier of microchunks for greedy-processing.
+     * @return Struct for the microchunk bounds.
+     */
+    static ThreadBounds mc_get_thread_bounds_by_work(const std::vector<degree_t> &degs_psum,
+                                                     const node_t mc_num_nodes,
+                                                     const chunkid_t num_microchunks,
+                                                     const chunkid_t fanout) {
+        const node_t mc_even_num_nodes = make_even_by_sub(mc_num_nodes);
+        const auto num_bounds = static_cast<int64_t>(num_microchunks * fanout);
+
+        // the work of the node left out for odd number of nodes is not traded
+        const auto psum_begin = degs_psum.cbegin();
+        const auto psum_end = degs_psum.cbegin() + mc_even_num_nodes + 1;
+        const auto total_work = static_cast<int64_t>(degs_psum[mc_even_num_nodes]);
+
+        std::vector<node_t> lower_bounds;
+        std::vector<node_t> upper_bounds;
+
+        lower_bounds.reserve(num_bounds);
+        upper_bounds.reserve(num_bounds);
+
+        lower_bounds.push_back(0);
+        for (int64_t i = 1; i < num_bounds; i++) {
+            const auto work = static_cast<degree_t>(i * total_work / num_bounds);
+
+            // bounds are increasing, since make_even_by_sub is monotone
+            const auto bound = make_even_by_sub(static_cast<node_t>(
+                    std::lower_bound(psum_begin, psum_end, work) - psum_begin));
+
+            lower_bounds.push_back(bound);
+            upper_bounds.push_back(bound);
+        }
+        upper_bounds.push_back(mc_even_num_nodes);
+
+        return ThreadBounds(lower_bounds, upper_bounds);
+    }
+
 //#define BATCH_DEPS
     /**
      * EM-PGCB's data structure.
@@ -174,6 +224,13 @@ namespace Curveball {
         using rng_vector = std::vector<STDRandomEngine>;
 
     protected:
+        //! Trade of a pair of high-degree nodes deferred to the end of a batch
+        struct HeavyTrade {
+            node_t mc_node_u;
+            node_t mc_node_v;
+            bool shared;
+        };
+
         // containers for both current and subsequent global trade round
         EMMessageContainer<HashFactory> _active;
         EMMessageContainer<HashFactory> _pending;
@@ -197,6 +254,12 @@ namespace Curveball {
         hash_vector _mc_hashes;
         inverse_vector _mc_clearpartner;
 
+        // messages and auxiliary data of the next macrochunk, which are
+        // loaded in the background while the current one is traded
+        msg_vector _prefetched_msgs;
+        std::vector<TargetMsg> _prefetched_infos;
+        std::unique_ptr<std::thread> _prefetch_thread;
+
         // container holding message counts for each node, necessary and used
         // for the parallel insertion of messages
         degree_vector _mc_degs_psum;
@@ -206,6 +269,9 @@ namespace Curveball {
         msgid_t _mc_max_num_msgs;
         node_t _mc_num_loaded_nodes;
 
+        // largest number of messages of a macrochunk in the last processed round
+        msgid_t _max_mc_num_msgs;
+
         // numbers used to determine if messages belong to the same batch or
         // macrochunk
         hnode_t _b_largest_hnode;
@@ -222,7 +288,6 @@ namespace Curveball {
         // utilities used for synchronisation
         bool_vector _mc_has_traded;
         threadcount_vector _active_threads;
-        std::vector<std::mutex> _node_locks;
 
         // the adjacency list containing a small subset of the graph
         IMAdjacencyList _mc_adjacency_list;
@@ -239,7 +304,17 @@ namespace Curveball {
         node_t _b_min_mc_node;
         node_t _b_max_mc_node;
 
-        RNGs<std::mt19937_64, 64> _rngs;
+        // trades of pairs whose degrees exceed the threshold are deferred to
+        // the end of the batch and processed by all threads together
+        const degree_t _min_heavy_trade_degree;
+        degree_t _mc_heavy_trade_threshold;
+        std::vector<HeavyTrade> _heavy_trades;
+        std::mutex _heavy_trades_lock;
+
+        // randomness of a trade is derived from (seed, round, node) such that
+        // the result does not depend on the number of threads
+        const uint64_t _trade_seed;
+        uint64_t _round;
 
         // vectors holding disjoint and common neighbours for each thread
         // therfore vector of vector
@@ -281,12 +356,14 @@ namespace Curveball {
                         curveball_params.msg_limit,
                         EMMessageContainer<HashFactory>::ACTIVE,
                         curveball_params.threads,
-                        curveball_params.insertion_buffer_size),
+                        curveball_params.insertion_buffer_size,
+                        curveball_params.compressed_msgs),
                 _pending(pending_upper_bounds,
                          curveball_params.msg_limit,
                          EMMessageContainer<HashFactory>::PENDING,
                          curveball_params.threads,
-                         curveball_params.insertion_buffer_size),
+                         curveball_params.insertion_buffer_size,
+                         curveball_params.compressed_msgs),
                 _target_infos(target_infos),
                 _active_upper_bounds(active_upper_bounds),
                 _pending_upper_bounds(pending_upper_bounds),
@@ -306,6 +383,7 @@ namespace Curveball {
                 _mc_num_inc_msgs_psum(static_cast<size_t>(_last_mc_nodes) + 1),
                 _mc_max_num_msgs(target_infos.get_active_max_num_msgs()),
                 _mc_num_loaded_nodes(0),
+                _max_mc_num_msgs(0),
                 _b_largest_hnode(0),
                 _mc_largest_hnode(0),
                 _mc_last_largest_hnode(0),
@@ -316,7 +394,6 @@ namespace Curveball {
                 _mc_hash_offset(0),
                 _mc_has_traded(static_cast<size_t>(make_even_by_add(_last_mc_nodes)), false),
                 _active_threads(static_cast<size_t>(_last_mc_nodes)),
-                _node_locks(static_cast<size_t>(_last_mc_nodes)),
                 _mc_adjacency_list(_last_mc_nodes, _mc_max_num_msgs),
                 _num_splits(curveball_params.splits),
                 _num_fanout(curveball_params.fanout),
@@ -324,7 +401,10 @@ namespace Curveball {
                 _mc_thread_bounds(),
                 _b_min_mc_node(0),
                 _b_max_mc_node(0),
-                _rngs(static_cast<size_t>(curveball_params.threads), {1}),
+                _min_heavy_trade_degree(curveball_params.min_heavy_trade_degree),
+                _mc_heavy_trade_threshold(std::numeric_limits<degree_t>::max()),
+                _trade_seed(RandomSeed::get_instance().get_next_seed()),
+                _round(0),
                 _t_common_neighbours(static_cast<size_t>(curveball_params.threads)),
                 _t_disjoint_neighbours(static_cast<size_t>(curveball_params.threads)),
                 _hash_funcs(hash_funcs),
@@ -340,6 +420,58 @@ namespace Curveball {
                 _t_common_neighbours[thread_id].reserve(static_cast<size_t>(_mc_max_degree));
                 _t_disjoint_neighbours[thread_id].reserve(static_cast<size_t>(_mc_max_degree));
             }
+
+            _prefetched_infos.reserve(static_cast<size_t>(_last_mc_nodes));
+        }
+
+        ~EMDualContainer() {
+            if (_prefetch_thread)
+                _prefetch_thread->join();
+        }
+
+        /**
+         * Radix-sorts messages of a macrochunk by their targets.
+         * @param mc_id Macrochunk-id.
+         * @param begin Begin of the messages.
+         * @param end End of the messages.
+         */
+        void sort_messages(const chunkid_t mc_id,
+                           msg_vector::iterator begin,
+                           msg_vector::iterator end) const {
+            const hnode_t last_upper_bound = (mc_id > 0 ? _active_upper_bounds[mc_id - 1] : 0);
+            intsort::sort(begin, end,
+                          [&] (const NeighbourMsg& msg)
+                          {return msg.target - last_upper_bound;},
+                          _active_upper_bounds[mc_id] - last_upper_bound + 1);
+            // radix-sort data-structure is deallocated here
+        }
+
+        /**
+         * Loads and sorts the messages the macrochunk has received so far and
+         * loads the auxiliary information of its nodes. Apart from the first
+         * macrochunk this runs in the background while the preceding one is
+         * traded; messages forwarded meanwhile are loaded afterwards.
+         * @param mc_id Macrochunk-id.
+         */
+        void prefetch_macrochunk(const chunkid_t mc_id) {
+            assert(_prefetched_msgs.empty());
+            assert(_prefetched_infos.empty());
+
+            _active.prefetch_messages_of(mc_id, _prefetched_msgs);
+            sort_messages(mc_id, _prefetched_msgs.begin(), _prefetched_msgs.end());
+
+            // the auxiliary information is not accessed while trading
+            if (LIKELY(mc_id < _num_chunks - 1)) {
+                for (node_t mc_nodeid = 0; mc_nodeid < _nodes_per_mc; mc_nodeid++, ++_target_infos)
+                    _prefetched_infos.push_back(*_target_infos);
+            } else {
+                // if at last macrochunk,
+                // just move the rest (might be larger than other macrochunks)
+                for (; !_target_infos.empty(); ++_target_infos)
+                    _prefetched_infos.push_back(*_target_infos);
+            }
+
+            assert(_prefetched_infos.size() <= _mc_degs.size());
         }
 
         /**
@@ -347,27 +479,39 @@ namespace Curveball {
          * reinitialization for next round is done.
          */
         void process_active() {
+            // the first macrochunk has received all its messages already,
+            // all subsequent ones are prefetched while trading
+            prefetch_macrochunk(0);
+
+            _max_mc_num_msgs = 0;
+
             // process macrochunk by macrochunk
             for (chunkid_t mc_id = 0; mc_id < _num_chunks; mc_id++) {
                 {
                     IOStatistics pre_trading_report("PreTrading");
                     _current_mc_id = mc_id;
 
-                    // load current sequence/queue into IM
-                    msg_vector msgs = _active.get_messages_of(mc_id);
+                    // take over the prefetched messages and append the ones
+                    // forwarded while trading the previous macrochunk
+                    msg_vector msgs;
+                    msgs.swap(_prefetched_msgs);
+                    const auto num_prefetched_msgs = static_cast<msgid_t>(msgs.size());
+                    _active.load_remaining_messages_of(mc_id, msgs);
                     assert(!msgs.empty());
 
-                    std::cout << "Received " << msgs.size() << " many messages" << std::endl;
+                    std::cout << "Received " << msgs.size() << " many messages ("
+                              << num_prefetched_msgs << " prefetched)" << std::endl;
 
-                    // sort messages by comparator provided by GenericComparator
+                    _max_mc_num_msgs = std::max(_max_mc_num_msgs, static_cast<msgid_t>(msgs.size()));
+
+                    // sort the remaining messages and merge them with the
+                    // prefetched ones, which are already sorted
                     {
                         ScopedTimer timer("Sorting");
-                        const hnode_t last_upper_bound = (mc_id > 0 ? _active_upper_bounds[mc_id - 1] : 0);
-                        intsort::sort(msgs,
-                                      [&] (const NeighbourMsg& msg)
-                                      {return msg.target - last_upper_bound;},
-                                      _active_upper_bounds[mc_id] - last_upper_bound + 1);
-                        // radix-sort data-structure is deallocated here
+                        const auto prefetched_end = msgs.begin() + num_prefetched_msgs;
+                        sort_messages(mc_id, prefetched_end, msgs.end());
+                        std::inplace_merge(msgs.begin(), prefetched_end, msgs.end(),
+                                           NeighbourMsgComparator{});
                     }
 
                     // check if messages are sorted
@@ -390,40 +534,25 @@ namespace Curveball {
                         _mc_clearpartner[mc_node - 1] = _mc_invs[mc_node];
                     };
 
-                    // Loading degrees and inverses into IM
-                    if (LIKELY(mc_id < _num_chunks - 1)) {
-                        for (node_t mc_nodeid = 0; mc_nodeid < _nodes_per_mc; mc_nodeid++, ++_target_infos) {
-                            assert(static_cast<size_t>(mc_nodeid) < _mc_degs.size());
-
-                            const TargetMsg info = *_target_infos;
-                            insert_info(mc_nodeid, info);
-                            if (mc_nodeid % 2)
-                                set_partner(mc_nodeid);
-                        }
+                    // Loading prefetched degrees and inverses, the last
+                    // macrochunk might be larger than the other ones
+                    assert(mc_id == _num_chunks - 1
+                           || static_cast<node_t>(_prefetched_infos.size()) == _nodes_per_mc);
 
-                        _mc_num_loaded_nodes = _nodes_per_mc;
-                    } else {
-                        // if at last macrochunk,
-                        // just move the rest (might be larger than other macrochunks)
-                        node_t _mc_last_num_nodes = 0;
+                    _mc_num_loaded_nodes = static_cast<node_t>(_prefetched_infos.size());
+                    for (node_t mc_nodeid = 0; mc_nodeid < _mc_num_loaded_nodes; mc_nodeid++) {
+                        assert(static_cast<size_t>(mc_nodeid) < _mc_degs.size());
 
-                        for (node_t mc_nodeid = 0; !_target_infos.empty(); ++_target_infos, mc_nodeid++) {
-                            assert(static_cast<size_t>(mc_nodeid) < _mc_degs.size());
-
-                            const TargetMsg info = *_target_infos;
-                            insert_info(mc_nodeid, info);
-                            if (mc_nodeid % 2)
-                                set_partner(mc_nodeid);
-
-                            _mc_last_num_nodes++;
-                        }
+                        insert_info(mc_nodeid, _prefetched_infos[mc_nodeid]);
+                        if (mc_nodeid % 2)
+                            set_partner(mc_nodeid);
+                    }
 
-                        _mc_num_loaded_nodes = _mc_last_num_nodes;
+                    _prefetched_infos.clear();
 
-                        // do not suggest that there exists an edge {n - 1, 0}
-                        if (_mc_num_loaded_nodes % 2)
-                            _mc_clearpartner[_mc_num_loaded_nodes - 1] = INVALID_NODE;
-                    }
+                    // do not suggest that there exists an edge {n - 1, 0}
+                    if (_mc_num_loaded_nodes % 2)
+                        _mc_clearpartner[_mc_num_loaded_nodes - 1] = INVALID_NODE;
 
                     _mc_largest_hnode = _mc_hashes[_mc_num_loaded_nodes - 1];
                     _mc_hash_offset = _mc_largest_hnode + 1 - _mc_num_loaded_nodes - _g_num_processed_nodes;
@@ -445,10 +574,24 @@ namespace Curveball {
                     assert(_mc_degs_psum[_mc_num_loaded_nodes] <= _target_infos.get_active_max_num_msgs());
 
                     // identify hash-values as indices
-                    // initializes bounds of each microchunk/batch
-                    _mc_thread_bounds = mc_get_thread_bounds(_mc_num_loaded_nodes,
-                                                             _num_splits * _num_threads,
-                                                             _num_fanout);
+                    // initializes bounds of each microchunk/batch, such that
+                    // each microchunk holds about the same number of neighbours
+                    _mc_thread_bounds = mc_get_thread_bounds_by_work(_mc_degs_psum,
+                                                                     _mc_num_loaded_nodes,
+                                                                     _num_splits * _num_threads,
+                                                                     _num_fanout);
+
+                    // a pair holding more neighbours than an average microchunk
+                    // would stall its batch, hence it is traded by all threads
+                    if (_num_threads > 1) {
+                        const degree_t mc_work_per_microchunk =
+                                _mc_degs_psum[_mc_num_loaded_nodes]
+                                / static_cast<degree_t>(_mc_thread_bounds.size());
+
+                        _mc_heavy_trade_threshold = (mc_work_per_microchunk > _min_heavy_trade_degree
+                                                     ? mc_work_per_microchunk
+                                                     : _min_heavy_trade_degree);
+                    }
 
                     // reallocate memory for adjacency list
                     _mc_adjacency_list.resize(_mc_degs_psum[_mc_num_loaded_nodes]);
@@ -569,6 +712,12 @@ namespace Curveball {
                     _verify_adjacency_offsets(msgs.size());
                 }
 
+                // load the next macrochunk while trading the current one
+                if (LIKELY(mc_id + 1 < _num_chunks))
+                    _prefetch_thread.reset(new std::thread([this, mc_id]() {
+                        prefetch_macrochunk(mc_id + 1);
+                    }));
+
                 IOStatistics trading_report;
 
                 // process trades with degrees, inverses (in parallel!)
@@ -592,6 +741,10 @@ namespace Curveball {
                         }
                     }
 
+                    // a batch is empty if preceding nodes carry most of the work
+                    if (UNLIKELY(mc_max_node < static_cast<node_t>(_mc_thread_bounds.l_bounds[_b_min_mc_node])))
+                        continue;
+
                     // check whether last upper bound is set correctly
                     _verify_last_upper_bound(mc_id, batch, mc_max_node);
 
@@ -664,6 +817,15 @@ namespace Curveball {
                                     continue;
                                 }
 
+                                // trades of high-degree pairs are processed
+                                // after the batch, the locks are kept
+                                if (UNLIKELY(is_heavy_trade(mc_node_u, mc_node_v))) {
+                                    defer_heavy_trade(mc_node_u,
+                                                      mc_node_v,
+                                                      _mc_adjacency_list.get_edge_in_partner(mc_node_u));
+                                    continue;
+                                }
+
                                 // actual trading happens here
                                 // call the lambda here
                                 // no works-sttealing therefore false
@@ -684,6 +846,9 @@ namespace Curveball {
                         } // for-loop over nodes in microchunk
                     } // omp parallel for-loop over microchunks
 
+                    // trade the deferred high-degree pairs with all threads
+                    process_heavy_trades();
+
                     #ifdef BATCH_DEPS
                     std::cout << "Batch dependencies: " << batch_dep_count.load() << std::endl;
 					// reset counter
@@ -724,9 +889,14 @@ namespace Curveball {
                 } // sending of (odd) last nodes messages
 
 
-                // force insertion of remaining messages from the next macrochunk
-                if (LIKELY(mc_id + 1 < _num_chunks))
+                // force insertion of remaining messages from the next macrochunk,
+                // the prefetching must not read the macrochunk concurrently
+                if (LIKELY(mc_id + 1 < _num_chunks)) {
+                    _prefetch_thread->join();
+                    _prefetch_thread.reset();
+
                     _active.force_push(mc_id + 1);
+                }
 
                 // reset internal data structures
                 _mc_last_largest_hnode = _mc_largest_hnode;
@@ -807,7 +977,6 @@ namespace Curveball {
                     // when obtaining the lock we add the neighbour,
                     // so no conflict can arise, or when another thread wants to send
                     // a message to that node
-                    //_node_locks[mc_neighbour].lock();
                     while (std::atomic_fetch_sub(&_active_threads[mc_neighbour], 1) < 0) {
                         std::atomic_fetch_add(&_active_threads[mc_neighbour], 1);
                     }
@@ -885,7 +1054,9 @@ namespace Curveball {
                                 std::atomic_fetch_add(&_active_threads[mc_neighbour], 1);
                                 std::atomic_fetch_add(&_active_threads[mc_partner], 1);
                                 return;
-                            } else
+                            } else if (UNLIKELY(is_heavy_trade(mc_neighbour, mc_partner)))
+                                defer_heavy_trade(mc_neighbour, mc_partner, partner_in_neighbour);
+                            else
                                 trade(mc_neighbour, mc_partner,
                                       partner_in_neighbour,
                                       true,
@@ -948,6 +1119,8 @@ namespace Curveball {
                             std::atomic_fetch_add(&_active_threads[mc_partner], 1);
                             std::atomic_fetch_add(&_active_threads[mc_neighbour], 1);
                             return;
+                        } else if (UNLIKELY(is_heavy_trade(mc_partner, mc_neighbour))) {
+                            defer_heavy_trade(mc_partner, mc_neighbour, neighbour_in_partner);
                         } else {
                             // tradable
                             // worksteal trade
@@ -989,7 +1162,6 @@ namespace Curveball {
                         assert(mc_neighbour_it != _mc_hashes.begin() + mc_upper);
                         assert(*mc_neighbour_it == h_neighbour);
                         // check some inequalities
-                        assert(mc_neighbour > _mc_thread_bounds.l_bounds[_b_max_mc_node]);
                         assert(mc_neighbour >= _mc_thread_bounds.u_bounds[_b_max_mc_node]);
                         assert(h_neighbour >= _g_num_processed_nodes);
                         assert(_mc_hash_offset >= _mc_last_hash_offset);
@@ -1017,6 +1189,57 @@ namespace Curveball {
             } // if edge [u, neighbour] not needed in this round
         } // end send_messages
 
+        /**
+         * Returns whether the trade of u and v holds enough neighbours to be
+         * processed by all threads together.
+         * @param mc_tradenode_u Rank of u in the macrochunk.
+         * @param mc_tradenode_v Rank of v in the macrochunk.
+         */
+        bool is_heavy_trade(const node_t mc_tradenode_u, const node_t mc_tradenode_v) const {
+            return _mc_degs[mc_tradenode_u] > _mc_heavy_trade_threshold - _mc_degs[mc_tradenode_v];
+        }
+
+        /**
+         * Defers the trade of u and v to the end of the batch. The calling
+         * thread has to hold both nodes, they are released by the trade.
+         * @param mc_tradenode_u Rank of u in the macrochunk.
+         * @param mc_tradenode_v Rank of v in the macrochunk.
+         * @param mc_v_in_mc_u Flag whether the trading nodes share an edge.
+         */
+        void defer_heavy_trade(const node_t mc_tradenode_u, const node_t mc_tradenode_v,
+                               const bool mc_v_in_mc_u) {
+            std::lock_guard<std::mutex> guard(_heavy_trades_lock);
+            _heavy_trades.push_back(HeavyTrade{mc_tradenode_u, mc_tradenode_v, mc_v_in_mc_u});
+        }
+
+        /**
+         * Performs the deferred trades one after another, each of them with
+         * all threads. Work-stealing while forwarding may defer further
+         * trades of the batch, which are performed as well.
+         */
+        void process_heavy_trades() {
+            while (true) {
+                HeavyTrade heavy_trade;
+                {
+                    std::lock_guard<std::mutex> guard(_heavy_trades_lock);
+                    if (_heavy_trades.empty())
+                        break;
+
+                    heavy_trade = _heavy_trades.back();
+                    _heavy_trades.pop_back();
+                }
+
+                trade(heavy_trade.mc_node_u,
+                      heavy_trade.mc_node_v,
+                      heavy_trade.shared,
+                      false,
+                      _t_common_neighbours[0],
+                      _t_disjoint_neighbours[0],
+                      0,
+                      true);
+            }
+        }
+
         /**
          * Trades neighbourhoods of nodes u and v which are provided by their
          * ranks in the macrochunk respectively.
@@ -1035,13 +1258,16 @@ namespace Curveball {
          * @param common_neighbours Provided container for common neighbours.
          * @param disjoint_neighbours Provided container for disjoint neighbours.
          * @param thread_id Thread-ID of processing thread.
+         * @param in_parallel Flag whether all threads sort and forward, must
+         *                    not be set inside a parallel region.
          */
         void trade(const node_t mc_tradenode_u, const node_t mc_tradenode_v,
                    const bool mc_v_in_mc_u,
                    const bool work_stealing_flag,
                    std::vector<node_t> & common_neighbours,
                    std::vector<node_t> & disjoint_neighbours,
-                   const int thread_id) {
+                   const int thread_id,
+                   const bool in_parallel = false) {
             _verify_trading_nodes(mc_tradenode_u, mc_tradenode_v);
 
             _mc_has_traded[mc_tradenode_u] = true;
@@ -1050,8 +1276,15 @@ namespace Curveball {
             _mc_adjacency_list.set_traded(mc_tradenode_u);
             _mc_adjacency_list.set_traded(mc_tradenode_v);
 
-            organize_neighbors(mc_tradenode_u);
-            organize_neighbors(mc_tradenode_v);
+            if (UNLIKELY(in_parallel)) {
+                __gnu_parallel::sort(_mc_adjacency_list.begin(mc_tradenode_u),
+                                     _mc_adjacency_list.end(mc_tradenode_u));
+                __gnu_parallel::sort(_mc_adjacency_list.begin(mc_tradenode_v),
+                                     _mc_adjacency_list.end(mc_tradenode_v));
+            } else {
+                organize_neighbors(mc_tradenode_u);
+                organize_neighbors(mc_tradenode_v);
+            }
 
             auto u_iter_end = _mc_adjacency_list.cend(mc_tradenode_u) - mc_v_in_mc_u;
             auto v_iter_end = _mc_adjacency_list.cend(mc_tradenode_v);
@@ -1083,35 +1316,19 @@ namespace Curveball {
                 disjoint_neighbours.reserve(static_cast<size_t>(disjoint_alloc));
             }
 
-            auto u_neigh_iter = _mc_adjacency_list.cbegin(mc_tradenode_u);
-            auto v_neigh_iter = _mc_adjacency_list.cbegin(mc_tradenode_v);
-
-            while ((u_neigh_iter != u_iter_end) && (v_neigh_iter != v_iter_end)) {
+            #ifndef NDEBUG
+            for (auto u_neigh_iter = _mc_adjacency_list.cbegin(mc_tradenode_u); u_neigh_iter != u_iter_end; u_neigh_iter++)
                 assert(*u_neigh_iter != _mc_invs[mc_tradenode_v]);
+            for (auto v_neigh_iter = _mc_adjacency_list.cbegin(mc_tradenode_v); v_neigh_iter != v_iter_end; v_neigh_iter++)
                 assert(*v_neigh_iter != _mc_invs[mc_tradenode_u]);
+            #endif
 
-                if (*u_neigh_iter > *v_neigh_iter) {
-                    disjoint_neighbours.push_back(*v_neigh_iter);
-                    v_neigh_iter++;
-                    continue;
-                }
-                if (*u_neigh_iter < *v_neigh_iter) {
-                    disjoint_neighbours.push_back(*u_neigh_iter);
-                    u_neigh_iter++;
-                    continue;
-                }
-                // *u_neigh_iter == *v_neigh_iter
-                {
-                    common_neighbours.push_back(*u_neigh_iter);
-                    u_neigh_iter++;
-                    v_neigh_iter++;
-                }
-            }
-
-            if (u_neigh_iter == u_iter_end)
-                disjoint_neighbours.insert(disjoint_neighbours.end(), v_neigh_iter, v_iter_end);
-            else
-                disjoint_neighbours.insert(disjoint_neighbours.end(), u_neigh_iter, u_iter_end);
+            // split into common and disjoint neighbours, the latter ones
+            // are randomly partitioned below, so their order is irrelevant
+            CurveballImpl::sorted_set_partition(_mc_adjacency_list.cbegin(mc_tradenode_u), u_iter_end,
+                                                _mc_adjacency_list.cbegin(mc_tradenode_v), v_iter_end,
+                                                common_neighbours,
+                                                disjoint_neighbours);
 
             // reset both rows, not necessarily needed, since deallocation
             // (sets offsets_vector to 0)
@@ -1124,34 +1341,59 @@ namespace Curveball {
                                                          - _mc_adjacency_list.cbegin(mc_tradenode_v)
                                                          - common_neighbours.size());
 
+            // each node trades at most once per round
+            PhiloxRNG rng((_round << 32) | _trade_seed, _mc_invs[mc_tradenode_u]);
+
             // assign first u_setsize to sc_node_u: to get edge [u, *]
             // assign  last v_setsize to sc_node_v: to get edge [v, *]
             CurveballImpl::random_partition(disjoint_neighbours.begin(),
                                             disjoint_neighbours.end(),
-                                            static_cast<size_t>(u_setsize), _rngs[thread_id]);
-
-            // distribute disjoint neighbours
-            // send messages for u
-            for (degree_t mc_neighbour_id = 0; mc_neighbour_id < u_setsize; mc_neighbour_id++) {
-                send_message(mc_tradenode_u,
-                             disjoint_neighbours[mc_neighbour_id],
-                             thread_id);
-            }
+                                            static_cast<size_t>(u_setsize), rng);
+
+            if (UNLIKELY(in_parallel)) {
+                // forward disjoint neighbours of u, of v and common
+                // neighbours to both, dependent trades are work-stolen
+                // by the forwarding threads
+                const auto num_disjoint = static_cast<int64_t>(u_setsize + v_setsize);
+                const auto num_msgs = num_disjoint + 2 * static_cast<int64_t>(common_neighbours.size());
+
+                #pragma omp parallel for num_threads(_num_threads) schedule(dynamic, 1024)
+                for (int64_t msg_id = 0; msg_id < num_msgs; msg_id++) {
+                    const int p_thread_id = omp_get_thread_num();
+
+                    if (msg_id < u_setsize)
+                        send_message(mc_tradenode_u, disjoint_neighbours[msg_id], p_thread_id);
+                    else if (msg_id < num_disjoint)
+                        send_message(mc_tradenode_v, disjoint_neighbours[msg_id], p_thread_id);
+                    else
+                        send_message((msg_id - num_disjoint) % 2 ? mc_tradenode_v : mc_tradenode_u,
+                                     common_neighbours[(msg_id - num_disjoint) / 2],
+                                     p_thread_id);
+                }
+            } else {
+                // distribute disjoint neighbours
+                // send messages for u
+                for (degree_t mc_neighbour_id = 0; mc_neighbour_id < u_setsize; mc_neighbour_id++) {
+                    send_message(mc_tradenode_u,
+                                 disjoint_neighbours[mc_neighbour_id],
+                                 thread_id);
+                }
 
-            // send messages for v
-            for (degree_t mc_neighbour_id = u_setsize;
-                 mc_neighbour_id < u_setsize + v_setsize;
-                 mc_neighbour_id++)
-            {
-                send_message(mc_tradenode_v,
-                             disjoint_neighbours[mc_neighbour_id],
-                             thread_id);
-            }
+                // send messages for v
+                for (degree_t mc_neighbour_id = u_setsize;
+                     mc_neighbour_id < u_setsize + v_setsize;
+                     mc_neighbour_id++)
+                {
+                    send_message(mc_tradenode_v,
+                                 disjoint_neighbours[mc_neighbour_id],
+                                 thread_id);
+                }
 
-            // distribute common neighbours
-            for (const auto common : common_neighbours) {
-                send_message(mc_tradenode_u, common, thread_id);
-                send_message(mc_tradenode_v, common, thread_id);
+                // distribute common neighbours
+                for (const auto common : common_neighbours) {
+                    send_message(mc_tradenode_u, common, thread_id);
+                    send_message(mc_tradenode_v, common, thread_id);
+                }
             }
 
             // if edge existed between u and v, send edge {u,v} to next round
@@ -1236,6 +1478,8 @@ namespace Curveball {
             _mc_last_hash_offset = 0;
 
             _active_upper_bounds.swap(_pending_upper_bounds);
+
+            _round++;
         }
 
         /**
@@ -1268,6 +1512,15 @@ namespace Curveball {
             return static_cast<size_t>(_mc_max_num_msgs);
         }
 
+        /**
+         * Returns the largest number of messages a macrochunk received in
+         * the last processed round.
+         * @return Number of messages
+         */
+        msgid_t get_max_mc_num_msgs() const {
+            return _max_mc_num_msgs;
+        }
+
         /**
          * Resets the maximum number of messages the adjacency list can hold.
          * @param degree_count New maximum number of messages.
@@ -68,12 +68,15 @@ namespace Curveball {
 		 * @param mode Active or next round.
 		 * @param num_threads Number of threads.
 		 * @param insertion_buffer_size Size of insertion buffer.
+		 * @param compressed Flag whether macrochunks store compressed messages,
+		 *        which are decoded transparently on loading.
 		 */
 		EMMessageContainer(const chunk_upperbound_vector &upper_bounds,
 						   const msgid_t msg_limit,
 						   const Mode mode,
 						   const int num_threads,
-						   const msgid_t insertion_buffer_size)
+						   const msgid_t insertion_buffer_size,
+						   const bool compressed = false)
 			: _num_chunks(static_cast<chunkid_t>(upper_bounds.size())),
 			  _mode(mode),
 			  _num_threads(num_threads),
@@ -82,7 +85,7 @@ namespace Curveball {
 
 			// initialize macrochunks and hashmap (target -> macrochunk_id)
 			for (chunkid_t id = 0; id < _num_chunks; id++) {
-				_macrochunks.emplace_back(id, msg_limit);
+				_macrochunks.emplace_back(id, msg_limit, compressed);
 
 				_upper_bounds.insert(upper_bounds[id], id);
 			}
@@ -235,6 +238,27 @@ namespace Curveball {
 			return msgs;
 		}
 
+		/**
+		 * Moves the messages received so far by the macrochunk induced by the
+		 * macrochunk-id into the given vector. Can be used concurrently to
+		 * the insertion of messages while trading.
+		 * @param chunkid Macrochunk-id.
+		 * @param msgs Output message vector.
+		 */
+		void prefetch_messages_of(const chunkid_t chunkid, msg_vector& msgs) {
+			_macrochunks[chunkid].prefetch_messages(msgs);
+		}
+
+		/**
+		 * Appends the messages of the macrochunk induced by the macrochunk-id
+		 * which arrived after prefetch_messages_of() to the given vector.
+		 * @param chunkid Macrochunk-id.
+		 * @param msgs Message vector holding the prefetched messages.
+		 */
+		void load_remaining_messages_of(const chunkid_t chunkid, msg_vector& msgs) {
+			_macrochunks[chunkid].load_messages(msgs);
+		}
+
 		/**
 		 * Set this container as belonging to an active global trade round.
 		 */
@@ -0,0 +1,244 @@
+/**
+ * @file
+ * @brief Estimation of EM-Curveball's internal parameters from the degree sequence
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "defs.h"
+
+namespace Curveball {
+
+	/**
+	 * Machine dependent constants of the memory and I/O model used by
+	 * EMParameterEstimation. The defaults are derived from the data structures
+	 * of EMDualContainer; they can be overwritten by a calibration profile.
+	 *
+	 * The file format is one constant per line (lines starting with # are ignored):
+	 * @code
+	 * <key> <value>
+	 * @endcode
+	 */
+	struct CurveballCalibration {
+		//! Bytes per message of a macrochunk; the adjacency row of the traded
+		//! macrochunk plus messages and sort buffer of the prefetched one
+		double bytes_per_msg = sizeof(node_t) + 2 * sizeof(NeighbourMsg);
+
+		//! Bytes per node of a macrochunk (auxiliary vectors, thread counters and offsets)
+		double bytes_per_node = 80;
+
+		//! Internal memory of the block buffers of each macrochunk sequence
+		double sequence_buffer_bytes = 4 * IntScale::Mi;
+
+		//! Share of the memory used by the insertion buffers
+		double insertion_buffer_share = 1.0 / 64;
+
+		//! Minimum number of neighbours a microchunk should hold
+		double min_microchunk_work = 4096;
+
+		//! Sequential disk bandwidth in Byte/s, used to predict the I/O time
+		double disk_bandwidth = 200 * IntScale::M;
+
+		//! Reads a calibration profile; returns false if the file cannot be opened
+		bool load(const std::string &filename) {
+			std::ifstream in(filename);
+			if (!in)
+				return false;
+
+			std::string line;
+			while (std::getline(in, line)) {
+				if (line.empty() || line[0] == '#')
+					continue;
+
+				std::istringstream fields(line);
+				std::string key;
+				double value;
+				if (!(fields >> key >> value))
+					throw std::runtime_error("Error, malformed line in Curveball calibration file: " + line);
+
+				if (key == "bytes_per_msg") bytes_per_msg = value;
+				else if (key == "bytes_per_node") bytes_per_node = value;
+				else if (key == "sequence_buffer_bytes") sequence_buffer_bytes = value;
+				else if (key == "insertion_buffer_share") insertion_buffer_share = value;
+				else if (key == "min_microchunk_work") min_microchunk_work = value;
+				else if (key == "disk_bandwidth") disk_bandwidth = value;
+				else throw std::runtime_error("Error, unknown key in Curveball calibration file: " + key);
+			}
+
+			return true;
+		}
+	};
+
+	/**
+	 * Chooses the internal parameters of EM-Curveball from the degree
+	 * sequence, the number of rounds, the memory and the number of threads.
+	 *
+	 * Each macrochunk receives the neighbours of about n/k nodes drawn at
+	 * random by the hash-functions. Its message peak is predicted by the mean
+	 * degree sum plus a deviation bound covering all macrochunks of all
+	 * rounds. The smallest number of macrochunks is chosen whose peak fits
+	 * into the memory, which leaves as little memory unused as possible.
+	 */
+	class EMParameterEstimation {
+	public:
+		EMParameterEstimation() = default;
+
+		/**
+		 * @param degrees Degree sequence as stream, is rewound afterwards.
+		 * @param num_nodes Number of nodes.
+		 * @param num_edges Number of edges.
+		 * @param num_rounds Number of global trade rounds.
+		 * @param mem Size of main memory in Byte.
+		 * @param num_threads Number of threads.
+		 * @param calibration Constants of the memory and I/O model.
+		 */
+		template <typename DegreeInputStream>
+		EMParameterEstimation(DegreeInputStream &degrees,
+							  const node_t num_nodes,
+							  const edgeid_t num_edges,
+							  const tradeid_t num_rounds,
+							  const size_t mem,
+							  const int num_threads,
+							  const CurveballCalibration &calibration = CurveballCalibration()) {
+			double degree_sum = 0.0;
+			double degree_sq_sum = 0.0;
+			degree_t max_degree = 0;
+			for (; !degrees.empty(); ++degrees) {
+				const degree_t degree = *degrees;
+				degree_sum += degree;
+				degree_sq_sum += static_cast<double>(degree) * degree;
+				max_degree = std::max(max_degree, degree);
+			}
+			degrees.rewind();
+
+			_compute(num_nodes, num_edges, num_rounds, static_cast<double>(mem), num_threads,
+					 degree_sum, degree_sq_sum, max_degree, calibration);
+		}
+
+		chunkid_t num_macrochunks() const   {return _num_macrochunks;}
+		chunkid_t num_batches() const       {return _num_batches;}
+		chunkid_t num_fanout() const        {return _num_fanout;}
+		size_t size_insertionbuffer() const {return _size_insertionbuffer;}
+
+		//! Predicted maximum number of messages of a macrochunk, 0 if not estimated
+		msgid_t predicted_msgs_per_macrochunk() const {return _predicted_msgs_per_macrochunk;}
+
+		/**
+		 * Compares the message peak of a round with the predicted one.
+		 * @param round Global trade round.
+		 * @param max_mc_num_msgs Largest number of messages of a macrochunk in the round.
+		 */
+		void report_round(const tradeid_t round, const msgid_t max_mc_num_msgs) const {
+			std::cout << "Round " << round << ": message peak per macrochunk " << max_mc_num_msgs;
+			if (!_predicted_msgs_per_macrochunk) {
+				std::cout << std::endl;
+				return;
+			}
+			std::cout << " (predicted " << _predicted_msgs_per_macrochunk << ")" << std::endl;
+
+			if (max_mc_num_msgs > _predicted_msgs_per_macrochunk)
+				std::cout << "Warning: message peak exceeds the prediction by "
+						  << (max_mc_num_msgs - _predicted_msgs_per_macrochunk) << " messages" << std::endl;
+		}
+
+	protected:
+		chunkid_t _num_macrochunks = 0;
+		chunkid_t _num_batches = 0;
+		chunkid_t _num_fanout = 0;
+		size_t _size_insertionbuffer = 0;
+		msgid_t _predicted_msgs_per_macrochunk = 0;
+
+		void _compute(const node_t num_nodes, const edgeid_t num_edges, const tradeid_t num_rounds,
+					  const double mem, const int num_threads,
+					  const double degree_sum, const double degree_sq_sum, const degree_t max_degree,
+					  const CurveballCalibration &calib) {
+			const double n = std::max<double>(num_nodes, 1);
+			const double degree_var = std::max(0.0, degree_sq_sum / n - (degree_sum / n) * (degree_sum / n));
+
+			// message peak of a macrochunk, i.e. the degree sum of n/k
+			// random nodes, over all k macrochunks of all rounds
+			auto predict_peak = [&] (double k) {
+				const double mean = degree_sum / k;
+				const double deviation = std::sqrt(n / k * degree_var * (1.0 - 1.0 / k));
+				const double quantile = std::sqrt(2.0 * std::log(k * std::max<tradeid_t>(num_rounds, 1)));
+				return std::min(degree_sum, std::max<double>(mean + quantile * deviation, max_degree));
+			};
+
+			// the insertion buffers of both containers are excluded
+			const double mc_mem = (1.0 - calib.insertion_buffer_share) * mem;
+
+			auto mem_usage = [&] (double k) {
+				return predict_peak(k) * calib.bytes_per_msg
+					   + n / k * calib.bytes_per_node
+					   + 2 * k * calib.sequence_buffer_bytes;
+			};
+
+			// the usage decreases up to the point where the sequence buffers dominate
+			chunkid_t num_macrochunks = 2;
+			while (mem_usage(num_macrochunks) > mc_mem
+				   && num_macrochunks < static_cast<chunkid_t>(num_nodes / 2)
+				   && mem_usage(num_macrochunks + 1) < mem_usage(num_macrochunks))
+				num_macrochunks++;
+
+			const double predicted_peak = predict_peak(num_macrochunks);
+			const double nodes_per_mc = n / num_macrochunks;
+			const double work_per_mc = degree_sum / num_macrochunks;
+
+			// microchunks should hold enough neighbours to outweigh the
+			// synchronisation, but keep the batches small for few dependencies
+			const double max_microchunks = std::max(1.0, std::min(work_per_mc / calib.min_microchunk_work,
+																  nodes_per_mc / 2));
+			auto batches_for = [&] (chunkid_t fanout) {
+				return static_cast<chunkid_t>(std::max(1.0, std::min(
+						max_microchunks / (num_threads * fanout),
+						8.0 * num_macrochunks * num_threads)));
+			};
+
+			// a hub larger than a microchunk unbalances its batch, then a
+			// larger fanout lets the other threads take over more microchunks
+			const double work_per_microchunk = work_per_mc / (batches_for(1) * num_threads);
+			const chunkid_t num_fanout = (max_degree > work_per_microchunk ? 2 : 1);
+			const chunkid_t num_batches = batches_for(num_fanout);
+
+			// each thread keeps a buffer per macrochunk of both containers
+			const double buffer_msgs = calib.insertion_buffer_share * mem
+									   / (2.0 * num_macrochunks * num_threads * sizeof(NeighbourMsg));
+			const auto size_insertionbuffer = static_cast<size_t>(std::max(32.0, std::min(buffer_msgs, 16384.0)));
+
+			assert(num_batches < num_edges);
+
+			_num_macrochunks = num_macrochunks;
+			_num_batches = num_batches;
+			_num_fanout = num_fanout;
+			_size_insertionbuffer = size_insertionbuffer;
+			_predicted_msgs_per_macrochunk = static_cast<msgid_t>(std::ceil(predicted_peak));
+
+			// every message is written and read once per round
+			const double io_seconds = 2.0 * num_edges * sizeof(NeighbourMsg) / calib.disk_bandwidth;
+
+			std::cout << "Using the following estimated parameters for Curveball:\n"
+					  << "num_macrochunks:     \t" << _num_macrochunks << "\n"
+					  << "num batches:         \t" << _num_batches << "\n"
+					  << "num_fanout:          \t" << _num_fanout << "\n"
+					  << "size_insertionbuffer:\t" << _size_insertionbuffer << "\n"
+					  << "predicted msg peak:  \t" << _predicted_msgs_per_macrochunk
+					  << " per macrochunk (mean " << static_cast<msgid_t>(work_per_mc) << ")\n"
+					  << "predicted memory:    \t" << static_cast<size_t>(mem_usage(num_macrochunks))
+					  << " of " << static_cast<size_t>(mc_mem) << " bytes\n"
+					  << "predicted I/O:       \t" << io_seconds << " s per round" << std::endl;
+
+			if (mem_usage(num_macrochunks) > mc_mem)
+				std::cout << "Warning: the predicted message peak does not fit into the memory" << std::endl;
+		}
+	};
+
+}
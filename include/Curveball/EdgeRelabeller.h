@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @brief Output receiver relabelling the edges of Curveball
+ * @copyright to be decided
+ */
+#pragma once
+
+#include "defs.h"
+#include <cassert>
+
+namespace Curveball {
+
+	/**
+	 * Receiver relabelling both endpoints of each edge by a node-id mapping,
+	 * the normalized edge is forwarded to the underlying receiver.
+	 * Used as OutReceiver of EMCurveball (with unsorted output) or with
+	 * IMCurveball::forward_edges(), the randomised edges then reach the
+	 * caller's sorter without being sorted and mapped in additional passes.
+	 *
+	 * @tparam NodeMapping Has to support operator[](node_t), e.g. std::vector<node_t>.
+	 * @tparam Receiver Has to support push(edge_t).
+	 */
+	template <typename NodeMapping, typename Receiver>
+	class EdgeRelabeller {
+	protected:
+		const NodeMapping &_mapping;
+		Receiver &_out_edges;
+
+	public:
+		EdgeRelabeller(const NodeMapping &mapping, Receiver &out_edges)
+			: _mapping(mapping),
+			  _out_edges(out_edges) {}
+
+		void push(const edge_t &edge) {
+			edge_t relabelled(_mapping[edge.first], _mapping[edge.second]);
+			relabelled.normalize();
+
+			assert(!relabelled.is_loop());
+
+			_out_edges.push(relabelled);
+		}
+
+		//! The receiver may hold other edges already, hence it is not cleared
+		void clear() {}
+	};
+
+	template <typename NodeMapping, typename Receiver>
+	EdgeRelabeller<NodeMapping, Receiver> make_edge_relabeller(const NodeMapping &mapping, Receiver &out_edges) {
+		return EdgeRelabeller<NodeMapping, Receiver>(mapping, out_edges);
+	}
+
+}
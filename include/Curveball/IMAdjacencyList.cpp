@@ -31,11 +31,9 @@ namespace Curveball {
 		assert(degree_count <= _init_num_msgs);
 		assert(num_nodes <= _init_num_nodes);
 
-		std::fill(_offsets.begin(), _offsets.end(), 0);
+		for (auto &offset : _offsets)
+			offset.store(0, std::memory_order_relaxed);
 		std::fill(_neighbours.begin(), _neighbours.end(), 0);
-		for (auto &thread_count : _active_threads) {
-			thread_count = 0;
-		}
 
 		_degree_count = degree_count;
 
@@ -8,7 +8,6 @@
 #pragma once
 
 #include "defs.h"
-#include <mutex>
 #include <memory>
 #include <atomic>
 
@@ -18,11 +17,13 @@ namespace Curveball {
 	 * Data structure holding all messages/neighbours of nodes in the currently
 	 * processed macrochunk. It is implemented by a vector and pointers with
 	 * additional sentinels.
+	 * Concurrent insertions into a row reserve their slot by an atomic
+	 * increment of the row offset, hence no per-node locks are needed.
 	 */
 	class IMAdjacencyList {
 	public:
 		using degree_vector = std::vector<degree_t>;
-		using threadcount_vector = std::vector<std::atomic<int>>;
+		using offset_vector = std::vector<std::atomic<degree_t>>;
 		using neighbour_vector = std::vector<node_t>;
 		using pos_vector = std::vector<edgeid_t>;
 		using pos_it = pos_vector::iterator;
@@ -35,12 +36,9 @@ namespace Curveball {
 		neighbour_vector _neighbours;
 		neighbour_vector _partners;
 		std::vector<int> _edge_to_partner; // use int here for thread safety
-		degree_vector _offsets;
+		offset_vector _offsets;
 		pos_vector _begin;
 		edgeid_t _degree_count;
-		std::vector<std::mutex> _node_locks;
-
-		threadcount_vector _active_threads;
 
 		const node_t _init_num_nodes;
 		msgid_t _init_num_msgs;
@@ -62,8 +60,6 @@ namespace Curveball {
 				_offsets(static_cast<size_t>(num_nodes)),
 				_begin(static_cast<size_t>(num_nodes) + 1),
 				_degree_count(degree_count),
-				_node_locks(static_cast<size_t>(num_nodes)),
-				_active_threads(static_cast<size_t>(num_nodes)),
 				_init_num_nodes(num_nodes),
 				_init_num_msgs(degree_count) {}
 
@@ -128,13 +124,14 @@ namespace Curveball {
 		 * @param neighbour
 		 */
 		void insert_neighbour(const node_t node_id, const node_t neighbour) {
-			const auto pos = begin(node_id) + _offsets[node_id];
+			const degree_t offset = _offsets[node_id].load(std::memory_order_relaxed);
+			const auto pos = begin(node_id) + offset;
 
 			assert(*pos != LISTROW_END && *pos != IS_TRADED);
 
 			*pos = neighbour;
 
-			_offsets[node_id]++;
+			_offsets[node_id].store(offset + 1, std::memory_order_relaxed);
 		}
 
 		/**
@@ -167,20 +164,19 @@ namespace Curveball {
 		}
 
 		/**
-		 * Inserts a neighbour with synchronisation.
+		 * Inserts a neighbour with synchronisation, the slot in the row is
+		 * reserved by an atomic increment of the offset.
 		 * @param node Rank of node in the macrochunk.
 		 * @param neighbour Neigbour to be inserted
 		 */
 		void insert_neighbour_without_check(const node_t node,
 											const node_t neighbour) {
-			std::lock_guard<std::mutex> lock_guard(_node_locks[node]);
-			const auto pos = begin(node) + _offsets[node];
+			const degree_t offset = _offsets[node].fetch_add(1, std::memory_order_relaxed);
+			const auto pos = _neighbours.begin() + _begin[node] + offset;
 
 			assert(*pos != LISTROW_END && *pos != IS_TRADED);
 
 			*pos = neighbour;
-
-			_offsets[node]++;
 		}
 
 		/**
@@ -190,13 +186,7 @@ namespace Curveball {
 		 */
 		void insert_neighbour_without_check_lock(const node_t node,
 												 const node_t neighbour) {
-			const auto pos = begin(node) + _offsets[node];
-
-			assert(*pos != LISTROW_END && *pos != IS_TRADED);
-
-			*pos = neighbour;
-
-			_offsets[node]++;
+			insert_neighbour(node, neighbour);
 		}
 
 		/**
@@ -0,0 +1,353 @@
+/**
+ * @file
+ * @brief Parallel global Curveball trades in internal memory
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <numeric>
+#include <vector>
+#include <parallel/algorithm>
+#include <omp.h>
+
+#include <defs.h>
+#include <Utils/Hashfuncs.h>
+#include <Utils/NodeHash.h>
+#include <Utils/PhiloxRNG.h>
+#include <Utils/RandomSeed.h>
+#include "CurveballHelper.h"
+#include "SortedSetPartition.h"
+
+namespace Curveball {
+
+    /**
+     * Internal memory counterpart of EMCurveball for graphs fitting into RAM.
+     *
+     * In each global trade round the nodes are ranked by a random hash function
+     * and the nodes of rank 2i and 2i+1 trade. As in EM-PGCB, each edge is kept
+     * in the row of its endpoint of smaller rank, so a node has received its
+     * complete neighbourhood once all trades of smaller rank are done. Rows have
+     * a fixed capacity of the node's degree in a CSR layout. Trades of different
+     * pairs run in parallel: threads claim blocks of pairs and defer the ones
+     * whose neighbourhoods are still incomplete. The pair of smallest rank which
+     * has not traded yet is always tradable, hence all pairs eventually trade.
+     *
+     * The randomness of a trade is derived from (seed, round, node), such that
+     * the result does not depend on the number of threads.
+     *
+     * Usage: push() all edges, run(), then forward_edges().
+     *
+     * @tparam HashFactory Type of hash-functions, see EMCurveball.
+     */
+    template <typename HashFactory = ModHash>
+    class IMCurveball {
+    public:
+        using degree_vector = std::vector<degree_t>;
+
+    protected:
+        using counter_vector = std::vector<std::atomic<degree_t>>;
+
+        //! Number of pairs claimed at once by a thread
+        constexpr static node_t _pairs_per_block = 64;
+
+        //! Edges of a global trade round, each one kept by its endpoint of smaller rank
+        struct RoundEdges {
+            std::vector<node_t> ranks;
+            std::vector<node_t> order;
+
+            // row of u starts at offsets[u] and has capacity degree(u)
+            std::vector<node_t> neighbours;
+            counter_vector sizes;
+
+            // an edge between two trading nodes is not traded and kept aside
+            std::vector<node_t> partners;
+
+            RoundEdges(const node_t num_nodes, const edgeid_t capacity)
+                : ranks(static_cast<size_t>(num_nodes)),
+                  order(static_cast<size_t>(num_nodes)),
+                  neighbours(static_cast<size_t>(capacity)),
+                  sizes(static_cast<size_t>(num_nodes)),
+                  partners(static_cast<size_t>(num_nodes), INVALID_NODE) {}
+        };
+
+        const node_t _num_nodes;
+        const tradeid_t _num_rounds;
+        const int _num_threads;
+        const uint64_t _trade_seed;
+
+        std::vector<edgeid_t> _offsets;
+        edgeid_t _num_pushed_edges;
+
+        Hashfuncs<HashFactory> _hash_funcs;
+
+        RoundEdges _current;
+        RoundEdges _next;
+
+        // number of neighbours completely written into the rows of the current round
+        counter_vector _completed;
+
+        bool _has_run;
+
+        static std::vector<edgeid_t> _compute_offsets(const degree_vector & degrees) {
+            std::vector<edgeid_t> offsets(degrees.size() + 1, 0);
+            std::partial_sum(degrees.cbegin(), degrees.cend(), offsets.begin() + 1);
+            return offsets;
+        }
+
+        degree_t _degree(const node_t u) const {
+            return static_cast<degree_t>(_offsets[u + 1] - _offsets[u]);
+        }
+
+        //! Ranks the nodes by the hash function of the given round
+        void _assign_ranks(const tradeid_t round, RoundEdges & edges) {
+            const HashFactory hash = _hash_funcs[round];
+
+            std::iota(edges.order.begin(), edges.order.end(), 0);
+            __gnu_parallel::sort(edges.order.begin(), edges.order.end(),
+                                 [&hash] (const node_t a, const node_t b) {return hash.hash(a) < hash.hash(b);});
+
+            #pragma omp parallel for num_threads(_num_threads)
+            for (node_t rank = 0; rank < _num_nodes; rank++)
+                edges.ranks[edges.order[rank]] = rank;
+        }
+
+        //! Stores the edge {a, b} at its endpoint of smaller rank; thread-safe
+        void _place(RoundEdges & edges, node_t a, node_t b) {
+            if (edges.ranks[a] > edges.ranks[b])
+                std::swap(a, b);
+
+            if (!(edges.ranks[a] % 2) && edges.ranks[b] == edges.ranks[a] + 1) {
+                assert(edges.partners[a] == INVALID_NODE);
+                edges.partners[a] = b;
+                return;
+            }
+
+            const degree_t slot = edges.sizes[a].fetch_add(1, std::memory_order_relaxed);
+            assert(slot < _degree(a));
+            edges.neighbours[_offsets[a] + slot] = b;
+        }
+
+        //! Inserts a neighbour into the row of a node which trades later in this round
+        void _forward(const node_t target, const node_t neighbour) {
+            const degree_t slot = _current.sizes[target].fetch_add(1, std::memory_order_relaxed);
+            assert(slot < _degree(target));
+            _current.neighbours[_offsets[target] + slot] = neighbour;
+
+            _completed[target].fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+         * Trades the nodes of rank 2*pair and 2*pair+1 if both received their
+         * complete neighbourhoods.
+         * @return Whether the trade was carried out.
+         */
+        bool _try_trade(const node_t pair, const tradeid_t round,
+                        std::vector<node_t> & common_neighbours,
+                        std::vector<node_t> & disjoint_neighbours) {
+            const node_t u = _current.order[2 * pair];
+            const bool shared = (_current.partners[u] != INVALID_NODE);
+
+            const degree_t u_size = _degree(u) - shared;
+            if (_completed[u].load(std::memory_order_acquire) != u_size)
+                return false;
+
+            const auto u_begin = _current.neighbours.begin() + _offsets[u];
+            const auto u_end = u_begin + u_size;
+
+            // the last node has no partner if the number of nodes is odd
+            if (2 * pair + 1 == _num_nodes) {
+                for (auto it = u_begin; it != u_end; ++it)
+                    _place(_next, u, *it);
+
+                return true;
+            }
+
+            const node_t v = _current.order[2 * pair + 1];
+            assert(!shared || _current.partners[u] == v);
+
+            const degree_t v_size = _degree(v) - shared;
+            if (_completed[v].load(std::memory_order_acquire) != v_size)
+                return false;
+
+            const auto v_begin = _current.neighbours.begin() + _offsets[v];
+            const auto v_end = v_begin + v_size;
+
+            std::sort(u_begin, u_end);
+            std::sort(v_begin, v_end);
+
+            common_neighbours.clear();
+            disjoint_neighbours.clear();
+            CurveballImpl::sorted_set_partition(u_begin, u_end, v_begin, v_end,
+                                                common_neighbours, disjoint_neighbours);
+
+            // assign the first u_keeps disjoint neighbours to u, the others to v
+            const auto u_keeps = static_cast<size_t>(u_size) - common_neighbours.size();
+            PhiloxRNG rng((static_cast<uint64_t>(round) << 32) | _trade_seed, static_cast<uint64_t>(u));
+            CurveballImpl::random_partition(disjoint_neighbours.begin(), disjoint_neighbours.end(),
+                                            u_keeps, rng);
+
+            // neighbours of larger rank trade later in this round, all others already traded
+            const node_t v_rank = _current.ranks[v];
+            auto send = [&] (const node_t node, const node_t neighbour) {
+                if (_current.ranks[neighbour] > v_rank)
+                    _forward(neighbour, node);
+                else
+                    _place(_next, node, neighbour);
+            };
+
+            for (size_t i = 0; i < disjoint_neighbours.size(); i++)
+                send(i < u_keeps ? u : v, disjoint_neighbours[i]);
+
+            for (const node_t common : common_neighbours) {
+                send(u, common);
+                send(v, common);
+            }
+
+            if (shared)
+                _place(_next, u, v);
+
+            return true;
+        }
+
+        void _trade_round(const tradeid_t round) {
+            const node_t num_pairs = (_num_nodes + 1) / 2;
+            std::atomic<node_t> next_block{0};
+
+            #pragma omp parallel num_threads(_num_threads)
+            {
+                std::vector<node_t> common_neighbours;
+                std::vector<node_t> disjoint_neighbours;
+                std::vector<node_t> deferred;
+
+                auto retry_deferred = [&] {
+                    deferred.erase(std::remove_if(deferred.begin(), deferred.end(), [&] (const node_t pair) {
+                        return _try_trade(pair, round, common_neighbours, disjoint_neighbours);
+                    }), deferred.end());
+                };
+
+                while (true) {
+                    const node_t begin = next_block.fetch_add(1) * _pairs_per_block;
+                    if (begin >= num_pairs)
+                        break;
+
+                    const node_t end = std::min(num_pairs, begin + _pairs_per_block);
+                    for (node_t pair = begin; pair < end; pair++) {
+                        if (!_try_trade(pair, round, common_neighbours, disjoint_neighbours))
+                            deferred.push_back(pair);
+                    }
+
+                    // do not run too far ahead of the pairs we wait for
+                    do {
+                        retry_deferred();
+                    } while (deferred.size() > static_cast<size_t>(_pairs_per_block));
+                }
+
+                while (!deferred.empty())
+                    retry_deferred();
+            }
+        }
+
+    public:
+        IMCurveball() = delete;
+        IMCurveball(const IMCurveball &) = delete;
+
+        /**
+         * @param degrees Degrees of the nodes; the pushed edges have to match them.
+         * @param num_rounds Number of global trade rounds.
+         * @param num_threads Number of threads.
+         */
+        IMCurveball(const degree_vector & degrees,
+                    const tradeid_t num_rounds,
+                    const int num_threads = omp_get_max_threads())
+            : _num_nodes(static_cast<node_t>(degrees.size())),
+              _num_rounds(num_rounds),
+              _num_threads(num_threads),
+              _trade_seed(RandomSeed::get_instance().get_next_seed()),
+              _offsets(_compute_offsets(degrees)),
+              _num_pushed_edges(0),
+              _hash_funcs(_num_nodes, num_rounds),
+              _current(_num_nodes, _offsets.back()),
+              _next(_num_nodes, _offsets.back()),
+              _completed(static_cast<size_t>(_num_nodes)),
+              _has_run(false)
+        {
+            assert(num_rounds > 0);
+            assert(!(_offsets.back() % 2));
+
+            _assign_ranks(0, _current);
+        }
+
+        /**
+         * Internal memory in bytes required for the given graph.
+         */
+        static size_t memoryUsage(const node_t num_nodes, const edgeid_t num_edges) {
+            const size_t per_node = sizeof(edgeid_t)
+                                    + 2 * (3 * sizeof(node_t) + sizeof(std::atomic<degree_t>))
+                                    + sizeof(std::atomic<degree_t>);
+            return 2 * 2 * static_cast<size_t>(num_edges) * sizeof(node_t)
+                   + static_cast<size_t>(num_nodes) * per_node;
+        }
+
+        //! Pushes an edge of the initial graph; edges must be pushed sequentially
+        void push(const edge_t & edge) {
+            assert(!_has_run);
+            assert(!edge.is_loop());
+            assert(edge.first < _num_nodes && edge.second < _num_nodes);
+
+            _place(_current, edge.first, edge.second);
+            _num_pushed_edges++;
+        }
+
+        //! Carries out all global trade rounds
+        void run() {
+            assert(!_has_run);
+            assert(2 * _num_pushed_edges == _offsets.back());
+
+            for (tradeid_t round = 0; round < _num_rounds; round++) {
+                // the last round places the edges by the identity
+                _assign_ranks(round + 1, _next);
+
+                #pragma omp parallel for num_threads(_num_threads)
+                for (node_t u = 0; u < _num_nodes; u++) {
+                    _completed[u].store(_current.sizes[u].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    _next.sizes[u].store(0, std::memory_order_relaxed);
+                    _next.partners[u] = INVALID_NODE;
+                }
+
+                _trade_round(round);
+
+                std::swap(_current, _next);
+            }
+
+            _has_run = true;
+        }
+
+        /**
+         * Pushes the randomised edges into the receiver, normalized and sorted.
+         * @tparam Receiver Has to support push(edge_t).
+         */
+        template <typename Receiver>
+        void forward_edges(Receiver & out_edges) {
+            assert(_has_run);
+
+            std::vector<node_t> row;
+            for (node_t u = 0; u < _num_nodes; u++) {
+                const auto row_begin = _current.neighbours.cbegin() + _offsets[u];
+                row.assign(row_begin, row_begin + _current.sizes[u].load(std::memory_order_relaxed));
+                if (_current.partners[u] != INVALID_NODE)
+                    row.push_back(_current.partners[u]);
+
+                std::sort(row.begin(), row.end());
+
+                for (const node_t v : row) {
+                    assert(u < v);
+                    out_edges.push(edge_t{u, v});
+                }
+            }
+        }
+    };
+
+}
@@ -8,7 +8,9 @@
 #pragma once
 
 #include "defs.h"
+#include "MsgBlockCodec.h"
 #include <vector>
+#include <memory>
 #include <stxxl/sequence>
 #include <parallel/algorithm>
 #include <mutex>
@@ -20,6 +22,8 @@ namespace Curveball {
 	/**
 	 * Implements a macrochunk by a STXXL sequence (works similar to queues
 	 * but has better overhead).
+	 * Optionally the messages are stored in compressed blocks, see
+	 * MsgBlockCodec, which reduces the I/O volume of each round.
 	 */
 	class IMMacrochunk {
 	public:
@@ -31,6 +35,10 @@ namespace Curveball {
 
 		// extmem buffer
 		using sequence_type = stxxl::sequence<value_type>;
+		using code_sequence_type = stxxl::sequence<MsgBlockCodec::word_type>;
+
+		// number of messages pushed one by one that are encoded as a block
+		static constexpr size_t STAGED_BLOCK_SIZE = 1024;
 
 	protected:
 		// enforcing invariants
@@ -40,6 +48,14 @@ namespace Curveball {
 		// EM data structure to store
 		sequence_type _msg_sequence;
 
+		// EM data structure to store compressed blocks instead, only
+		// allocated if compression is enabled
+		std::unique_ptr<code_sequence_type> _code_sequence;
+		msgid_t _num_encoded_msgs = 0;
+
+		// messages pushed one by one are collected to a block first
+		std::vector<value_type> _staged_msgs;
+
 		const chunkid_t _chunkid = 0;
 		const msgid_t _msg_limit = 0;
 
@@ -59,6 +75,9 @@ namespace Curveball {
 		 */
 		IMMacrochunk(IMMacrochunk &&other) noexcept
 			: _mode(other._mode),
+			  _code_sequence(std::move(other._code_sequence)),
+			  _num_encoded_msgs(other._num_encoded_msgs),
+			  _staged_msgs(std::move(other._staged_msgs)),
 			  _chunkid(other._chunkid),
 			  _msg_limit(other._msg_limit),
 			  _msg_count(other._msg_count) {
@@ -69,9 +88,11 @@ namespace Curveball {
 		 * Sets up the macrochunk.
 		 * @param chunkid Macrochunk-id.
 		 * @param msg_limit Maximum number of messages.
+		 * @param compressed Flag whether messages are stored in compressed blocks.
 		 */
-		IMMacrochunk(const chunkid_t chunkid, const msgid_t msg_limit)
-			: _chunkid(chunkid),
+		IMMacrochunk(const chunkid_t chunkid, const msgid_t msg_limit, const bool compressed = false)
+			: _code_sequence(compressed ? new code_sequence_type : nullptr),
+			  _chunkid(chunkid),
 			  _msg_limit(msg_limit) {
 			init();
 		}
@@ -100,24 +121,34 @@ namespace Curveball {
 		}
 
 		/**
-		 * Pushes all messages contained in this macrochunk into the provided
-		 * vector.
+		 * Appends all messages contained in this macrochunk to the provided
+		 * vector, which may already hold the prefetched messages.
 		 * @param msgs_out Output message vector.
 		 * @return Flag whether the macrochunk messages do not exceed the limit.
 		 */
 		bool load_messages(msg_vector& msgs_out) {
 			//TODO: if case for when whole sequence is too big for IM
 			assert(_mode == PENDING);
-			auto msg_stream = _msg_sequence.get_stream();
+			_flush_staged_msgs();
+
+			const auto num_msgs = (_code_sequence
+								   ? static_cast<size_t>(_num_encoded_msgs)
+								   : static_cast<size_t>(_msg_sequence.size()));
 
 			// all messages fit into IM
-			if (msg_stream.size() <= static_cast<size_t>(_msg_limit)) {
+			if (msgs_out.size() + num_msgs <= static_cast<size_t>(_msg_limit)) {
 				// load messages into IM
-				msgs_out.reserve(msg_stream.size());
-
-				while (!msg_stream.empty()) {
-					msgs_out.push_back(*msg_stream);
-					++msg_stream;
+				msgs_out.reserve(msgs_out.size() + num_msgs);
+
+				if (_code_sequence) {
+					for (auto code_stream = _code_sequence->get_stream(); !code_stream.empty(); )
+						MsgBlockCodec::decode(code_stream, msgs_out);
+				} else {
+					auto msg_stream = _msg_sequence.get_stream();
+					while (!msg_stream.empty()) {
+						msgs_out.push_back(*msg_stream);
+						++msg_stream;
+					}
 				}
 
 				#ifndef NDEBUG
@@ -138,6 +169,48 @@ namespace Curveball {
 			}
 		}
 
+		/**
+		 * Moves the messages received so far into the provided vector.
+		 * May be called while other threads push messages, those are kept
+		 * in a fresh sequence and are retrieved by load_messages().
+		 * @param msgs_out Output message vector.
+		 */
+		void prefetch_messages(msg_vector& msgs_out) {
+			if (_code_sequence) {
+				std::unique_ptr<code_sequence_type> received(new code_sequence_type);
+				msgid_t num_received;
+				{
+					std::lock_guard<std::mutex> pushing_guard(_pushing_lock);
+					assert(_mode == PENDING);
+
+					_flush_staged_msgs();
+					_code_sequence.swap(received);
+					num_received = _num_encoded_msgs;
+					_num_encoded_msgs = 0;
+				}
+
+				msgs_out.reserve(static_cast<size_t>(num_received));
+				for (auto code_stream = received->get_stream(); !code_stream.empty(); )
+					MsgBlockCodec::decode(code_stream, msgs_out);
+
+				return;
+			}
+
+			sequence_type received;
+			{
+				std::lock_guard<std::mutex> pushing_guard(_pushing_lock);
+				assert(_mode == PENDING);
+
+				_msg_sequence.swap(received);
+			}
+
+			auto msg_stream = received.get_stream();
+			msgs_out.reserve(msg_stream.size());
+
+			for (; !msg_stream.empty(); ++msg_stream)
+				msgs_out.push_back(*msg_stream);
+		}
+
 		/**
 		 * Forwards a single message.
 		 * Is used in the initialization phase.
@@ -146,7 +219,12 @@ namespace Curveball {
 		void push_sequential(const value_type &msg) {
 			assert(_mode == PENDING);
 
-			_msg_sequence.push_back(msg);
+			if (_code_sequence) {
+				_staged_msgs.push_back(msg);
+				if (_staged_msgs.size() >= STAGED_BLOCK_SIZE)
+					_flush_staged_msgs();
+			} else
+				_msg_sequence.push_back(msg);
 
 			_msg_count++;
 		}
@@ -158,9 +236,7 @@ namespace Curveball {
 		void bulk_push_sequential(const std::vector<value_type> &msg_bulk) {
 			assert(_mode == PENDING);
 
-			for (const value_type msg : msg_bulk) {
-				_msg_sequence.push_back(msg);
-			}
+			_push_bulk(msg_bulk);
 
 			_msg_count += msg_bulk.size();
 		}
@@ -176,9 +252,7 @@ namespace Curveball {
 
 			assert(_mode == PENDING);
 
-			for (const value_type msg : msg_bulk) {
-				_msg_sequence.push_back(msg);
-			}
+			_push_bulk(msg_bulk);
 
 			_msg_count += msg_bulk.size();
 		}
@@ -192,6 +266,12 @@ namespace Curveball {
 
 			assert(_msg_sequence.empty());
 
+			if (_code_sequence) {
+				_code_sequence.reset(new code_sequence_type);
+				_num_encoded_msgs = 0;
+				_staged_msgs.clear();
+			}
+
 			_mode = PENDING;
 
 			_msg_count = 0;
@@ -204,6 +284,21 @@ namespace Curveball {
 		 */
 		template <typename Receiver>
 		void forward_unsorted_edges(Receiver & out_edges) {
+			if (_code_sequence) {
+				_flush_staged_msgs();
+
+				msg_vector block;
+				for (auto code_stream = _code_sequence->get_stream(); !code_stream.empty(); ) {
+					block.clear();
+					MsgBlockCodec::decode(code_stream, block);
+
+					for (const auto & msg : block)
+						out_edges.push({msg.target, msg.neighbour});
+				}
+
+				return;
+			}
+
 			auto msg_stream = _msg_sequence.get_stream();
 
 			for (; !msg_stream.empty(); ++msg_stream) {
@@ -211,6 +306,33 @@ namespace Curveball {
 				out_edges.push({msg.target, msg.neighbour});
 			}
 		}
+
+	protected:
+		/**
+		 * Appends messages to the sequence, in compressed mode as one block.
+		 * @param msg_bulk Vector of messages.
+		 */
+		void _push_bulk(const std::vector<value_type> &msg_bulk) {
+			if (_code_sequence) {
+				MsgBlockCodec::encode(msg_bulk.data(), msg_bulk.data() + msg_bulk.size(), *_code_sequence);
+				_num_encoded_msgs += msg_bulk.size();
+			} else {
+				for (const value_type msg : msg_bulk) {
+					_msg_sequence.push_back(msg);
+				}
+			}
+		}
+
+		/**
+		 * Encodes the messages pushed one by one in compressed mode.
+		 */
+		void _flush_staged_msgs() {
+			if (_staged_msgs.empty())
+				return;
+
+			_push_bulk(_staged_msgs);
+			_staged_msgs.clear();
+		}
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+/**
+ * @file
+ * @brief Block-wise compression of the neighbour messages of a macrochunk
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "defs.h"
+
+namespace Curveball {
+
+	/**
+	 * Encodes blocks of messages into 64 bit words for an external sequence.
+	 *
+	 * A block is sorted by target; the targets are stored as varint-coded
+	 * differences to their predecessor and the neighbours as varints. Since
+	 * all targets of a macrochunk lie in a small range, a message takes about
+	 * five instead of eight bytes. The block is preceded by a header word
+	 * holding the number of messages and of payload words.
+	 */
+	class MsgBlockCodec {
+	public:
+		using word_type = uint64_t;
+
+		//! Maximum number of bytes of an encoded message
+		static constexpr size_t MAX_MSG_BYTES = 10;
+
+		/**
+		 * Encodes the messages and appends the block to the sequence.
+		 * @tparam Sequence Sequence of word_type supporting push_back.
+		 * @param begin, end Messages of the block, their order is irrelevant.
+		 * @param sequence Output sequence.
+		 */
+		template <typename Sequence>
+		static void encode(const NeighbourMsg* begin, const NeighbourMsg* end, Sequence &sequence) {
+			const auto num_msgs = static_cast<size_t>(end - begin);
+			if (!num_msgs)
+				return;
+
+			// buffers are kept per thread, since blocks are flushed concurrently
+			static thread_local std::vector<NeighbourMsg> sorted;
+			static thread_local std::vector<uint8_t> bytes;
+
+			sorted.assign(begin, end);
+			std::sort(sorted.begin(), sorted.end(),
+					  [] (const NeighbourMsg &a, const NeighbourMsg &b) {return a.target < b.target;});
+
+			bytes.resize(num_msgs * MAX_MSG_BYTES + sizeof(word_type));
+			uint8_t* out = bytes.data();
+
+			hnode_t last_target = 0;
+			for (const auto &msg : sorted) {
+				assert(msg.target >= last_target);
+				assert(msg.neighbour >= 0);
+
+				out = _put_varint(out, static_cast<uint32_t>(msg.target - last_target));
+				out = _put_varint(out, static_cast<uint32_t>(msg.neighbour));
+				last_target = msg.target;
+			}
+
+			const auto num_bytes = static_cast<size_t>(out - bytes.data());
+			const size_t num_words = (num_bytes + sizeof(word_type) - 1) / sizeof(word_type);
+			std::fill(out, bytes.data() + num_words * sizeof(word_type), 0);
+
+			sequence.push_back(static_cast<word_type>(num_msgs) << 32 | num_words);
+			for (size_t i = 0; i < num_words; i++)
+				sequence.push_back(_load_word(bytes.data() + i * sizeof(word_type)));
+		}
+
+		/**
+		 * Decodes the block at the position of the stream and appends its
+		 * messages to the vector.
+		 * @tparam Stream Stream of word_type, positioned at a header word.
+		 * @param stream Input stream, positioned after the block afterwards.
+		 * @param msgs_out Output message vector.
+		 */
+		template <typename Stream>
+		static void decode(Stream &stream, msg_vector &msgs_out) {
+			assert(!stream.empty());
+
+			const word_type header = *stream;
+			++stream;
+
+			const auto num_msgs = static_cast<size_t>(header >> 32);
+			const auto num_words = static_cast<size_t>(header & 0xffffffffu);
+
+			static thread_local std::vector<uint8_t> bytes;
+			bytes.resize(num_words * sizeof(word_type));
+			for (size_t i = 0; i < num_words; i++, ++stream) {
+				assert(!stream.empty());
+				_store_word(bytes.data() + i * sizeof(word_type), *stream);
+			}
+
+			const uint8_t* in = bytes.data();
+			hnode_t target = 0;
+			for (size_t i = 0; i < num_msgs; i++) {
+				uint32_t delta, neighbour;
+				in = _get_varint(in, delta);
+				in = _get_varint(in, neighbour);
+
+				target += static_cast<hnode_t>(delta);
+				msgs_out.emplace_back(target, static_cast<node_t>(neighbour));
+			}
+
+			assert(in <= bytes.data() + bytes.size());
+		}
+
+	protected:
+		static uint8_t* _put_varint(uint8_t* out, uint32_t value) {
+			while (value >= 0x80) {
+				*out++ = static_cast<uint8_t>(value | 0x80);
+				value >>= 7;
+			}
+			*out++ = static_cast<uint8_t>(value);
+			return out;
+		}
+
+		static const uint8_t* _get_varint(const uint8_t* in, uint32_t &value) {
+			value = 0;
+			for (unsigned int shift = 0; ; shift += 7) {
+				const uint8_t byte = *in++;
+				value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+				if (!(byte & 0x80))
+					return in;
+			}
+		}
+
+		static word_type _load_word(const uint8_t* bytes) {
+			word_type word = 0;
+			for (size_t i = 0; i < sizeof(word_type); i++)
+				word |= static_cast<word_type>(bytes[i]) << (8 * i);
+			return word;
+		}
+
+		static void _store_word(uint8_t* bytes, word_type word) {
+			for (size_t i = 0; i < sizeof(word_type); i++)
+				bytes[i] = static_cast<uint8_t>(word >> (8 * i));
+		}
+	};
+
+}
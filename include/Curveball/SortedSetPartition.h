@@ -0,0 +1,217 @@
+/**
+ * @file
+ * @brief Partition of two sorted neighbourhoods into common and disjoint neighbours
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <defs.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CB_SET_PARTITION_X86
+#endif
+
+namespace CurveballImpl {
+
+    //! Kernels available to mark the common elements of two sorted sets
+    enum class SetPartitionKernel {
+        Scalar, SSE4, AVX2
+    };
+
+    namespace set_partition_internal {
+        using flag_vector = std::vector<uint8_t>;
+
+        //! Scalar merge marking the common elements in a[i, na) and b[j, nb)
+        inline void mark_common_scalar(const node_t* a, size_t i, const size_t na,
+                                       const node_t* b, size_t j, const size_t nb,
+                                       uint8_t* a_flags, uint8_t* b_flags) {
+            while (i < na && j < nb) {
+                const node_t x = a[i];
+                const node_t y = b[j];
+                if (x == y) {
+                    a_flags[i] = 1;
+                    b_flags[j] = 1;
+                }
+                i += (x <= y);
+                j += (y <= x);
+            }
+        }
+
+        //! Sets the flags of the lanes in mask
+        inline void set_flags(uint8_t* flags, unsigned int mask) {
+            for (; mask; mask &= mask - 1)
+                flags[__builtin_ctz(mask)] = 1;
+        }
+
+#ifdef CB_SET_PARTITION_X86
+        /**
+         * Block-wise comparison of four elements of a with four elements of b
+         * by comparing against all rotations; the block with the smaller
+         * maximum is advanced. Elements may be marked several times.
+         */
+        __attribute__((target("sse4.1")))
+        inline void mark_common_sse4(const node_t* a, const size_t na,
+                                     const node_t* b, const size_t nb,
+                                     uint8_t* a_flags, uint8_t* b_flags) {
+            size_t i = 0, j = 0;
+            while (i + 4 <= na && j + 4 <= nb) {
+                const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+                const __m128i vb1 = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+                const __m128i vb2 = _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2));
+                const __m128i vb3 = _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3));
+
+                const __m128i eq0 = _mm_cmpeq_epi32(va, vb);
+                const __m128i eq1 = _mm_cmpeq_epi32(va, vb1);
+                const __m128i eq2 = _mm_cmpeq_epi32(va, vb2);
+                const __m128i eq3 = _mm_cmpeq_epi32(va, vb3);
+
+                const __m128i a_match = _mm_or_si128(_mm_or_si128(eq0, eq1), _mm_or_si128(eq2, eq3));
+                const unsigned int a_mask = _mm_movemask_ps(_mm_castsi128_ps(a_match));
+
+                if (a_mask) {
+                    // lane k of eq_r compares a[k] with b[(k + r) % 4], rotate back to b's lanes
+                    const __m128i b_match = _mm_or_si128(
+                        _mm_or_si128(eq0, _mm_shuffle_epi32(eq1, _MM_SHUFFLE(2, 1, 0, 3))),
+                        _mm_or_si128(_mm_shuffle_epi32(eq2, _MM_SHUFFLE(1, 0, 3, 2)),
+                                     _mm_shuffle_epi32(eq3, _MM_SHUFFLE(0, 3, 2, 1))));
+
+                    set_flags(a_flags + i, a_mask);
+                    set_flags(b_flags + j, _mm_movemask_ps(_mm_castsi128_ps(b_match)));
+                }
+
+                const node_t a_max = a[i + 3];
+                const node_t b_max = b[j + 3];
+                i += 4 * (a_max <= b_max);
+                j += 4 * (b_max <= a_max);
+            }
+
+            mark_common_scalar(a, i, na, b, j, nb, a_flags, b_flags);
+        }
+
+        //! Same as mark_common_sse4 with blocks of eight elements
+        __attribute__((target("avx2")))
+        inline void mark_common_avx2(const node_t* a, const size_t na,
+                                     const node_t* b, const size_t nb,
+                                     uint8_t* a_flags, uint8_t* b_flags) {
+            const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+            size_t i = 0, j = 0;
+            while (i + 8 <= na && j + 8 <= nb) {
+                const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+
+                // compare a[k] with b[(k + r) % 8] for all rotations r
+                __m256i a_match = _mm256_cmpeq_epi32(va, vb);
+                for (int r = 1; r < 8; r++) {
+                    vb = _mm256_permutevar8x32_epi32(vb, rotate);
+                    a_match = _mm256_or_si256(a_match, _mm256_cmpeq_epi32(va, vb));
+                }
+
+                const unsigned int a_mask = _mm256_movemask_ps(_mm256_castsi256_ps(a_match));
+
+                if (a_mask) {
+                    const __m256i vb0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+                    __m256i va_rot = va;
+                    __m256i b_match = _mm256_cmpeq_epi32(vb0, va_rot);
+                    for (int r = 1; r < 8; r++) {
+                        va_rot = _mm256_permutevar8x32_epi32(va_rot, rotate);
+                        b_match = _mm256_or_si256(b_match, _mm256_cmpeq_epi32(vb0, va_rot));
+                    }
+
+                    set_flags(a_flags + i, a_mask);
+                    set_flags(b_flags + j, _mm256_movemask_ps(_mm256_castsi256_ps(b_match)));
+                }
+
+                const node_t a_max = a[i + 7];
+                const node_t b_max = b[j + 7];
+                i += 8 * (a_max <= b_max);
+                j += 8 * (b_max <= a_max);
+            }
+
+            mark_common_scalar(a, i, na, b, j, nb, a_flags, b_flags);
+        }
+#endif
+    }
+
+    /**
+     * @return Fastest kernel supported by the executing CPU.
+     */
+    inline SetPartitionKernel best_set_partition_kernel() {
+#ifdef CB_SET_PARTITION_X86
+        static const SetPartitionKernel kernel =
+            __builtin_cpu_supports("avx2")   ? SetPartitionKernel::AVX2
+          : __builtin_cpu_supports("sse4.1") ? SetPartitionKernel::SSE4
+          :                                    SetPartitionKernel::Scalar;
+        return kernel;
+#else
+        return SetPartitionKernel::Scalar;
+#endif
+    }
+
+    /**
+     * Partitions two sorted sets without duplicates into their intersection
+     * and their symmetric difference. Common elements are appended to common
+     * in ascending order, the elements of a not in b followed by the ones of b
+     * not in a are appended to disjoint, each in ascending order. The result
+     * does not depend on the kernel.
+     *
+     * @tparam It Iterator of contiguous storage, e.g. of a std::vector<node_t>.
+     * @param a_it, a_end Sorted first set.
+     * @param b_it, b_end Sorted second set.
+     * @param common Output of the intersection.
+     * @param disjoint Output of the symmetric difference.
+     * @param kernel Kernel used to find the common elements; has to be supported by the CPU.
+     */
+    template <typename It>
+    void sorted_set_partition(const It a_it, const It a_end,
+                              const It b_it, const It b_end,
+                              std::vector<node_t>& common,
+                              std::vector<node_t>& disjoint,
+                              const SetPartitionKernel kernel = best_set_partition_kernel()) {
+        const size_t na = static_cast<size_t>(a_end - a_it);
+        const size_t nb = static_cast<size_t>(b_end - b_it);
+
+        // empty ranges must not be dereferenced
+        const node_t* a_begin = na ? &*a_it : nullptr;
+        const node_t* b_begin = nb ? &*b_it : nullptr;
+
+        // flags of the common elements, kept per thread to avoid allocations in every trade
+        static thread_local set_partition_internal::flag_vector flags;
+        flags.assign(na + nb, 0);
+        uint8_t* a_flags = flags.data();
+        uint8_t* b_flags = flags.data() + na;
+
+        switch (kernel) {
+#ifdef CB_SET_PARTITION_X86
+            case SetPartitionKernel::AVX2:
+                set_partition_internal::mark_common_avx2(a_begin, na, b_begin, nb, a_flags, b_flags);
+                break;
+            case SetPartitionKernel::SSE4:
+                set_partition_internal::mark_common_sse4(a_begin, na, b_begin, nb, a_flags, b_flags);
+                break;
+#endif
+            default:
+                set_partition_internal::mark_common_scalar(a_begin, 0, na, b_begin, 0, nb, a_flags, b_flags);
+        }
+
+        for (size_t i = 0; i < na; i++) {
+            if (a_flags[i])
+                common.push_back(a_begin[i]);
+            else
+                disjoint.push_back(a_begin[i]);
+        }
+
+        for (size_t j = 0; j < nb; j++) {
+            if (!b_flags[j])
+                disjoint.push_back(b_begin[j]);
+        }
+    }
+
+}
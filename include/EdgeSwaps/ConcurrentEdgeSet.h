@@ -0,0 +1,186 @@
+/**
+ * @file
+ * @brief Lock-free open-addressing hash set of edges with claimable entries
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+
+#include <defs.h>
+
+/**
+ * @brief Hash set of normalized edges supporting concurrent lookups, insertions and removals.
+ *
+ * Each edge is packed into a single 64 bit word which is stored in a linear probing table.
+ * Entries may carry a claim bit: A claimed entry is owned by a thread that tentatively
+ * inserted the edge; other threads encountering it are informed, so that they can retry
+ * later instead of observing an intermediate state. This allows to modify several edges
+ * (as in a swap) atomically without any locks.
+ *
+ * Slots never become empty again once used (removed entries are replaced by tombstones),
+ * hence a key is always located before the first empty slot of its probe sequence.
+ * Call needsRebuild() before each phase of concurrent updates and rebuild the table
+ * by clear() and insert() if it reports true; otherwise the table may run full.
+ */
+class ConcurrentEdgeSet {
+    static_assert(sizeof(node_t) <= 4, "Two node ids and the claim bit have to fit into 64 bits");
+
+public:
+    enum class Result {
+        Inserted, //!< Edge was absent and is now claimed by the caller
+        Exists,   //!< Edge exists and is not claimed
+        Claimed   //!< Edge is claimed by another thread; retry later
+    };
+
+    using slot_t = uint64_t;
+
+protected:
+    using key_t = uint64_t;
+
+    constexpr static key_t _empty = ~key_t(0);
+    constexpr static key_t _tombstone = ~key_t(0) - 1;
+    constexpr static key_t _claim_bit = key_t(1) << 63;
+
+    std::unique_ptr<std::atomic<key_t>[]> _table;
+    slot_t _capacity;
+    slot_t _mask;
+    unsigned int _shift;
+
+    std::atomic<uint_t> _used_slots;
+
+    static key_t _key(const edge_t & e) {
+        assert(e.first >= 0 && e.first < e.second);
+        return (static_cast<key_t>(e.first) << 32) | static_cast<uint32_t>(e.second);
+    }
+
+    slot_t _home(key_t key) const {
+        return (key * 0x9E3779B97F4A7C15llu) >> _shift;
+    }
+
+    //! Returns the slot containing key or key|claim
+    slot_t _find(key_t key) const {
+        for (slot_t pos = _home(key); ; pos = (pos + 1) & _mask) {
+            const key_t cur = _table[pos].load(std::memory_order_acquire);
+            if ((cur & ~_claim_bit) == key)
+                return pos;
+            assert(cur != _empty);
+        }
+    }
+
+public:
+    ConcurrentEdgeSet() : _capacity(0), _mask(0), _shift(64), _used_slots(0) {}
+
+    //! Allocates a table for at least the given number of edges with load factor at most 1/2
+    explicit ConcurrentEdgeSet(uint_t edges) : ConcurrentEdgeSet() {
+        resize(edges);
+    }
+
+    ConcurrentEdgeSet(const ConcurrentEdgeSet &) = delete;
+
+    void resize(uint_t edges) {
+        _shift = 64;
+        _capacity = 1;
+        while (_capacity < 2 * edges + 2) {
+            _capacity *= 2;
+            --_shift;
+        }
+        _mask = _capacity - 1;
+
+        _table.reset(new std::atomic<key_t>[_capacity]);
+        clear();
+    }
+
+    //! Removes all edges. Not thread-safe.
+    void clear() {
+        for (slot_t i = 0; i < _capacity; ++i)
+            _table[i].store(_empty, std::memory_order_relaxed);
+        _used_slots.store(0, std::memory_order_relaxed);
+    }
+
+    //! True if the table has to be rebuilt before the given number of insertions
+    //! (successful or withdrawn), i.e. if more than 3/4 of the slots would be used
+    bool needsRebuild(uint_t insertions = 0) const {
+        return 4 * (_used_slots.load(std::memory_order_relaxed) + insertions) > 3 * _capacity;
+    }
+
+    //! Inserts an edge that must not exist yet; thread-safe w.r.t. other insert() calls
+    void insert(const edge_t & e) {
+        const key_t key = _key(e);
+        for (slot_t pos = _home(key); ; pos = (pos + 1) & _mask) {
+            key_t expected = _empty;
+            if (_table[pos].load(std::memory_order_relaxed) == _empty &&
+                _table[pos].compare_exchange_strong(expected, key, std::memory_order_relaxed)) {
+                _used_slots.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            assert(expected != key);
+        }
+    }
+
+    //! True if the edge exists (claimed or not)
+    bool contains(const edge_t & e) const {
+        const key_t key = _key(e);
+        for (slot_t pos = _home(key); ; pos = (pos + 1) & _mask) {
+            const key_t cur = _table[pos].load(std::memory_order_acquire);
+            if (cur == _empty) return false;
+            if ((cur & ~_claim_bit) == key) return true;
+        }
+    }
+
+    /**
+     * Inserts the edge in claimed state unless it is present.
+     * On success, the slot is stored in @a slot and has to be passed to commit() or release().
+     */
+    Result claimInsert(const edge_t & e, slot_t & slot) {
+        const key_t key = _key(e);
+        for (slot_t pos = _home(key); ; ) {
+            key_t cur = _table[pos].load(std::memory_order_acquire);
+
+            if (cur == _empty) {
+                if (_table[pos].compare_exchange_strong(cur, key | _claim_bit, std::memory_order_acq_rel)) {
+                    _used_slots.fetch_add(1, std::memory_order_relaxed);
+                    slot = pos;
+                    return Result::Inserted;
+                }
+                // another thread won the race for this slot; cur holds its value
+            }
+
+            if (cur == key) return Result::Exists;
+            if (cur == (key | _claim_bit)) return Result::Claimed;
+            if (cur != _empty) pos = (pos + 1) & _mask;
+        }
+    }
+
+    //! Makes an edge inserted by claimInsert() visible to all threads
+    void commit(slot_t slot) {
+        const key_t cur = _table[slot].load(std::memory_order_relaxed);
+        assert(cur != _empty && cur != _tombstone && (cur & _claim_bit));
+        _table[slot].store(cur & ~_claim_bit, std::memory_order_release);
+    }
+
+    //! Withdraws an edge inserted by claimInsert()
+    void release(slot_t slot) {
+        assert(_table[slot].load() != _tombstone && (_table[slot].load() & _claim_bit));
+        _table[slot].store(_tombstone, std::memory_order_release);
+    }
+
+    /**
+     * Removes an existing, unclaimed edge.
+     * The caller has to guarantee that no other thread removes this edge concurrently.
+     */
+    void erase(const edge_t & e) {
+        const key_t key = _key(e);
+        const slot_t pos = _find(key);
+        assert(_table[pos].load() == key);
+        _table[pos].store(_tombstone, std::memory_order_release);
+    }
+
+    static uint_t memoryUsage(uint_t edges) {
+        uint_t capacity = 1;
+        while (capacity < 2 * edges + 2) capacity *= 2;
+        return capacity * sizeof(key_t);
+    }
+};
@@ -59,6 +59,11 @@ protected:
         return std::make_pair(t0, t1);
     }
 
+    //! Swap of directed edges (a, b) and (c, d) keeping in- and out-degrees: (a, d) and (c, b)
+    std::pair<edge_t, edge_t> _swap_directed_edges(const edge_t & e0, const edge_t & e1) const {
+        return std::make_pair(edge_t {e0.first, e1.second}, edge_t {e1.first, e0.second});
+    }
+
     stxxl::stats_data _stats;
 
     //! Start a statistics counter that will be reported using _report_stats
@@ -0,0 +1,380 @@
+#include <EdgeSwaps/EdgeSwapFactory.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <IMGraph.h>
+#include <EdgeSwaps/IMEdgeSwap.h>
+#include <EdgeSwaps/ParallelIMEdgeSwap.h>
+#include <EdgeSwaps/EdgeSwapInternalSwaps.h>
+#include <EdgeSwaps/EdgeSwapTFP.h>
+#include <EdgeSwaps/EdgeSwapParallelTFP.h>
+
+namespace {
+    //! Time per unit of work (see EdgeSwapCalibration) of a single thread, used without measurements
+    constexpr std::array<double, num_edge_swap_algorithms> default_ns_per_unit = {{
+        100.0,  // IM
+        150.0,  // ParallelIM
+        400.0,  // Semi
+        800.0,  // TFP
+        1000.0  // ParallelTFP
+    }};
+
+    //! Sorters of EdgeSwapParallelTFP allocate SORTER_MEM each, independent of the budget
+    constexpr uint_t parallel_tfp_min_memory = 4 * SORTER_MEM;
+
+    bool is_parallel(EdgeSwapAlgorithm algorithm) {
+        return algorithm == EdgeSwapAlgorithm::ParallelIM || algorithm == EdgeSwapAlgorithm::ParallelTFP;
+    }
+
+    bool is_internal(EdgeSwapAlgorithm algorithm) {
+        return algorithm == EdgeSwapAlgorithm::IM || algorithm == EdgeSwapAlgorithm::ParallelIM;
+    }
+
+    double work(EdgeSwapAlgorithm algorithm, uint_t num_edges, uint_t num_swaps, swapid_t run_length) {
+        return static_cast<double>(num_swaps)
+               + static_cast<double>(num_edges) * EdgeSwapCalibration::scans(algorithm, num_swaps, run_length);
+    }
+
+    //! Largest number of swaps per iteration of EdgeSwapInternalSwaps fitting into memory (or 0)
+    uint_t semi_max_run_length(uint_t memory) {
+        constexpr uint_t probe = IntScale::Mi;
+        const uint_t fixed = EdgeSwapInternalSwaps::memoryUsage(0);
+        const uint_t per_swap = (EdgeSwapInternalSwaps::memoryUsage(probe) - fixed + probe - 1) / probe;
+
+        if (memory <= fixed)
+            return 0;
+
+        return std::min<uint_t>((memory - fixed) / per_swap, EdgeSwapInternalSwaps::maxSwaps());
+    }
+
+    // Adapters; engines without a native callback are flushed every run_length swaps
+
+    class IMEngine : public EdgeSwapEngine {
+        IMEdgeSwap _algo;
+        const swapid_t _run_length;
+        ProcessSwapCallback _cb;
+        swapid_t _pushed;
+        uint_t _iteration;
+
+    public:
+        IMEngine(EdgeStream & edges, swapid_t run_length, ProcessSwapCallback cb)
+            : _algo(edges), _run_length(run_length), _cb(cb), _pushed(0), _iteration(0) {}
+
+        void push(const SwapDescriptor & swap) override {
+            _algo.push(swap);
+            if (_cb && ++_pushed == _run_length) {
+                _algo.flush();
+                _cb(_iteration++);
+                _pushed = 0;
+            }
+        }
+
+        void run() override {
+            _algo.run();
+            if (_cb && _pushed)
+                _cb(_iteration++);
+        }
+
+        EdgeSwapAlgorithm algorithm() const override {return EdgeSwapAlgorithm::IM;}
+    };
+
+    class ParallelIMEngine : public EdgeSwapEngine {
+        ParallelIMEdgeSwap _algo;
+
+    public:
+        ParallelIMEngine(EdgeStream & edges, int num_threads, swapid_t run_length, ProcessSwapCallback cb)
+            : _algo(edges, num_threads, run_length)
+        {
+            if (cb) {
+                _algo.setProcessSwapCallback([this, cb] (uint_t iteration) {
+                    _algo.flush();
+                    cb(iteration);
+                });
+            }
+        }
+
+        void push(const SwapDescriptor & swap) override {_algo.push(swap);}
+        void run() override {_algo.run();}
+        EdgeSwapAlgorithm algorithm() const override {return EdgeSwapAlgorithm::ParallelIM;}
+    };
+
+    class SemiEngine : public EdgeSwapEngine {
+        EdgeSwapInternalSwaps _algo;
+        const swapid_t _run_length;
+        ProcessSwapCallback _cb;
+        swapid_t _pushed;
+        uint_t _iteration;
+
+    public:
+        SemiEngine(EdgeStream & edges, swapid_t run_length, ProcessSwapCallback cb)
+            : _algo(edges, run_length), _run_length(run_length), _cb(cb), _pushed(0), _iteration(0) {}
+
+        void push(const SwapDescriptor & swap) override {
+            _algo.push(swap);
+            if (_cb && ++_pushed == _run_length) {
+                _algo.flush();
+                _cb(_iteration++);
+                _pushed = 0;
+            }
+        }
+
+        void run() override {
+            _algo.run();
+            if (_cb && _pushed)
+                _cb(_iteration++);
+        }
+
+        EdgeSwapAlgorithm algorithm() const override {return EdgeSwapAlgorithm::Semi;}
+    };
+
+    class TFPEngine : public EdgeSwapEngine {
+        EdgeSwapTFP::EdgeSwapTFP _algo;
+
+    public:
+        TFPEngine(EdgeStream & edges, swapid_t run_length, node_t num_nodes, uint_t memory, ProcessSwapCallback cb)
+            : _algo(edges, run_length, num_nodes, memory, cb ? cb : ProcessSwapCallback([](uint_t) {})) {}
+
+        void push(const SwapDescriptor & swap) override {_algo.push(swap);}
+        void run() override {_algo.run();}
+        EdgeSwapAlgorithm algorithm() const override {return EdgeSwapAlgorithm::TFP;}
+    };
+
+    class ParallelTFPEngine : public EdgeSwapEngine {
+        EdgeSwapParallelTFP::EdgeSwapParallelTFP _algo;
+        const swapid_t _run_length;
+        ProcessSwapCallback _cb;
+        swapid_t _pushed;
+        uint_t _iteration;
+
+        void _callback() {
+            // the second call only writes back the updated edges
+            _algo.process_swaps();
+            _algo.process_swaps();
+            _cb(_iteration++);
+            _pushed = 0;
+        }
+
+    public:
+        ParallelTFPEngine(EdgeStream & edges, swapid_t run_length, int num_threads, ProcessSwapCallback cb)
+            : _algo(edges, run_length, num_threads), _run_length(run_length), _cb(cb), _pushed(0), _iteration(0) {}
+
+        void push(const SwapDescriptor & swap) override {
+            _algo.push(swap);
+            if (_cb && ++_pushed == _run_length)
+                _callback();
+        }
+
+        void run() override {
+            if (_cb && _pushed)
+                _callback();
+            _algo.run();
+        }
+
+        EdgeSwapAlgorithm algorithm() const override {return EdgeSwapAlgorithm::ParallelTFP;}
+    };
+}
+
+bool EdgeSwapCalibration::load(const std::string & filename) {
+    std::ifstream in(filename);
+    if (!in)
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream fields(line);
+        std::string name;
+        Measurement m;
+        if (!(fields >> name >> m.num_threads >> m.num_edges >> m.num_swaps >> m.run_length >> m.seconds)) {
+            throw std::runtime_error("Error, malformed line in edge swap calibration file: " + line);
+        }
+
+        m.algorithm = EdgeSwapFactory::parse(name);
+        add(m);
+    }
+
+    return true;
+}
+
+bool EdgeSwapCalibration::append(const std::string & filename, const Measurement & m) {
+    std::ofstream out(filename, std::ios::app);
+    if (!out)
+        return false;
+
+    out << EdgeSwapFactory::name(m.algorithm) << " " << m.num_threads << " " << m.num_edges << " "
+        << m.num_swaps << " " << m.run_length << " " << m.seconds << "\n";
+
+    return static_cast<bool>(out);
+}
+
+uint_t EdgeSwapCalibration::scans(EdgeSwapAlgorithm algorithm, uint_t num_swaps, swapid_t run_length) {
+    if (is_internal(algorithm))
+        return 1;
+
+    // every run loads and writes back the edges
+    return (num_swaps + run_length - 1) / std::max<swapid_t>(run_length, 1) + 1;
+}
+
+double EdgeSwapCalibration::estimate(EdgeSwapAlgorithm algorithm, const EdgeSwapInstance & instance) const {
+    assert(algorithm != EdgeSwapAlgorithm::Auto);
+
+    double ns_per_unit = default_ns_per_unit[static_cast<unsigned int>(algorithm)];
+
+    const Measurement * closest = nullptr;
+    double closest_distance = std::numeric_limits<double>::infinity();
+    for (const auto & m : _measurements) {
+        if (m.algorithm != algorithm || !m.num_edges)
+            continue;
+
+        const double distance = std::abs(std::log(static_cast<double>(m.num_edges) / std::max<uint_t>(instance.num_edges, 1)));
+        if (distance < closest_distance) {
+            closest = &m;
+            closest_distance = distance;
+        }
+    }
+
+    if (closest) {
+        ns_per_unit = 1e9 * closest->seconds / work(algorithm, closest->num_edges, closest->num_swaps, closest->run_length);
+        if (is_parallel(algorithm))
+            ns_per_unit *= std::max(1, closest->num_threads);
+    }
+
+    double ns = ns_per_unit * work(algorithm, instance.num_edges, instance.num_swaps, instance.run_length);
+    if (is_parallel(algorithm))
+        ns /= std::max(1, instance.num_threads);
+
+    return 1e-9 * ns;
+}
+
+bool EdgeSwapFactory::feasible(EdgeSwapAlgorithm algorithm, const EdgeSwapInstance & instance) {
+    switch (algorithm) {
+        case EdgeSwapAlgorithm::IM:
+            // IMEdgeSwap keeps a copy of the edges next to the graph
+            return static_cast<int_t>(instance.num_edges) <= IMGraph::maxEdges()
+                   && IMGraph::memoryUsage(instance.num_nodes, instance.num_edges) + instance.num_edges * sizeof(edge_t) < instance.memory;
+
+        case EdgeSwapAlgorithm::ParallelIM:
+            return ParallelIMEdgeSwap::memoryUsage(instance.num_edges, instance.run_length) < instance.memory;
+
+        case EdgeSwapAlgorithm::Semi: {
+            const uint_t max_run_length = semi_max_run_length(instance.memory);
+            return max_run_length && (!instance.run_length || instance.run_length <= max_run_length);
+        }
+
+        case EdgeSwapAlgorithm::TFP:
+            return true;
+
+        case EdgeSwapAlgorithm::ParallelTFP:
+            return instance.memory >= parallel_tfp_min_memory;
+
+        default:
+            return false;
+    }
+}
+
+EdgeSwapInstance EdgeSwapFactory::withRunLength(EdgeSwapAlgorithm algorithm, const EdgeSwapInstance & instance) {
+    if (instance.run_length)
+        return instance;
+
+    EdgeSwapInstance result(instance);
+    const uint_t eighth = std::max<uint_t>(instance.num_edges / 8, 1);
+
+    switch (algorithm) {
+        case EdgeSwapAlgorithm::ParallelIM:
+            result.run_length = std::min<uint_t>(std::max<uint_t>(eighth, 1024), 1llu << 22);
+            break;
+
+        case EdgeSwapAlgorithm::Semi:
+            result.run_length = std::max<uint_t>(std::min<uint_t>(semi_max_run_length(instance.memory), instance.num_swaps), 1);
+            break;
+
+        default:
+            result.run_length = std::min<uint_t>(eighth, std::numeric_limits<swapid_t>::max());
+    }
+
+    return result;
+}
+
+EdgeSwapAlgorithm EdgeSwapFactory::select(const EdgeSwapInstance & instance) const {
+    EdgeSwapAlgorithm best = EdgeSwapAlgorithm::TFP;
+    double best_time = std::numeric_limits<double>::infinity();
+
+    for (unsigned int i = 0; i < num_edge_swap_algorithms; ++i) {
+        const auto algorithm = static_cast<EdgeSwapAlgorithm>(i);
+        if (is_parallel(algorithm) && instance.num_threads < 2)
+            continue;
+
+        const auto inst = withRunLength(algorithm, instance);
+        if (!feasible(algorithm, inst))
+            continue;
+
+        const double time = _calibration.estimate(algorithm, inst);
+        if (time < best_time) {
+            best = algorithm;
+            best_time = time;
+        }
+    }
+
+    return best;
+}
+
+std::unique_ptr<EdgeSwapEngine> EdgeSwapFactory::create(EdgeStream & edges, const EdgeSwapInstance & instance,
+                                                        ProcessSwapCallback cb, EdgeSwapAlgorithm algorithm) const {
+    if (algorithm == EdgeSwapAlgorithm::Auto)
+        algorithm = select(instance);
+
+    const auto inst = withRunLength(algorithm, instance);
+
+    switch (algorithm) {
+        case EdgeSwapAlgorithm::IM:
+            return std::unique_ptr<EdgeSwapEngine>(new IMEngine(edges, inst.run_length, cb));
+
+        case EdgeSwapAlgorithm::ParallelIM:
+            return std::unique_ptr<EdgeSwapEngine>(new ParallelIMEngine(edges, inst.num_threads, inst.run_length, cb));
+
+        case EdgeSwapAlgorithm::Semi:
+            return std::unique_ptr<EdgeSwapEngine>(new SemiEngine(edges, inst.run_length, cb));
+
+        case EdgeSwapAlgorithm::TFP:
+            return std::unique_ptr<EdgeSwapEngine>(new TFPEngine(edges, inst.run_length, inst.num_nodes, inst.memory, cb));
+
+        case EdgeSwapAlgorithm::ParallelTFP:
+            return std::unique_ptr<EdgeSwapEngine>(new ParallelTFPEngine(edges, inst.run_length, inst.num_threads, cb));
+
+        default:
+            throw std::invalid_argument("Error, unknown edge swap algorithm");
+    }
+}
+
+std::string EdgeSwapFactory::name(EdgeSwapAlgorithm algorithm) {
+    switch (algorithm) {
+        case EdgeSwapAlgorithm::IM:          return "IM";
+        case EdgeSwapAlgorithm::ParallelIM:  return "PIM";
+        case EdgeSwapAlgorithm::Semi:        return "SEMI";
+        case EdgeSwapAlgorithm::TFP:         return "TFP";
+        case EdgeSwapAlgorithm::ParallelTFP: return "PTFP";
+        default:                             return "AUTO";
+    }
+}
+
+EdgeSwapAlgorithm EdgeSwapFactory::parse(const std::string & name) {
+    std::string upper(name);
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+    for (unsigned int i = 0; i <= num_edge_swap_algorithms; ++i) {
+        const auto algorithm = static_cast<EdgeSwapAlgorithm>(i);
+        if (upper == EdgeSwapFactory::name(algorithm))
+            return algorithm;
+    }
+
+    throw std::invalid_argument("Invalid edge swap algorithm: " + name);
+}
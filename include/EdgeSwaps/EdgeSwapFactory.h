@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief Selection and construction of edge swap engines behind a common interface
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <defs.h>
+#include <Swaps.h>
+#include <EdgeStream.h>
+
+//! Edge swap implementations which process pushed swaps on an EdgeStream
+enum class EdgeSwapAlgorithm : unsigned char {
+    IM,          //!< IMEdgeSwap: adjacency structure in internal memory, sequential
+    ParallelIM,  //!< ParallelIMEdgeSwap: hashed edges in internal memory, multi-threaded
+    Semi,        //!< EdgeSwapInternalSwaps: swaps in internal memory, edges streamed
+    TFP,         //!< EdgeSwapTFP: time forward processing, sequential
+    ParallelTFP, //!< EdgeSwapParallelTFP: time forward processing, multi-threaded
+    Auto         //!< Let EdgeSwapFactory select one of the above
+};
+
+constexpr unsigned int num_edge_swap_algorithms = static_cast<unsigned int>(EdgeSwapAlgorithm::Auto);
+
+//! Properties of a randomisation task which influence the choice of the engine
+struct EdgeSwapInstance {
+    uint_t num_edges;
+    node_t num_nodes;
+    uint_t num_swaps;
+    uint_t memory;      //!< Internal memory available to the engine in bytes
+    int num_threads;
+    swapid_t run_length; //!< Swaps per graph scan or batch; 0 selects a default per engine
+
+    EdgeSwapInstance(uint_t num_edges, node_t num_nodes, uint_t num_swaps, uint_t memory,
+                     int num_threads, swapid_t run_length = 0)
+        : num_edges(num_edges), num_nodes(num_nodes), num_swaps(num_swaps), memory(memory)
+        , num_threads(num_threads), run_length(run_length)
+    {}
+};
+
+/**
+ * @brief Measured running times of the engines used to predict the running time of an instance.
+ *
+ * The cost of an engine is modelled as proportional to swaps + edges * scans, where
+ * scans is the number of graph scans (one for internal memory engines). Multi-threaded
+ * engines are assumed to scale linearly in the number of threads. A prediction is based
+ * on the measurement of the engine whose number of edges is closest (logarithmically);
+ * engines without measurement fall back to built-in constants.
+ *
+ * The file format is one measurement per line (lines starting with # are ignored):
+ * @code
+ * <algorithm> <threads> <edges> <swaps> <run length> <seconds>
+ * @endcode
+ */
+class EdgeSwapCalibration {
+public:
+    struct Measurement {
+        EdgeSwapAlgorithm algorithm;
+        int num_threads;
+        uint_t num_edges;
+        uint_t num_swaps;
+        swapid_t run_length;
+        double seconds;
+    };
+
+    EdgeSwapCalibration() = default;
+
+    //! Reads measurements from file; returns false if the file cannot be opened
+    bool load(const std::string & filename);
+
+    //! Appends a measurement to a calibration file; returns false if the file cannot be written
+    static bool append(const std::string & filename, const Measurement & measurement);
+
+    void add(const Measurement & measurement) {
+        _measurements.push_back(measurement);
+    }
+
+    //! Predicted running time in seconds of the engine on the instance; run_length has to be set
+    double estimate(EdgeSwapAlgorithm algorithm, const EdgeSwapInstance & instance) const;
+
+    //! Number of graph scans the engine performs on the instance; run_length has to be set
+    static uint_t scans(EdgeSwapAlgorithm algorithm, uint_t num_swaps, swapid_t run_length);
+
+private:
+    std::vector<Measurement> _measurements;
+};
+
+//! Common interface of the engines created by EdgeSwapFactory
+class EdgeSwapEngine {
+public:
+    using ProcessSwapCallback = std::function<void(uint_t)>;
+
+    virtual ~EdgeSwapEngine() = default;
+
+    //! Buffers or executes a single swap
+    virtual void push(const SwapDescriptor & swap) = 0;
+
+    //! Executes all pushed swaps and writes the edges back into the stream
+    virtual void run() = 0;
+
+    virtual EdgeSwapAlgorithm algorithm() const = 0;
+};
+
+/**
+ * @brief Chooses and constructs the presumably fastest edge swap engine for an instance.
+ *
+ * All engines operate in-place on a sorted EdgeStream. If a callback is given, it is called
+ * after every run_length swaps (and after the last swap) with the number of the run; the
+ * edge stream then reflects all swaps performed so far. Engines without native support
+ * are flushed for this, so callbacks may add graph scans.
+ */
+class EdgeSwapFactory {
+public:
+    using ProcessSwapCallback = EdgeSwapEngine::ProcessSwapCallback;
+
+    EdgeSwapFactory() = default;
+    explicit EdgeSwapFactory(const EdgeSwapCalibration & calibration) : _calibration(calibration) {}
+
+    //! Whether the engine runs on the instance within its memory budget
+    static bool feasible(EdgeSwapAlgorithm algorithm, const EdgeSwapInstance & instance);
+
+    //! Fills in the default run length of the engine if instance.run_length is 0
+    static EdgeSwapInstance withRunLength(EdgeSwapAlgorithm algorithm, const EdgeSwapInstance & instance);
+
+    //! Feasible engine with the smallest predicted running time
+    EdgeSwapAlgorithm select(const EdgeSwapInstance & instance) const;
+
+    //! Constructs an engine on the edges; EdgeSwapAlgorithm::Auto calls select()
+    std::unique_ptr<EdgeSwapEngine> create(EdgeStream & edges, const EdgeSwapInstance & instance,
+                                           ProcessSwapCallback cb = nullptr,
+                                           EdgeSwapAlgorithm algorithm = EdgeSwapAlgorithm::Auto) const;
+
+    static std::string name(EdgeSwapAlgorithm algorithm);
+
+    //! Case-insensitive inverse of name(); throws std::invalid_argument on unknown names
+    static EdgeSwapAlgorithm parse(const std::string & name);
+
+private:
+    EdgeSwapCalibration _calibration;
+};
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <unordered_set>
 #include <vector>
 
 #include <stx/btree_map>
@@ -11,6 +12,7 @@
 
 #include <Utils/AsyncStream.h>
 #include <Utils/AsyncPusher.h>
+#include <Utils/RandomBoolStream.h>
 
 #define ASYNC_STREAMS
 #define REPORT_SORTER_STATS(X) \
@@ -24,11 +26,20 @@
 //#define ASYNC_PUSHERS
 
 namespace EdgeSwapTFP {
+    template<class EdgeReader>
+    void EdgeSwapTFP::_compute_dependency_chain(EdgeReader & edge_reader, BoolStream & edge_remains_valid) {
+        if (_presorted_swaps) {
+            _compute_dependency_chain(edge_reader, *_presorted_swaps, edge_remains_valid);
+        } else {
+            _compute_dependency_chain(edge_reader, *_edge_swap_sorter, edge_remains_valid);
+        }
+    }
+
     /*
      * This method implements the steps "request nodes" and "load nodes".
      */
-    template<class EdgeReader>
-    void EdgeSwapTFP::_compute_dependency_chain(EdgeReader & edge_reader_in, BoolStream & edge_remains_valid) {
+    template<class EdgeReader, class SwapReader>
+    void EdgeSwapTFP::_compute_dependency_chain(EdgeReader & edge_reader_in, SwapReader & edge_swap_sorter_in, BoolStream & edge_remains_valid) {
         edge_remains_valid.clear();
 
         edgeid_t eid = 0; // points to the next edge that can be read
@@ -40,12 +51,12 @@ namespace EdgeSwapTFP {
 
         #ifdef ASYNC_STREAMS
             AsyncStream<EdgeReader> edge_reader(edge_reader_in, false, 1.0e6);
-            AsyncStream<EdgeSwapSorter> edge_swap_sorter(*_edge_swap_sorter, false, 1.0e6);
+            AsyncStream<SwapReader> edge_swap_sorter(edge_swap_sorter_in, false, 1.0e6);
             edge_reader.acquire();
             edge_swap_sorter.acquire();
         #else
             EdgeReader & edge_reader = edge_reader_in;
-            EdgeSwapSorter & edge_swap_sorter = *_edge_swap_sorter;
+            SwapReader & edge_swap_sorter = edge_swap_sorter_in;
         #endif
 
         #ifdef ASYNC_PUSHERS
@@ -56,6 +67,11 @@ namespace EdgeSwapTFP {
             auto & depchain_successor_sorter = _depchain_successor_sorter;
         #endif
 
+        // the filter has to reflect the graph as it is seen by _load_existence
+        const bool build_filter = _existence_filter.allocated();
+        if (build_filter)
+            _existence_filter.clear();
+
         bool first_swap_of_edge = true;
         // For every edge we send the incident vertices to all swaps, requesting it.
         // We get this info by scanning through the original edge list and the sorted
@@ -73,6 +89,8 @@ namespace EdgeSwapTFP {
                 edge_remains_valid.push(first_swap_of_edge);
                 first_swap_of_edge = true;
                 assert(!edge_reader.empty());
+                if (build_filter)
+                    _existence_filter.insert(*edge_reader);
             }
 
             const auto & edge = *edge_reader;
@@ -91,6 +109,12 @@ namespace EdgeSwapTFP {
                     swaps_per_edge = 1;
                 }
 
+            } else if (UNLIKELY((requesting_swap & 1) && prev_swap + 1 == requesting_swap)) {
+                // both edges of the swap coincide (only possible for presorted swaps);
+                // send an invalid edge and do not consider the swap in the dependency chain
+                depchain_edge_sorter.push({requesting_swap, edge_t::invalid()});
+                continue;
+
             } else {
                 depchain_edge_sorter.push({requesting_swap, edge});
                 depchain_successor_sorter.push(DependencyChainSuccessorMsg{prev_swap, requesting_swap});
@@ -110,6 +134,13 @@ namespace EdgeSwapTFP {
             depchain_successor_sorter.finish(false);
         #endif
 
+        // the remaining edges are not requested but still have to enter the filter
+        if (build_filter) {
+            for (; !edge_reader.empty(); ++edge_reader)
+                _existence_filter.insert(*edge_reader);
+
+            assert(_existence_filter.size() == _edges.size());
+        }
 
         // fill validation stream
         edge_remains_valid.push(false); // last edge processed
@@ -192,6 +223,8 @@ namespace EdgeSwapTFP {
 
         std::array<std::vector<edge_t>, 2> dd_new_edges;
 
+        uint64_t stat_filtered_reqs = 0;
+
         for (; !_swap_directions.empty(); ++_swap_directions, ++sid) {
             swapid_t successors[2] = {0,0};
 
@@ -280,7 +313,7 @@ namespace EdgeSwapTFP {
             for (auto &e1 : edges[0]) {
                 for (auto &e2 : edges[1]) {
                     edge_t new_edges[2];
-                    std::tie(new_edges[0], new_edges[1]) = _swap_edges(e1, e2, *_swap_directions);
+                    std::tie(new_edges[0], new_edges[1]) = _swap(e1, e2, *_swap_directions);
 
                     for (unsigned int i = 0; i < 2; i++) {
                         auto &new_edge = new_edges[i];
@@ -316,6 +349,11 @@ namespace EdgeSwapTFP {
                             _dependency_chain_pq.push(DependencyChainEdgeMsg{successors[i], send_edge});
                         }
 
+                        if (_existence_filtered(send_edge)) {
+                            stat_filtered_reqs++;
+                            continue;
+                        }
+
                         _existence_request_sorter.push(ExistenceRequestMsg{send_edge, sid, false});
                     }
                 }
@@ -330,6 +368,11 @@ namespace EdgeSwapTFP {
                         _dependency_chain_pq.push(DependencyChainEdgeMsg{successors[i], edge});
                     }
 
+                    if (_existence_filtered(edge)) {
+                        stat_filtered_reqs++;
+                        continue;
+                    }
+
                     _existence_request_sorter.push(ExistenceRequestMsg{edge, sid, true});
                 }
             }
@@ -343,6 +386,7 @@ namespace EdgeSwapTFP {
         std::cout << "Elements remaining in PQ: " << _dependency_chain_pq.size() << std::endl;
 
         if (compute_stats) {
+            std::cout << "Existence requests filtered: " << stat_filtered_reqs << std::endl;
             for (const auto &it : state_sizes) {
                 std::cout << it.first << " " << it.second << " #STATE-SIZE" <<
                 std::endl;
@@ -513,6 +557,11 @@ namespace EdgeSwapTFP {
             std::vector<edge_t> missing_infos;
         #endif
 
+        // Edges rejected by the existence filter did not exist at the begin of the run and
+        // received no existence information. They can only be created by swaps of this run,
+        // so we keep the currently existing ones explicitly.
+        std::unordered_set<BlockedBloomFilter::key_type> filtered_edges;
+
         swapid_t counter_performed = 0;
         swapid_t counter_not_performed = 0;
         swapid_t counter_loop = 0;
@@ -557,7 +606,7 @@ namespace EdgeSwapTFP {
                 edge_invalid = true;
             } else {
                 // compute swapped edges
-                std::tie(new_edges[0], new_edges[1]) = _swap_edges(edges[0], edges[1], *_swap_directions);
+                std::tie(new_edges[0], new_edges[1]) = _swap(edges[0], edges[1], *_swap_directions);
             }
 
             #ifndef NDEBUG
@@ -602,6 +651,11 @@ namespace EdgeSwapTFP {
             // check if there's an conflicting edge
             bool conflict_exists[2];
             for (unsigned int i = 0; (i < 2); i++) {
+                if (!edge_invalid && _existence_filtered(new_edges[i])) {
+                    conflict_exists[i] = filtered_edges.count(BlockedBloomFilter::edge_key(new_edges[i]));
+                    continue;
+                }
+
                 bool exists = std::binary_search(existence_infos.begin(), existence_infos.end(), new_edges[i]);
                 #ifndef NDEBUG
                     if (!exists && !edge_invalid) {
@@ -615,6 +669,17 @@ namespace EdgeSwapTFP {
             const bool loop = !edge_invalid && (new_edges[0].is_loop() || new_edges[1].is_loop());
             const bool perform_swap = !(conflict_exists[0] || conflict_exists[1] || loop || edge_invalid);
 
+            if (perform_swap && _existence_filter.allocated()) {
+                for (unsigned int i = 0; i < 2; i++) {
+                    if (_existence_filtered(edges[i]))
+                        filtered_edges.erase(BlockedBloomFilter::edge_key(edges[i]));
+                }
+                for (unsigned int i = 0; i < 2; i++) {
+                    if (_existence_filtered(new_edges[i]))
+                        filtered_edges.insert(BlockedBloomFilter::edge_key(new_edges[i]));
+                }
+            }
+
             if (compute_stats) {
                 counter_performed += perform_swap;
                 counter_not_performed += !perform_swap;
@@ -632,7 +697,8 @@ namespace EdgeSwapTFP {
                     res.edges[i] = new_edges[i];
                     res.conflictDetected[i] = conflict_exists[i];
                 }
-                res.normalize();
+                if (!_directed)
+                    res.normalize();
 
 #ifdef EDGE_SWAP_DEBUG_VECTOR
                 debug_vector_writer << res;
@@ -761,7 +827,7 @@ namespace EdgeSwapTFP {
 
         using UpdateStream = EdgeVectorUpdateStream<EdgeStream, BoolStream, decltype(_edge_update_sorter), true>;
 
-        if (!_edge_swap_sorter->size()) {
+        if (!_edge_swap_sorter->size() && !_presorted_swaps) {
             // there are no swaps - let's see whether there are pending updates
             if (_edge_update_sorter.size()) {
                 UpdateStream update_stream(_edges, _last_edge_update_mask, _edge_update_sorter);
@@ -863,6 +929,29 @@ namespace EdgeSwapTFP {
         }
     }
 
+    void EdgeSwapTFP::runPresorted(uint_t number_of_swaps, seed_t seed) {
+        assert(!_next_swap_id_pushing);
+        STDRandomEngine seed_gen(seed);
+
+        while (number_of_swaps) {
+            const swapid_t swaps_in_run = static_cast<swapid_t>(std::min<uint_t>(number_of_swaps, _run_length));
+            number_of_swaps -= swaps_in_run;
+
+            _swap_directions.clear();
+            RandomBoolStream directions(static_cast<seed_t>(seed_gen()));
+            for (swapid_t i = 0; i < swaps_in_run; ++i, ++directions)
+                _swap_directions.push(*directions);
+            _swap_directions.consume();
+
+            _presorted_swaps.reset(new PresortedSwaps(swaps_in_run, _edges.size(), static_cast<seed_t>(seed_gen())));
+            _process_swaps();
+            _presorted_swaps.reset();
+        }
+
+        // apply the updates of the last run
+        run();
+    }
+
     void EdgeSwapTFP::run() {
         _start_processing();
         _start_processing(false);
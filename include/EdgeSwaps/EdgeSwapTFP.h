@@ -16,6 +16,8 @@
 #include <stxxl/priority_queue>
 
 #include <EdgeStream.h>
+#include <Utils/BlockedBloomFilter.h>
+#include "PresortedSwapGenerator.h"
 
 namespace EdgeSwapTFP {
     struct EdgeSwapMsg {
@@ -170,6 +172,10 @@ namespace EdgeSwapTFP {
         std::unique_ptr<EdgeSwapSorter> _edge_swap_sorter_pushing;
         BoolStream _swap_directions_pushing;
 
+        // replaces _edge_swap_sorter during runPresorted()
+        using PresortedSwaps = PresortedSwapGenerator<EdgeSwapMsg>;
+        std::unique_ptr<PresortedSwaps> _presorted_swaps;
+
 // dependency chain
         // we need to use a desc-comparator since the pq puts the largest element on top
         using DependencyChainEdgeComparatorSorter = typename GenericComparatorStruct<DependencyChainEdgeMsg>::Ascending;
@@ -224,12 +230,30 @@ namespace EdgeSwapTFP {
         BoolStream _edge_update_mask;
         BoolStream _last_edge_update_mask;
 
+// optional filter of the edges existing at the begin of a run (see setExistenceFilter)
+        BlockedBloomFilter _existence_filter;
+
+        //! True if the edge provably did not exist at the begin of the run; then no existence request is issued
+        bool _existence_filtered(const edge_t & edge) const {
+            return _existence_filter.allocated() && !_existence_filter.contains(edge);
+        }
+
+// directed graphs (see DirectedEdgeSwapTFP)
+        bool _directed;
+
+        std::pair<edge_t, edge_t> _swap(const edge_t & e0, const edge_t & e1, bool direction) const {
+            return _directed ? _swap_directed_edges(e0, e1) : _swap_edges(e0, e1, direction);
+        }
+
 // algos
         void _gather_edges();
 
         template <class EdgeReader>
         void _compute_dependency_chain(EdgeReader&, BoolStream&);
 
+        template <class EdgeReader, class SwapReader>
+        void _compute_dependency_chain(EdgeReader&, SwapReader&, BoolStream&);
+
         void _simulate_swaps();
         void _load_existence();
         void _perform_swaps();
@@ -295,6 +319,8 @@ namespace EdgeSwapTFP {
                                       _mem_est.existence_info_pq_pool() / ExistenceInfoPQBlock::raw_size),
               _existence_info_pq(_existence_info_pq_pool),
 
+              _directed(false),
+
               _first_run(true),
 
               _process_swap_callback(cb),
@@ -323,8 +349,45 @@ namespace EdgeSwapTFP {
            }
         }
 
+        //! Enables a Bloom filter over the edges of the graph, which is rebuilt during each
+        //! graph scan. Requests for edges rejected by the filter are resolved in internal
+        //! memory and never enter the existence sorters. Requires bits_per_edge * |E| / 8
+        //! bytes in addition to im_memory; a value of 0 disables the filter.
+        //! Has to be called before the first swap is pushed.
+        void setExistenceFilter(double bits_per_edge) {
+            if (bits_per_edge > 0) {
+                _existence_filter.resize(_edges.size(), bits_per_edge);
+            } else {
+                _existence_filter.release();
+            }
+        }
+
+        //! Performs number_of_swaps uniformly random swaps in runs of run_length. Their requests
+        //! are generated in edge id order, hence the sorting step of push() is skipped. Swaps
+        //! whose edges coincide are declared invalid. Must not be mixed with push().
+        void runPresorted(uint_t number_of_swaps, seed_t seed);
+
         void run();
     };
+
+    /**
+     * @brief Edge swaps on directed graphs which preserve in- and out-degrees.
+     *
+     * The edges of the stream are directed, i.e. not normalized, and sorted by source and target;
+     * (u, v) and (v, u) are distinct edges. A swap of (a, b) and (c, d) yields (a, d) and (c, b),
+     * the direction of a SwapDescriptor is ignored. A swap is rejected if it creates a self-loop
+     * or an edge that exists already. Apart from that, the pipeline is the one of EdgeSwapTFP.
+     */
+    class DirectedEdgeSwapTFP : public EdgeSwapTFP {
+    public:
+        //! Same parameters as EdgeSwapTFP
+        template <typename... Args>
+        DirectedEdgeSwapTFP(edge_buffer_t &edges, Args&&... args)
+            : EdgeSwapTFP(edges, std::forward<Args>(args)...)
+        {
+            _directed = true;
+        }
+    };
 };
 
 template <>
@@ -334,3 +397,6 @@ struct EdgeSwapTrait<EdgeSwapTFP::EdgeSwapTFP> {
     static bool pushableSwapBuffers() {return false;}
     static bool edgeStream() {return true;}
 };
+
+template <>
+struct EdgeSwapTrait<EdgeSwapTFP::DirectedEdgeSwapTFP> : public EdgeSwapTrait<EdgeSwapTFP::EdgeSwapTFP> {};
@@ -8,37 +8,37 @@ EdgeVectorCache::EdgeVectorCache(EdgeVectorCache::vector_type &external_edges) :
 }
 
 void EdgeVectorCache::flushEdges() {
+    if (_ids.empty())
+        return;
+
     vector_type output_vector;
     output_vector.reserve(_external_edges.size());
     vector_type::bufwriter_type writer(output_vector);
     vector_type::bufreader_type reader(_external_edges);
 
-    std::vector<edge_t> new_edges;
-    new_edges.reserve(_internal_edges.size());
-    for (auto e : _internal_edges) {
-        if (e.second.first < e.second.second) {
-            new_edges.push_back(e.second);
-        } else {
-            new_edges.emplace_back(e.second.second, e.second.first);
-        }
+    // the cached edges are not needed by rank anymore, normalize and sort them in-place
+    const int_t num_new_edges = _edges.size();
+    #pragma omp parallel for schedule(static)
+    for (int_t i = 0; i < num_new_edges; ++i) {
+        _edges[i].normalize();
     }
 
-    std::sort(new_edges.begin(), new_edges.end());
+    SEQPAR::sort(_edges.begin(), _edges.end());
 
-    auto old_e = _internal_edges.begin();
-    auto new_e = new_edges.begin();
+    auto old_e = _ids.cbegin();
+    auto new_e = _edges.cbegin();
 
     int_t read_id = 0;
 
-    while (!reader.empty() || new_e != new_edges.end()) {
+    while (!reader.empty() || new_e != _edges.cend()) {
         // Skip elements that were already read
-        while (old_e != _internal_edges.end() && old_e->first == read_id) {
+        while (old_e != _ids.cend() && *old_e == read_id) {
             ++reader;
             ++read_id;
             ++old_e;
         }
 
-        if (new_e != new_edges.end() && (reader.empty() || *new_e < *reader)) {
+        if (new_e != _edges.cend() && (reader.empty() || *new_e < *reader)) {
             writer << *new_e;
             ++new_e;
         }  else if (!reader.empty()) { // due to the previous while loop both could be empty now
@@ -50,5 +50,6 @@ void EdgeVectorCache::flushEdges() {
 
     writer.finish();
     _external_edges.swap(output_vector);
-    _internal_edges.clear();
+    _ids.clear();
+    _edges.clear();
 }
@@ -6,56 +6,102 @@
 
 
 #include <stxxl/vector>
-#include <stx/btree_map>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
 #include "defs.h"
 
+/**
+ * @brief Internal copy of the edges of an external edge vector that are involved in a batch of swaps.
+ *
+ * The cached edge ids are kept as a sorted flat array, the edges as a second array
+ * of the same order. Hence an edge can be addressed either by its id (binary search)
+ * or directly by its rank among the cached ids, which is what internal swap
+ * algorithms use as internal edge id.
+ */
 class EdgeVectorCache {
 public:
     using vector_type = stxxl::VECTOR_GENERATOR<edge_t>::result;
     EdgeVectorCache(vector_type &external_edges);
 
+    //! Loads the edges of the given stream of ascending (possibly repeated) edge ids
     template <typename Iterator>
     inline void loadEdges(Iterator& edges);
 
+    //! Writes the cached edges back into the external vector, which is kept sorted, and clears the cache
     void flushEdges();
 
     template <typename Iterator>
     void loadAndFlushEdges(Iterator& edges);
 
+    //! Number of cached edges
+    uint_t size() const {
+        return _ids.size();
+    }
+
+    //! Rank of the (cached) edge id among all cached ids
+    uint_t rank(int_t id) const {
+        const auto it = std::lower_bound(_ids.cbegin(), _ids.cend(), id);
+        assert(it != _ids.cend() && *it == id);
+        return static_cast<uint_t>(it - _ids.cbegin());
+    }
+
+    //! Cached edge ids in ascending order
+    const std::vector<int_t> & ids() const {
+        return _ids;
+    }
+
+    edge_t& getEdgeByRank(uint_t rank) {
+        assert(rank < _edges.size());
+        return _edges[rank];
+    }
+
     edge_t& getEdge(int_t id) {
-        assert(_internal_edges.find(id) != _internal_edges.end());
-        return _internal_edges[id];
+        return _edges[rank(id)];
     }
 
-    void setEdge(int_t id, edge_t e) { _internal_edges[id] = e; };
+    //! Replaces the edge; id has to be loaded before
+    void setEdge(int_t id, edge_t e) { getEdge(id) = e; };
 private:
     vector_type &_external_edges;
-    stx::btree_map<int_t, edge_t> _internal_edges;
+    std::vector<int_t> _ids;
+    std::vector<edge_t> _edges;
 };
 
 template <typename Iterator>
 void EdgeVectorCache::loadEdges(Iterator& edges) {
-    // FIXME: which iterator type should be used? Is it already sorted?
-
-    if (!_internal_edges.empty()) {
+    if (!_ids.empty()) {
         throw std::runtime_error("Error, flush internal edges before loading new edges.");
     }
 
-    int_t id = 0;
+    for (; !edges.empty(); ++edges) {
+        assert(_ids.empty() || _ids.back() <= *edges);
+        if (_ids.empty() || _ids.back() != *edges)
+            _ids.push_back(*edges);
+    }
 
-    vector_type::bufreader_type reader(_external_edges);
-    while (!reader.empty()) {
-        if (edges.empty()) break;
+    if (_ids.empty())
+        return;
 
-        if (*edges == id) {
-            _internal_edges.insert(std::make_pair(id, *reader));
-            ++edges;
-        }
+    if (UNLIKELY(_ids.back() >= static_cast<int_t>(_external_edges.size()))) {
+        throw std::runtime_error("Error, requested edge id exceeds the edge vector.");
+    }
 
-        ++reader;
-        ++id;
+    // the ids are sorted, hence a single scan up to the last requested edge suffices
+    _edges.resize(_ids.size());
+
+    int_t id = 0;
+    auto next = _ids.cbegin();
+    auto out = _edges.begin();
+    for (vector_type::bufreader_type reader(_external_edges); next != _ids.cend(); ++reader, ++id) {
+        if (*next == id) {
+            *out++ = *reader;
+            ++next;
+        }
     }
 }
+
 template <typename Iterator>
 void EdgeVectorCache::loadAndFlushEdges(Iterator &edges) {
     flushEdges(); // FIXME do this in one EM scan
@@ -0,0 +1,248 @@
+#include <EdgeSwaps/ParallelIMEdgeSwap.h>
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+#include <omp.h>
+
+namespace {
+    //! Levels with fewer swaps per thread are executed sequentially
+    constexpr uint_t min_swaps_per_thread = 256;
+
+    uint_t default_batch_size(uint_t num_edges) {
+        return std::min<uint_t>(std::max<uint_t>(num_edges / 8, 1024), 1llu << 22);
+    }
+}
+
+ParallelIMEdgeSwap::ParallelIMEdgeSwap(EdgeStream & edges, int num_threads, uint_t batch_size, ProcessSwapCallback cb)
+    : _edge_stream(edges)
+    , _num_threads(std::max(1, num_threads))
+    , _batch_size(batch_size ? batch_size : default_batch_size(edges.size()))
+    , _edge_set(edges.size() + _insertions_per_batch())
+    , _deferred(static_cast<size_t>(_num_threads))
+    , _process_swap_callback(cb)
+    , _iteration(0)
+#ifdef EDGE_SWAP_DEBUG_VECTOR
+    , _debug_vector_writer(_result)
+#endif
+{
+    _edges.reserve(edges.size());
+    for (; !edges.empty(); ++edges) {
+        assert(!edges->is_loop());
+        assert(_edges.empty() || _edges.back() < *edges);
+        _edges.push_back(*edges);
+    }
+    edges.rewind();
+
+    _edge_level.assign(_edges.size(), 0);
+    _swap_buffer.reserve(_batch_size);
+
+    _rebuild_edge_set();
+}
+
+ParallelIMEdgeSwap::ParallelIMEdgeSwap(EdgeStream & edges, const swap_vector &)
+    : ParallelIMEdgeSwap(edges, omp_get_max_threads())
+{}
+
+ParallelIMEdgeSwap::Attempt ParallelIMEdgeSwap::_try_swap(const swap_descriptor & swap, SwapResult & result) {
+    const edgeid_t eid0 = swap.edges()[0];
+    const edgeid_t eid1 = swap.edges()[1];
+    const edge_t e0 = _edges[eid0];
+    const edge_t e1 = _edges[eid1];
+
+    edge_t t[2];
+    std::tie(t[0], t[1]) = _swap_edges(e0, e1, swap.direction());
+
+    result.edges[0] = t[0];
+    result.edges[1] = t[1];
+    result.conflictDetected[0] = false;
+    result.conflictDetected[1] = false;
+    result.loop = t[0].is_loop() || t[1].is_loop();
+
+    if (result.loop) {
+        result.performed = false;
+        result.normalize();
+        return Attempt::Done;
+    }
+
+    // claim target edges; this fails if another swap concurrently inserts or removes them
+    ConcurrentEdgeSet::Result claims[2];
+    ConcurrentEdgeSet::slot_t slots[2];
+    for (unsigned char pos = 0; pos < 2; ++pos) {
+        claims[pos] = _edge_set.claimInsert(t[pos], slots[pos]);
+
+        if (UNLIKELY(claims[pos] == ConcurrentEdgeSet::Result::Claimed)) {
+            if (pos && claims[0] == ConcurrentEdgeSet::Result::Inserted)
+                _edge_set.release(slots[0]);
+            return Attempt::Retry;
+        }
+
+        result.conflictDetected[pos] = (claims[pos] == ConcurrentEdgeSet::Result::Exists);
+    }
+
+    result.performed = !(result.conflictDetected[0] || result.conflictDetected[1]);
+
+    if (result.performed) {
+        // remove sources before the targets become visible; an observer of the intermediate
+        // state either sees a claim and retries, or is serialized after this swap
+        _edge_set.erase(e0);
+        _edge_set.erase(e1);
+        _edge_set.commit(slots[0]);
+        _edge_set.commit(slots[1]);
+
+        _edges[eid0] = t[0];
+        _edges[eid1] = t[1];
+    } else {
+        for (unsigned char pos = 0; pos < 2; ++pos) {
+            if (claims[pos] == ConcurrentEdgeSet::Result::Inserted)
+                _edge_set.release(slots[pos]);
+        }
+    }
+
+    result.normalize();
+    return Attempt::Done;
+}
+
+void ParallelIMEdgeSwap::_rebuild_edge_set() {
+    _edge_set.clear();
+
+    const int_t num_edges = _edges.size();
+    #pragma omp parallel for num_threads(_num_threads) schedule(static)
+    for (int_t eid = 0; eid < num_edges; ++eid)
+        _edge_set.insert(_edges[eid]);
+}
+
+void ParallelIMEdgeSwap::_process_batch() {
+    if (_swap_buffer.empty())
+        return;
+
+    const uint32_t num_swaps = static_cast<uint32_t>(_swap_buffer.size());
+
+    if (_edge_set.needsRebuild(_insertions_per_batch()))
+        _rebuild_edge_set();
+
+    _results.resize(num_swaps);
+
+    if (_num_threads == 1) {
+        for (uint32_t i = 0; i < num_swaps; ++i) {
+            const auto attempt = _try_swap(_swap_buffer[i], _results[i]);
+            assert(attempt == Attempt::Done);
+            stxxl::STXXL_UNUSED(attempt);
+        }
+    } else {
+        _process_levels();
+    }
+
+#ifdef EDGE_SWAP_DEBUG_VECTOR
+    for (const auto & result : _results)
+        _debug_vector_writer << result;
+#endif
+
+    _swap_buffer.clear();
+
+    if (_process_swap_callback)
+        _process_swap_callback(_iteration);
+    _iteration++;
+}
+
+void ParallelIMEdgeSwap::_process_levels() {
+    const uint32_t num_swaps = static_cast<uint32_t>(_swap_buffer.size());
+
+    // assign each swap the first level after all previous swaps of its edges
+    uint32_t num_levels = 0;
+    _swap_level.resize(num_swaps);
+    for (uint32_t i = 0; i < num_swaps; ++i) {
+        const edgeid_t eid0 = _swap_buffer[i].edges()[0];
+        const edgeid_t eid1 = _swap_buffer[i].edges()[1];
+        const uint32_t level = std::max(_edge_level[eid0], _edge_level[eid1]);
+
+        _swap_level[i] = level;
+        _edge_level[eid0] = level + 1;
+        _edge_level[eid1] = level + 1;
+        num_levels = std::max(num_levels, level + 1);
+    }
+
+    // counting sort by level, keeping the order within a level
+    _level_begin.assign(num_levels + 1, 0);
+    for (uint32_t i = 0; i < num_swaps; ++i)
+        _level_begin[_swap_level[i] + 1]++;
+    for (uint32_t l = 0; l < num_levels; ++l)
+        _level_begin[l + 1] += _level_begin[l];
+
+    _swaps_by_level.resize(num_swaps);
+    {
+        std::vector<uint32_t> next(_level_begin.cbegin(), _level_begin.cend() - 1);
+        for (uint32_t i = 0; i < num_swaps; ++i)
+            _swaps_by_level[next[_swap_level[i]]++] = i;
+    }
+
+    for (const auto & swap : _swap_buffer) {
+        _edge_level[swap.edges()[0]] = 0;
+        _edge_level[swap.edges()[1]] = 0;
+    }
+
+    // execute levels
+    for (uint32_t l = 0; l < num_levels; ++l) {
+        const int_t begin = _level_begin[l];
+        const int_t end = _level_begin[l + 1];
+
+        if (static_cast<uint_t>(end - begin) < min_swaps_per_thread * _num_threads) {
+            for (int_t k = begin; k < end; ++k) {
+                const uint32_t i = _swaps_by_level[k];
+                const auto attempt = _try_swap(_swap_buffer[i], _results[i]);
+                assert(attempt == Attempt::Done);
+                stxxl::STXXL_UNUSED(attempt);
+            }
+            continue;
+        }
+
+        #pragma omp parallel for num_threads(_num_threads) schedule(dynamic, min_swaps_per_thread)
+        for (int_t k = begin; k < end; ++k) {
+            const uint32_t i = _swaps_by_level[k];
+            if (UNLIKELY(_try_swap(_swap_buffer[i], _results[i]) == Attempt::Retry))
+                _deferred[omp_get_thread_num()].push_back(i);
+        }
+
+        // swaps of a level are edge-disjoint, hence deferred ones can be retried in any order;
+        // sequentially no claims of other swaps exist
+        for (auto & deferred : _deferred) {
+            for (const uint32_t i : deferred) {
+                const auto attempt = _try_swap(_swap_buffer[i], _results[i]);
+                assert(attempt == Attempt::Done);
+                stxxl::STXXL_UNUSED(attempt);
+            }
+            deferred.clear();
+        }
+    }
+}
+
+void ParallelIMEdgeSwap::flush() {
+    _process_batch();
+
+    std::vector<edge_t> sorted_edges(_edges);
+    SEQPAR::sort(sorted_edges.begin(), sorted_edges.end());
+
+    _edge_stream.clear();
+    for (const auto & edge : sorted_edges)
+        _edge_stream.push(edge);
+    _edge_stream.consume();
+}
+
+void ParallelIMEdgeSwap::run() {
+    flush();
+
+#ifdef EDGE_SWAP_DEBUG_VECTOR
+    _debug_vector_writer.finish();
+#endif
+}
+
+uint_t ParallelIMEdgeSwap::memoryUsage(uint_t num_edges, uint_t batch_size) {
+    if (!batch_size)
+        batch_size = default_batch_size(num_edges);
+
+    return num_edges * (2 * sizeof(edge_t) + sizeof(uint32_t)) // edges, sorted copy in flush(), levels
+           + ConcurrentEdgeSet::memoryUsage(num_edges + 3 * batch_size)
+           + batch_size * (sizeof(swap_descriptor) + 3 * sizeof(uint32_t) + sizeof(SwapResult))
+           + sizeof(ParallelIMEdgeSwap);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @brief Multi-threaded internal memory edge swaps based on a concurrent edge hash set
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <defs.h>
+#include <EdgeStream.h>
+#include <EdgeSwaps/EdgeSwapBase.h>
+#include <EdgeSwaps/ConcurrentEdgeSet.h>
+
+/**
+ * @brief Internal memory edge swaps executed by several threads.
+ *
+ * Edges are kept in an edge-id-indexed vector, their existence in a ConcurrentEdgeSet.
+ * Pushed swaps are buffered and processed in batches. Within a batch, swaps sharing an
+ * edge id are assigned to consecutive levels (so the order of swaps per edge is the
+ * order in which they were pushed), and all swaps of a level are executed concurrently.
+ * A swap claims its target edges in the edge set before it removes its source edges;
+ * if another swap holds one of these claims, it is retried sequentially at the end of the level. Thus each swap is
+ * executed atomically and is rejected iff a target edge exists at that time, as for IMEdgeSwap.
+ * With a single thread, the swaps are executed in the order they were pushed, so the
+ * results equal those of IMEdgeSwap.
+ *
+ * The debug vector (if enabled) contains the SwapResult of the i-th pushed swap at position i.
+ */
+class ParallelIMEdgeSwap : public EdgeSwapBase {
+public:
+    using ProcessSwapCallback = std::function<void(uint_t)>;
+
+protected:
+    EdgeStream & _edge_stream;
+    const int _num_threads;
+    const uint_t _batch_size;
+
+    std::vector<edge_t> _edges;
+    ConcurrentEdgeSet _edge_set;
+
+    std::vector<swap_descriptor> _swap_buffer;
+
+    // per batch data; level of the next swap accessing an edge, swaps ordered by level
+    std::vector<uint32_t> _edge_level;
+    std::vector<uint32_t> _swap_level;
+    std::vector<uint32_t> _level_begin;
+    std::vector<uint32_t> _swaps_by_level;
+    std::vector<SwapResult> _results;
+    std::vector<std::vector<uint32_t>> _deferred;
+
+    ProcessSwapCallback _process_swap_callback;
+    uint_t _iteration;
+
+#ifdef EDGE_SWAP_DEBUG_VECTOR
+    typename debug_vector::bufwriter_type _debug_vector_writer;
+#endif
+
+    //! Outcome of a single attempt to execute a swap
+    enum class Attempt {Done, Retry};
+
+    Attempt _try_swap(const swap_descriptor & swap, SwapResult & result);
+
+    //! Upper bound on the slots a batch occupies in the edge set: a swap inserts
+    //! at most two edges and a retried one withdraws at most one before
+    uint_t _insertions_per_batch() const {
+        return 3 * _batch_size;
+    }
+
+    void _rebuild_edge_set();
+    void _process_batch();
+    void _process_levels();
+
+public:
+    ParallelIMEdgeSwap() = delete;
+    ParallelIMEdgeSwap(const ParallelIMEdgeSwap &) = delete;
+
+    /**
+     * Loads the edges into internal memory; the stream is rewritten (sorted) by flush().
+     *
+     * @param edges       Sorted stream of normalized edges without multi-edges
+     * @param num_threads Number of threads used to execute swaps
+     * @param batch_size  Number of buffered swaps; 0 selects a size based on the number of edges
+     * @param cb          Called after each batch with the number of the batch
+     */
+    ParallelIMEdgeSwap(EdgeStream & edges, int num_threads, uint_t batch_size = 0,
+                       ProcessSwapCallback cb = nullptr);
+
+    //! @param swaps IGNORED, use push() instead
+    ParallelIMEdgeSwap(EdgeStream & edges, const swap_vector &);
+
+    //! Replaces the callback invoked after each batch; it may call flush()
+    void setProcessSwapCallback(ProcessSwapCallback cb) {
+        _process_swap_callback = cb;
+    }
+
+    //! Buffers a single swap, which is executed when the buffer is full or flush() is called
+    void push(const swap_descriptor & swap) {
+        _swap_buffer.push_back(swap);
+        if (UNLIKELY(_swap_buffer.size() >= _batch_size))
+            _process_batch();
+    }
+
+    //! Executes all buffered swaps and writes the sorted edges into the stream. Further swaps can still be pushed afterwards.
+    void flush();
+
+    //! Flushes; finishes writing the debug vector when enabled.
+    void run();
+
+    //! Estimated internal memory usage in bytes
+    static uint_t memoryUsage(uint_t num_edges, uint_t batch_size = 0);
+};
+
+template <>
+struct EdgeSwapTrait<ParallelIMEdgeSwap> {
+    static bool swapVector() {return false;}
+    static bool pushableSwaps() {return true;}
+    static bool pushableSwapBuffers() {return false;}
+    static bool edgeStream() {return true;}
+};
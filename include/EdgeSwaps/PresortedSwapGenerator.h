@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Generator of random swap requests sorted by edge id
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <defs.h>
+#include <Swaps.h>
+
+/**
+ * @brief Emits the requests (edge id, swap id) of uniformly random swaps in
+ * lexicographic order, i.e. as an edge swap sorter would after sorting.
+ *
+ * Each of the 2*number_of_swaps swap ids (i.e. 2*swap+i for the i-th edge of a swap)
+ * requests an edge chosen independently and uniformly at random. The edge ids are
+ * produced bucket-wise: the number of requests falling into a bucket of consecutive
+ * edge ids is binomially distributed, and only the requests of the current bucket
+ * are materialised and sorted in internal memory. The swap ids are assigned by a
+ * random permutation, which requires sizeof(swapid_t) bytes per request.
+ *
+ * In contrast to SwapGenerator, both edges of a swap may coincide. Such a swap can
+ * never be performed and has to be treated as invalid by the consumer.
+ *
+ * @tparam Msg  Constructible from (edgeid_t, swapid_t) and lexicographically ordered
+ */
+template <typename Msg>
+class PresortedSwapGenerator {
+public:
+    using value_type = Msg;
+
+protected:
+    constexpr static uint_t _requests_per_bucket = 1 << 12;
+
+    const edgeid_t _number_of_edges;
+    STDRandomEngine _rand_gen;
+
+    std::vector<swapid_t> _swap_ids;
+    typename std::vector<swapid_t>::const_iterator _next_swap_id;
+
+    edgeid_t _bucket_width;
+    edgeid_t _bucket_begin;
+    uint_t _requests_left;
+
+    std::vector<value_type> _bucket;
+    typename std::vector<value_type>::const_iterator _current;
+
+    void _fill_bucket() {
+        _bucket.clear();
+
+        while (_bucket.empty() && _requests_left) {
+            const edgeid_t bucket_end = std::min(_bucket_begin + _bucket_width, _number_of_edges);
+
+            // number of remaining requests that fall into [_bucket_begin, bucket_end)
+            std::binomial_distribution<uint_t> count_distr(_requests_left,
+                static_cast<double>(bucket_end - _bucket_begin) / (_number_of_edges - _bucket_begin));
+            const uint_t count = (bucket_end == _number_of_edges) ? _requests_left : count_distr(_rand_gen);
+
+            std::uniform_int_distribution<edgeid_t> edge_distr(_bucket_begin, bucket_end - 1);
+            for (uint_t i = 0; i < count; ++i, ++_next_swap_id)
+                _bucket.emplace_back(edge_distr(_rand_gen), *_next_swap_id);
+
+            std::sort(_bucket.begin(), _bucket.end());
+
+            _requests_left -= count;
+            _bucket_begin = bucket_end;
+        }
+
+        _current = _bucket.cbegin();
+    }
+
+public:
+    PresortedSwapGenerator(swapid_t number_of_swaps, edgeid_t edges_in_graph, seed_t seed)
+        : _number_of_edges(edges_in_graph)
+        , _rand_gen(seed)
+        , _swap_ids(2 * static_cast<uint_t>(number_of_swaps))
+        , _bucket_begin(0)
+        , _requests_left(_swap_ids.size())
+    {
+        assert(_number_of_edges > 1);
+
+        std::iota(_swap_ids.begin(), _swap_ids.end(), swapid_t(0));
+        std::shuffle(_swap_ids.begin(), _swap_ids.end(), _rand_gen);
+        _next_swap_id = _swap_ids.cbegin();
+
+        const uint_t number_of_buckets = std::max<uint_t>(1, _requests_left / _requests_per_bucket);
+        _bucket_width = std::max<edgeid_t>(1, (_number_of_edges + number_of_buckets - 1) / number_of_buckets);
+        _bucket.reserve(2 * _requests_per_bucket);
+
+        _fill_bucket();
+    }
+
+    PresortedSwapGenerator(const PresortedSwapGenerator &) = delete;
+
+//! @name STXXL Streaming Interface
+//! @{
+    bool empty() const {
+        return _current == _bucket.cend();
+    }
+
+    const value_type & operator*() const {
+        assert(!empty());
+        return *_current;
+    }
+
+    const value_type * operator->() const {
+        assert(!empty());
+        return &*_current;
+    }
+
+    PresortedSwapGenerator& operator++() {
+        assert(!empty());
+        if (UNLIKELY(++_current == _bucket.cend()))
+            _fill_bucket();
+        return *this;
+    }
+//! @}
+
+    //! Total number of requests, i.e. twice the number of swaps
+    uint_t size() const {
+        return _swap_ids.size();
+    }
+};
@@ -39,6 +39,11 @@ namespace EdgeSwapTFP {
             auto & depchain_successor_sorter = _depchain_successor_sorter;
         #endif
 
+        // the filter has to reflect the graph as it is seen by _load_existence
+        const bool build_filter = _existence_filter.allocated();
+        if (build_filter)
+            _existence_filter.clear();
+
         // For every edge we send the incident vertices to the first swap,
         // i.e. the request with the lowest swap-id. We get this info by scanning
         // through the original edge list and the sorted request list in parallel
@@ -50,6 +55,9 @@ namespace EdgeSwapTFP {
             const edge_t & edge = *edge_reader;
             assert(!edge.is_loop());
 
+            if (build_filter)
+                _existence_filter.insert(edge);
+
             auto match_request = [&]() {
                 // indicate that a non-existing loaded edge is invalid
                 while (!loaded_edge_swap_sorter.empty() && loaded_edge_swap_sorter->edge < edge) {
@@ -198,6 +206,11 @@ namespace EdgeSwapTFP {
 
         }
 
+        if (nullptr != _process_swap_callback) {
+            _process_swap_callback(_iteration);
+        }
+        _iteration++;
+
 #ifndef NDEBUG
         // test that input is lexicographically ordered and loop free
         {
@@ -37,14 +37,18 @@ namespace EdgeSwapTFP {
         //! Swaps are performed during constructor.
         //! @param edges  Edge vector changed in-place
         //! @param swaps  Read-only swap vector
-        SemiLoadedEdgeSwapTFP(edge_buffer_t &edges, const swapid_t& run_length, const node_t& num_nodes, const size_t& im_memory) :
-            EdgeSwapTFP(edges, run_length, num_nodes, im_memory),
+        SemiLoadedEdgeSwapTFP(edge_buffer_t &edges, const swapid_t& run_length, const node_t& num_nodes, const size_t& im_memory,
+                              ProcessSwapCallback cb = [](uint_t) {}) :
+            EdgeSwapTFP(edges, run_length, num_nodes, im_memory, cb),
             _loaded_edge_swap_sorter(new LoadedEdgeSwapSorter(LoadedEdgeSwapComparator(), _sorter_mem))
         {}
 
         // inherit the normal push method
         using EdgeSwapTFP::push;
 
+        // requests of loaded edges cannot be presorted
+        void runPresorted(uint_t, seed_t) = delete;
+
         void push(const SemiLoadedSwapDescriptor &swap) {
            _loaded_edge_swap_sorter->push(LoadedEdgeSwapMsg(swap.edge(), _next_swap_id_pushing++));
            _edge_swap_sorter_pushing->push(EdgeSwapMsg(swap.eid(), _next_swap_id_pushing++));
@@ -63,4 +67,15 @@ namespace EdgeSwapTFP {
         };
     };
 
+    //! SemiLoadedEdgeSwapTFP on directed edges, see DirectedEdgeSwapTFP
+    class DirectedSemiLoadedEdgeSwapTFP : public SemiLoadedEdgeSwapTFP {
+    public:
+        template <typename... Args>
+        DirectedSemiLoadedEdgeSwapTFP(edge_buffer_t &edges, Args&&... args)
+            : SemiLoadedEdgeSwapTFP(edges, std::forward<Args>(args)...)
+        {
+            _directed = true;
+        }
+    };
+
 };
@@ -0,0 +1,137 @@
+#include "SwapConvergenceMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+SwapConvergenceMonitor::SwapConvergenceMonitor(node_t num_nodes, const Config & config)
+    : _config(config)
+    , _num_nodes(num_nodes)
+    , _calls(0)
+    , _initialized(false)
+    , _converged(false)
+    , _edges_changed(0.0)
+    , _degree_moment_2(0.0)
+    , _degree_moment_3(0.0)
+{
+    assert(_config.interval > 0);
+    assert(_config.assortativity_window > 0);
+}
+
+void SwapConvergenceMonitor::_initialize(EdgeStream & edges) {
+    const bool track_touch = (_config.min_edges_changed > 0.0);
+    const bool track_assortativity = (_config.assortativity_tolerance > 0.0);
+
+    if (track_touch)
+        _initial_edges.resize(edges.size(), _config.edge_filter_bits);
+
+    if (track_assortativity)
+        _degrees.assign(_num_nodes, 0);
+
+    for (; !edges.empty(); ++edges) {
+        const edge_t & edge = *edges;
+
+        if (track_touch)
+            _initial_edges.insert(edge);
+
+        if (track_assortativity) {
+            assert(edge.first < _num_nodes && edge.second < _num_nodes);
+            _degrees[edge.first]++;
+            _degrees[edge.second]++;
+        }
+    }
+    edges.rewind();
+
+    // swaps keep the degree sequence, so all moments but the mixed one are constant
+    if (track_assortativity && edges.size()) {
+        double sum2 = 0.0;
+        double sum3 = 0.0;
+        for (const degree_t & d : _degrees) {
+            sum2 += 1.0 * d * d;
+            sum3 += 1.0 * d * d * d;
+        }
+
+        const double m = 2.0 * edges.size();
+        _degree_moment_2 = (sum2 / m) * (sum2 / m);
+        _degree_moment_3 = sum3 / m;
+    }
+
+    _initialized = true;
+}
+
+bool SwapConvergenceMonitor::observe(EdgeStream & edges) {
+    if (converged())
+        return true;
+
+    if (!_config.enabled())
+        return false;
+
+    if (!_initialized) {
+        _initialize(edges);
+        return false;
+    }
+
+    if (++_calls % _config.interval)
+        return false;
+
+    const bool track_touch = (_config.min_edges_changed > 0.0);
+    const bool track_assortativity = (_config.assortativity_tolerance > 0.0);
+
+    uint_t edges_kept = 0;
+    double mixed_moment = 0.0;
+
+    for (; !edges.empty(); ++edges) {
+        const edge_t & edge = *edges;
+
+        if (track_touch)
+            edges_kept += _initial_edges.contains(edge);
+
+        if (track_assortativity)
+            mixed_moment += 1.0 * _degrees[edge.first] * _degrees[edge.second];
+    }
+    edges.rewind();
+
+    const uint_t num_edges = edges.size();
+    bool converged = true;
+
+    if (track_touch) {
+        _edges_changed = num_edges ? 1.0 - static_cast<double>(edges_kept) / num_edges : 1.0;
+        converged = converged && (_edges_changed >= _config.min_edges_changed);
+    }
+
+    if (track_assortativity) {
+        const double denom = _degree_moment_3 - _degree_moment_2;
+        const double r = (num_edges && denom > 0.0) ? (mixed_moment / num_edges - _degree_moment_2) / denom : 0.0;
+
+        _assortativity.push_back(r);
+        if (_assortativity.size() > _config.assortativity_window)
+            _assortativity.erase(_assortativity.begin());
+
+        const auto minmax = std::minmax_element(_assortativity.cbegin(), _assortativity.cend());
+        converged = converged
+                    && (_assortativity.size() == _config.assortativity_window)
+                    && (*minmax.second - *minmax.first <= _config.assortativity_tolerance);
+    }
+
+    std::cout << "[SwapConvergenceMonitor] Observation " << _calls
+              << " edges changed: " << _edges_changed
+              << " assortativity: " << assortativity()
+              << (converged ? " converged" : "")
+              << std::endl;
+
+    if (converged) {
+        _converged.store(true, std::memory_order_relaxed);
+        _initial_edges.release();
+        std::vector<degree_t>().swap(_degrees);
+    }
+
+    return converged;
+}
+
+double SwapConvergenceMonitor::assortativity() const {
+    if (_assortativity.empty())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return _assortativity.back();
+}
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Online convergence detection for edge swap randomisation
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <defs.h>
+#include <EdgeStream.h>
+#include <Utils/BlockedBloomFilter.h>
+
+/**
+ * @brief Tracks cheap statistics of a graph while it is being randomised and
+ * decides whether further swaps are worthwhile.
+ *
+ * The monitor is intended to be called between two runs of an external edge swap
+ * algorithm, e.g. from EdgeSwapTFP's process-swap callback, and scans the edge list
+ * once per observation. Two statistics are supported:
+ *  - Edge touch: The fraction of edges of the initial graph that are no longer present.
+ *    The initial edge set is kept in a Bloom filter; false positives only make the
+ *    estimate conservative.
+ *  - Degree assortativity: Since swaps maintain the degree sequence, the degrees are
+ *    computed in the first observation and only the mixed moment is updated later on.
+ *    The criterion is met, if the estimates of the last window observations differ by
+ *    at most assortativity_tolerance.
+ *
+ * The graph is considered converged as soon as all enabled criteria are met. The
+ * pushing thread is expected to poll converged() and stop generating swaps; this
+ * flag may be set by another thread.
+ */
+class SwapConvergenceMonitor {
+public:
+    struct Config {
+        //! Required fraction of initial edges that have been replaced; 0 disables the criterion
+        double min_edges_changed;
+        //! Bits per edge of the Bloom filter storing the initial edges
+        double edge_filter_bits;
+
+        //! Maximal spread of the assortativity estimate within the window; 0 disables the criterion
+        double assortativity_tolerance;
+        //! Number of consecutive observations the assortativity has to be stable
+        unsigned int assortativity_window;
+
+        //! Only every interval-th call to observe() scans the graph
+        unsigned int interval;
+
+        Config()
+            : min_edges_changed(0.0)
+            , edge_filter_bits(8.0)
+            , assortativity_tolerance(0.0)
+            , assortativity_window(3)
+            , interval(1)
+        {}
+
+        //! True, if at least one criterion is enabled
+        bool enabled() const {
+            return min_edges_changed > 0.0 || assortativity_tolerance > 0.0;
+        }
+    };
+
+protected:
+    const Config _config;
+    const node_t _num_nodes;
+
+    uint_t _calls;
+    bool _initialized;
+    std::atomic<bool> _converged;
+
+    // edge touch
+    BlockedBloomFilter _initial_edges;
+    double _edges_changed;
+
+    // assortativity
+    std::vector<degree_t> _degrees;
+    double _degree_moment_2; // avg. of (j+k)/2 over all edges squared
+    double _degree_moment_3; // avg. of (j^2 + k^2)/2 over all edges
+    std::vector<double> _assortativity;
+
+    void _initialize(EdgeStream & edges);
+
+public:
+    SwapConvergenceMonitor(node_t num_nodes, const Config & config = Config());
+
+    SwapConvergenceMonitor(const SwapConvergenceMonitor&) = delete;
+
+    //! Scans the edges (which are rewound afterwards) and updates the statistics.
+    //! The first call stores the initial state; hence call it before any swap is performed.
+    //! Returns converged()
+    bool observe(EdgeStream & edges);
+
+    //! Thread-safe; may be polled while another thread calls observe()
+    bool converged() const {
+        return _converged.load(std::memory_order_relaxed);
+    }
+
+    //! Estimated fraction of initial edges no longer present in the last observation
+    double edgesChanged() const {
+        return _edges_changed;
+    }
+
+    //! Degree assortativity in the last observation (or NaN if not monitored)
+    double assortativity() const;
+
+    //! Pushes swaps into the algorithm until either the stream is exhausted or convergence is reported
+    template <class SwapStream, class SwapAlgo>
+    void pushSwaps(SwapStream & swaps, SwapAlgo & algo) const {
+        for (; !swaps.empty() && !converged(); ++swaps)
+            algo.push(*swaps);
+    }
+};
@@ -0,0 +1,77 @@
+#include "DirectedHavelHakimiGenerator.h"
+
+#include <algorithm>
+
+void DirectedHavelHakimiGenerator::generate() {
+    assert(_empty);
+    assert(_in_degrees.size() == _out_degrees.size());
+
+    _targets.clear();
+    for (node_t u = 0; u < numberOfNodes(); ++u) {
+        if (_in_degrees[u] > 0)
+            _targets.emplace(_in_degrees[u], _out_degrees[u], u);
+    }
+
+    _current_source = 0;
+    _unsatisfied_out_degree = 0;
+    _empty = false;
+
+    if (_next_source()) {
+        _current_edge = edge_t(_current_source - 1, *_current_target);
+    } else {
+        _empty = true;
+    }
+}
+
+bool DirectedHavelHakimiGenerator::_next_source() {
+    while (_current_source < numberOfNodes()) {
+        const node_t u = _current_source++;
+        const degree_t degree = _out_degrees[u];
+        if (!degree)
+            continue;
+
+        // the source must not be its own target
+        if (_in_degrees[u] > 0)
+            _targets.erase(Entry(_in_degrees[u], _out_degrees[u], u));
+
+        _current_targets.clear();
+        for (auto it = _targets.cbegin(); it != _targets.cend() && static_cast<degree_t>(_current_targets.size()) < degree; ) {
+            _current_targets.push_back(std::get<2>(*it));
+            it = _targets.erase(it);
+        }
+
+        for (const node_t v : _current_targets) {
+            if (--_in_degrees[v] > 0)
+                _targets.emplace(_in_degrees[v], _out_degrees[v], v);
+        }
+
+        // the remaining out-degree of the source is unsatisfied
+        _out_degrees[u] = degree - static_cast<degree_t>(_current_targets.size());
+        _unsatisfied_out_degree += _out_degrees[u];
+
+        if (_in_degrees[u] > 0)
+            _targets.emplace(_in_degrees[u], _out_degrees[u], u);
+
+        if (!_current_targets.empty()) {
+            std::sort(_current_targets.begin(), _current_targets.end());
+            _current_target = _current_targets.cbegin();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+DirectedHavelHakimiGenerator & DirectedHavelHakimiGenerator::operator++() {
+    assert(!_empty);
+
+    if (++_current_target == _current_targets.cend()) {
+        if (!_next_source()) {
+            _empty = true;
+            return *this;
+        }
+    }
+
+    _current_edge = edge_t(_current_source - 1, *_current_target);
+    return *this;
+}
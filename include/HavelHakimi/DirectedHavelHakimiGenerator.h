@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @brief Havel-Hakimi materialisation of directed degree sequences (Kleitman-Wang)
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <cassert>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <defs.h>
+
+/**
+ * @brief Materialises a directed graph without self-loops and multi-edges from in- and out-degrees.
+ *
+ * Nodes are numbered in the order of push(). Each node, in ascending order, connects to the nodes
+ * with the largest remaining in-degree (ties broken by the remaining out-degree), which realises
+ * every digraphical sequence. Degrees which cannot be realised are reported as unsatisfied.
+ * The edges are produced sorted by (source, target) as an STXXL stream.
+ *
+ * The generator keeps a balanced search tree of all nodes and is intended for community graphs;
+ * it requires O(n) internal memory and O(m log n) time.
+ */
+class DirectedHavelHakimiGenerator {
+public:
+    using value_type = edge_t;
+
+protected:
+    //! Remaining in-degree, remaining out-degree and node id
+    using Entry = std::tuple<degree_t, degree_t, node_t>;
+
+    std::vector<degree_t> _in_degrees;
+    std::vector<degree_t> _out_degrees;
+
+    //! Nodes with remaining in-degree, largest entry first
+    std::set<Entry, std::greater<Entry>> _targets;
+
+    node_t _current_source;
+    std::vector<node_t> _current_targets;
+    std::vector<node_t>::const_iterator _current_target;
+
+    edge_t _current_edge;
+    bool _empty;
+
+    edgeid_t _unsatisfied_out_degree;
+
+    //! Connects the next source with remaining out-degree; returns false if there is none
+    bool _next_source();
+
+public:
+    DirectedHavelHakimiGenerator()
+        : _current_source(0), _empty(true), _unsatisfied_out_degree(0)
+    { }
+
+    void push(degree_t in_degree, degree_t out_degree) {
+        assert(_empty);
+        _in_degrees.push_back(in_degree);
+        _out_degrees.push_back(out_degree);
+    }
+
+    //! Finishes the push phase
+    void generate();
+
+    const edge_t & operator*() const {
+        assert(!_empty);
+        return _current_edge;
+    }
+
+    const edge_t * operator->() const {
+        assert(!_empty);
+        return &_current_edge;
+    }
+
+    DirectedHavelHakimiGenerator & operator++();
+
+    bool empty() const {
+        return _empty;
+    }
+
+    node_t numberOfNodes() const {
+        return static_cast<node_t>(_in_degrees.size());
+    }
+
+    //! Number of edges that could not be materialised; only valid after the stream is consumed
+    edgeid_t unsatisfiedDegree() const {
+        return _unsatisfied_out_degree;
+    }
+
+    //! Remaining in-degree (or out-degree) of a node that could not be materialised;
+    //! only valid after the stream is consumed
+    degree_t unsatisfiedInDegree(node_t u) const { return _in_degrees[u]; }
+    degree_t unsatisfiedOutDegree(node_t u) const { return _out_degrees[u]; }
+};
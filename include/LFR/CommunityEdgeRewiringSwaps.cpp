@@ -3,10 +3,276 @@
 #include <Utils/RandomBoolStream.h>
 
 #include <Utils/RandomSeed.h>
+#include <CompactIMGraph.h>
+
+#include <tuple>
 
 //#define EXIT_AFTER_COM_REWIRING
 
+namespace {
+    /**
+     * Consumes community edges sorted by edge and keeps all occurrences of an edge
+     * except a random one (which stays in place) if the edge is contained in several
+     * communities. Additionally counts the edges of every community.
+     */
+    struct DuplicateCollector {
+        using edge_community_t = LFR::CommunityEdge;
+
+        std::vector<edge_community_t> duplicates;
+        std::vector<edgeid_t> community_sizes;
+
+        DuplicateCollector(STDRandomEngine & gen) : _gen(gen) {}
+
+        void push(const edge_community_t & e) {
+            if (static_cast<community_t>(community_sizes.size()) <= e.community_id)
+                community_sizes.resize(e.community_id + 1, 0);
+            ++community_sizes[e.community_id];
+
+            if (!_group.empty() && _group.front().edge != e.edge)
+                _flushGroup();
+
+            _group.push_back(e);
+        }
+
+        void finish() {
+            _flushGroup();
+        }
+
+    private:
+        STDRandomEngine & _gen;
+        std::vector<edge_community_t> _group;
+
+        void _flushGroup() {
+            if (UNLIKELY(_group.size() > 1)) {
+                std::uniform_int_distribution<size_t> dis(0, _group.size() - 1);
+                std::swap(_group[dis(_gen)], _group.back());
+                duplicates.insert(duplicates.end(), _group.begin(), _group.end() - 1);
+            }
+
+            _group.clear();
+        }
+    };
+}
+
 void CommunityEdgeRewiringSwaps::run() {
+    if (_per_community)
+        runPerCommunity();
+    else
+        runGlobal();
+}
+
+void CommunityEdgeRewiringSwaps::runPerCommunity() {
+    STDRandomEngine gen(RandomSeed::get_instance().get_next_seed());
+
+    // attempts to rewire a duplicate edge per round before it is left to the next round
+    constexpr unsigned int max_attempts = 16;
+
+    // occurrences of duplicate edges that have to be rewired, all communities are known to be simple
+    std::vector<edge_community_t> duplicates;
+    std::vector<edgeid_t> community_sizes;
+
+    {
+        DuplicateCollector collector(gen);
+        for (edge_community_vector_t::bufreader_type reader(_community_edges); !reader.empty(); ++reader)
+            collector.push(*reader);
+        collector.finish();
+
+        duplicates.swap(collector.duplicates);
+        community_sizes.swap(collector.community_sizes);
+    }
+
+    size_t last_edges_found = std::numeric_limits<size_t>::max();
+    unsigned int retry_count = 0;
+
+    unsigned int iterations = 0;
+
+    while (true) {
+        ++iterations;
+
+        const auto no_edges = _community_edges.size();
+
+        std::cout << "---- Rewiring Iteration: " << iterations
+                  << " duplicates: " << duplicates.size()
+                  << " edges: " << no_edges
+                  << " fraction: " << (100. * duplicates.size() / no_edges)
+                  << std::endl;
+
+        // no duplicates found - nothing to do anymore!
+        if (duplicates.empty())
+            break;
+
+        if (duplicates.size() == last_edges_found && last_edges_found < no_edges * 1e-3) {
+            if (++retry_count == 5) {
+                std::cout << "CommunityEdgeRewiringSwaps does not converge; give up and delete duplicates" << std::endl;
+                deleteDuplicates();
+                break;
+            }
+        } else {
+            retry_count = 0;
+            last_edges_found = duplicates.size();
+        }
+
+        // group duplicates by community
+        SEQPAR::sort(duplicates.begin(), duplicates.end(), [] (const edge_community_t & a, const edge_community_t & b) {
+            return std::tie(a.community_id, a.edge) < std::tie(b.community_id, b.edge);
+        });
+
+        // select the communities to rewire in this round; all others are only streamed.
+        // communities exceeding the budget of _max_swaps loaded edges are deferred to the next round
+        std::vector<community_t> communities;
+        std::vector<size_t> duplicates_begin;
+        std::vector<int_t> slot_of_community(community_sizes.size(), -1);
+        {
+            edgeid_t edges_loaded = 0;
+            size_t i = 0;
+            while (i < duplicates.size()) {
+                const community_t com = duplicates[i].community_id;
+                if (!communities.empty() && static_cast<size_t>(edges_loaded + community_sizes[com]) > _max_swaps)
+                    break;
+
+                slot_of_community[com] = communities.size();
+                communities.push_back(com);
+                duplicates_begin.push_back(i);
+                edges_loaded += community_sizes[com];
+
+                for (; i < duplicates.size() && duplicates[i].community_id == com; ++i);
+            }
+            duplicates_begin.push_back(i);
+        }
+
+        const int_t num_slots = communities.size();
+        _communities_per_iteration.push_back(num_slots);
+
+        // load the selected communities and set the others aside
+        std::vector<std::vector<edge_t>> community_graphs(num_slots);
+        for (int_t slot = 0; slot < num_slots; ++slot)
+            community_graphs[slot].reserve(community_sizes[communities[slot]]);
+
+        edge_community_vector_t untouched_edges;
+        untouched_edges.reserve(no_edges);
+        {
+            edge_community_vector_t::bufwriter_type writer(untouched_edges);
+            for (edge_community_vector_t::bufreader_type reader(_community_edges); !reader.empty(); ++reader) {
+                const int_t slot = slot_of_community[reader->community_id];
+                if (slot < 0)
+                    writer << *reader;
+                else
+                    community_graphs[slot].push_back(reader->edge);
+            }
+            writer.finish();
+        }
+
+        std::vector<edgeid_t> rewired_begin(num_slots + 1, 0);
+        for (int_t slot = 0; slot < num_slots; ++slot)
+            rewired_begin[slot + 1] = rewired_begin[slot] + community_graphs[slot].size();
+
+        std::vector<edge_community_t> rewired_edges(rewired_begin.back());
+
+        // swaps are restricted to a community, hence communities are rewired independently
+        uint_t swaps_performed = 0;
+        const seed_t round_seed = RandomSeed::get_instance().get_next_seed();
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:swaps_performed)
+        for (int_t slot = 0; slot < num_slots; ++slot) {
+            const community_t com = communities[slot];
+            std::vector<edge_t> & edges = community_graphs[slot];
+            const edgeid_t num_edges = edges.size();
+
+            STDRandomEngine com_gen(RandomSeed::get_instance().get_seed(round_seed + com));
+
+            CompactIMGraph graph(num_edges);
+            for (const edge_t & e : edges)
+                graph.addEdge(e);
+
+            // both the edges and the duplicates of a community are sorted
+            std::vector<edgeid_t> duplicate_ids;
+            {
+                auto dup = duplicates.cbegin() + duplicates_begin[slot];
+                const auto dup_end = duplicates.cbegin() + duplicates_begin[slot + 1];
+                for (edgeid_t eid = 0; eid < num_edges && dup != dup_end; ++eid) {
+                    if (edges[eid] == dup->edge) {
+                        duplicate_ids.push_back(eid);
+                        ++dup;
+                    }
+                }
+                assert(dup == dup_end);
+            }
+
+            std::vector<edge_t>().swap(edges);
+
+            if (num_edges > 1) {
+                std::uniform_int_distribution<edgeid_t> edge_dis(0, num_edges - 1);
+
+                for (const edgeid_t eid : duplicate_ids) {
+                    for (unsigned int attempt = 0; attempt < max_attempts; ++attempt) {
+                        const edgeid_t partner = edge_dis(com_gen);
+                        if (partner != eid && graph.swapEdges(eid, partner, com_gen() & 1).performed) {
+                            ++swaps_performed;
+                            break;
+                        }
+                    }
+                }
+
+                const edgeid_t random_swaps = std::min<edgeid_t>(duplicate_ids.size() * _random_edge_ratio, num_edges / 2);
+                for (edgeid_t i = 0; i < random_swaps; ++i) {
+                    const edgeid_t eid0 = edge_dis(com_gen);
+                    const edgeid_t eid1 = edge_dis(com_gen);
+                    if (eid0 != eid1)
+                        swaps_performed += graph.swapEdges(eid0, eid1, com_gen() & 1).performed;
+                }
+            }
+
+            for (edgeid_t eid = 0; eid < num_edges; ++eid)
+                rewired_edges[rewired_begin[slot] + eid] = edge_community_t(com, graph.getEdge(eid));
+        }
+
+        std::cout << iterations << " "
+                  << duplicates.size() << " "
+                  << num_slots << " "
+                  << rewired_edges.size() << " "
+                  << swaps_performed << " "
+                  << no_edges
+                  << " # ComRewStats iter, #dups, comms-rewired, #edges-loaded, #swaps-performed, #edges"
+                  << std::endl;
+
+        SEQPAR::sort(rewired_edges.begin(), rewired_edges.end());
+
+        // merge rewired communities back and find the duplicates of the next round on the fly
+        DuplicateCollector collector(gen);
+        {
+            edge_community_vector_t output_vector;
+            output_vector.reserve(no_edges);
+            edge_community_vector_t::bufwriter_type writer(output_vector);
+
+            edge_community_vector_t::bufreader_type reader(untouched_edges);
+            auto new_e = rewired_edges.cbegin();
+            while (!reader.empty() || new_e != rewired_edges.cend()) {
+                edge_community_t e;
+                if (new_e != rewired_edges.cend() && (reader.empty() || *new_e < *reader)) {
+                    e = *new_e;
+                    ++new_e;
+                } else {
+                    e = *reader;
+                    ++reader;
+                }
+
+                collector.push(e);
+                writer << e;
+            }
+
+            writer.finish();
+            assert(output_vector.size() == no_edges);
+            _community_edges.swap(output_vector);
+        }
+        collector.finish();
+
+        duplicates.swap(collector.duplicates);
+        community_sizes.swap(collector.community_sizes);
+    }
+
+    std::cout << "[CommunityEdgeRewiringSwaps] Number of iterations: " << (iterations-1) << std::endl;
+}
+
+void CommunityEdgeRewiringSwaps::runGlobal() {
     std::mt19937_64 gen(RandomSeed::get_instance().get_next_seed());
     std::minstd_rand fast_gen(RandomSeed::get_instance().get_next_seed());
     RandomBoolStream _bool_stream(RandomSeed::get_instance().get_next_seed());
@@ -22,6 +22,7 @@ private:
     using edge_community_vector_t = stxxl::vector<edge_community_t>;
     edge_community_vector_t &_community_edges;
     size_t _max_swaps;
+    bool _per_community;
 
     struct community_swap_edges_t {
         community_t community_id;
@@ -68,11 +69,17 @@ private:
 
     const double _random_edge_ratio;
 
+    // number of communities rewired in each iteration of the per-community mode
+    std::vector<int_t> _communities_per_iteration;
+
     template <typename Callback>
     void loadAndStoreEdges(Callback callback);
 
     void deleteDuplicates();
 
+    void runGlobal();
+    void runPerCommunity();
+
     class EdgeReaderWrapper {
     private:
         stxxl::vector<edge_community_t>::bufreader_type _reader;
@@ -112,11 +119,25 @@ private:
     };
 
 public:
-    CommunityEdgeRewiringSwaps(stxxl::vector<edge_community_t> &intra_edges, const size_t& max_swaps, const double& random_edge_ratio)
+    /**
+     * @param intra_edges Community edges sorted by edge and community; duplicate edges are rewired in-place
+     * @param max_swaps Maximum number of swaps per round (global mode) or edges loaded per round (per-community mode)
+     * @param random_edge_ratio Additional random swaps per duplicate edge
+     * @param per_community Rewire the communities containing duplicates independently and in parallel
+     *        in internal memory instead of executing all swaps on the whole edge vector at once
+     */
+    CommunityEdgeRewiringSwaps(stxxl::vector<edge_community_t> &intra_edges, const size_t& max_swaps, const double& random_edge_ratio,
+                               bool per_community = false)
             : _community_edges(intra_edges)
             , _max_swaps(max_swaps)
+            , _per_community(per_community)
             , _random_edge_ratio(random_edge_ratio)
     {};
 
     void run();
+
+    //! Number of communities rewired in each iteration (per-community mode only)
+    const std::vector<int_t> & communities_per_iteration() const {
+        return _communities_per_iteration;
+    }
 };
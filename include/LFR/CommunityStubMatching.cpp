@@ -0,0 +1,175 @@
+#include <LFR/CommunityStubMatching.h>
+#include <iostream>
+
+CommunityStubMatching::CommunityStubMatching(const stxxl::vector<LFR::CommunityAssignment> &community_assignment, seed_t seed,
+                                             unsigned int max_rounds)
+    : _stubs(new stub_sorter_t(stub_sorter_t::cmp_type(), SORTER_MEM)),
+      _num_nodes(0),
+      _random_gen(seed),
+      _max_rounds(max_rounds),
+      _current_edges(0),
+      _unmatched_stubs(0)
+{
+    loadNodeCommunities(community_assignment, _node_communities);
+}
+
+void CommunityStubMatching::push(degree_t degree) {
+    for (degree_t i = 0; i < degree; ++i)
+        _pushStub(*_stubs, _num_nodes);
+
+    ++_num_nodes;
+}
+
+void CommunityStubMatching::generate() {
+    _edges[_current_edges].consume();
+    _stubs->sort();
+
+    for (unsigned int round = 0; round < _max_rounds && !_stubs->empty(); ++round) {
+        const uint_t stubs = _stubs->size();
+        const uint_t stubs_left = _matchRound();
+
+        std::cout << "CommunityStubMatching round " << round
+                  << " stubs: " << stubs
+                  << " left: " << stubs_left
+                  << " edges: " << size()
+                  << std::endl;
+
+        if (stubs_left >= stubs)
+            break;
+    }
+
+    _unmatched_stubs = _stubs->size();
+    _stubs.reset();
+
+    _edges[_current_edges].rewind();
+}
+
+uint_t CommunityStubMatching::_matchRound() {
+    std::unique_ptr<stub_sorter_t> next_stubs(new stub_sorter_t(stub_sorter_t::cmp_type(), SORTER_MEM));
+
+    auto reject = [&] (const edge_t & e) {
+        _pushStub(*next_stubs, e.first);
+        _pushStub(*next_stubs, e.second);
+    };
+
+    // match consecutive stubs in random order
+    edge_sorter_t candidates(edge_sorter_t::cmp_type(), SORTER_MEM);
+    while (!_stubs->empty()) {
+        const node_t u = (*_stubs)->node;
+        ++(*_stubs);
+
+        if (UNLIKELY(_stubs->empty())) {
+            _pushStub(*next_stubs, u);
+            break;
+        }
+
+        edge_t e(u, (*_stubs)->node);
+        ++(*_stubs);
+
+        if (UNLIKELY(e.is_loop())) {
+            reject(e);
+        } else {
+            e.normalize();
+            candidates.push(e);
+        }
+    }
+    candidates.sort();
+    _stubs->clear();
+
+    // reject multi-edges and annotate the remaining candidates with the communities of their first node
+    candidate_sorter_t annotated(candidate_sorter_t::cmp_type(), SORTER_MEM);
+    {
+        EdgeStream & accepted = _edges[_current_edges];
+        accepted.rewind();
+
+        NodeCommunityReader node_communities(_node_communities, candidates.size());
+        std::vector<community_t> communities;
+        node_t communities_node = INVALID_NODE;
+
+        edge_t last_edge = edge_t::invalid();
+        for (; !candidates.empty(); ++candidates) {
+            const edge_t e = *candidates;
+
+            while (!accepted.empty() && *accepted < e)
+                ++accepted;
+
+            if (e == last_edge || (!accepted.empty() && *accepted == e)) {
+                reject(e);
+                continue;
+            }
+            last_edge = e;
+
+            if (e.first != communities_node) {
+                communities_node = e.first;
+                node_communities.get(e.first, communities);
+            }
+
+            annotated.push(CandidateCommunity {e.second, e.first, -1});
+            for (const community_t com : communities)
+                annotated.push(CandidateCommunity {e.second, e.first, com});
+        }
+    }
+    annotated.sort();
+
+    // reject candidates whose second node shares a community with the first one
+    edge_sorter_t accepted_round(edge_sorter_t::cmp_type(), SORTER_MEM);
+    {
+        NodeCommunityReader node_communities(_node_communities, annotated.size());
+        std::vector<community_t> communities;
+        node_t communities_node = INVALID_NODE;
+
+        while (!annotated.empty()) {
+            const edge_t e(annotated->tail, annotated->head);
+
+            if (e.second != communities_node) {
+                communities_node = e.second;
+                node_communities.get(e.second, communities);
+            }
+
+            // both the annotations and the communities are sorted ascending
+            bool conflict = false;
+            auto com_it = communities.cbegin();
+            for (; !annotated.empty() && annotated->head == e.second && annotated->tail == e.first; ++annotated) {
+                const community_t com = annotated->tail_community;
+                while (com_it != communities.cend() && *com_it < com)
+                    ++com_it;
+
+                conflict |= (com_it != communities.cend() && *com_it == com);
+            }
+
+            if (conflict)
+                reject(e);
+            else
+                accepted_round.push(e);
+        }
+    }
+    accepted_round.sort();
+
+    // merge edges accepted in this round into the previously accepted ones
+    {
+        EdgeStream & old_edges = _edges[_current_edges];
+        EdgeStream & new_edges = _edges[1 - _current_edges];
+
+        old_edges.rewind();
+        new_edges.clear();
+
+        while (!old_edges.empty() || !accepted_round.empty()) {
+            if (!accepted_round.empty() && (old_edges.empty() || *accepted_round < *old_edges)) {
+                new_edges.push(*accepted_round);
+                ++accepted_round;
+            } else {
+                new_edges.push(*old_edges);
+                ++old_edges;
+            }
+        }
+
+        new_edges.consume();
+        old_edges.clear();
+        _current_edges = 1 - _current_edges;
+    }
+
+    _stubs.swap(next_stubs);
+    _stubs->sort();
+
+    return _stubs->size();
+}
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief Random global graph whose edges avoid shared communities by stub matching
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <array>
+#include <memory>
+#include <random>
+
+#include <defs.h>
+#include <GenericComparator.h>
+#include <EdgeStream.h>
+#include <stxxl/sorter>
+#include <LFR/NodeCommunities.h>
+
+/**
+ * @brief Generates the inter-community graph of LFR by a configuration model with rejection.
+ *
+ * Every node gets as many stubs as its degree; the stubs are shuffled by sorting random keys
+ * and matched pairwise. Pairs forming a self-loop, a multi-edge or an edge within a community
+ * shared by both endpoints are rejected and their stubs are shuffled again in the next round.
+ * Hence, the graph never contains intra-community edges and needs neither a subsequent
+ * randomisation nor a global rewiring. Stubs that are still unmatched once a round makes no
+ * progress (or after max_rounds) are dropped, which slightly reduces the degrees of their nodes.
+ *
+ * Each round sorts the remaining stubs and scans the edges accepted so far; community
+ * memberships are joined via NodeCommunityReader, so late rounds with few stubs only
+ * look up the endpoints involved.
+ */
+class CommunityStubMatching {
+public:
+    using value_type = edge_t;
+
+    CommunityStubMatching(const stxxl::vector<LFR::CommunityAssignment> &community_assignment, seed_t seed,
+                          unsigned int max_rounds = 32);
+
+    //! Pushes the degree of the next node, starting at node 0
+    void push(degree_t degree);
+
+    //! Matches the stubs and finishes the push phase
+    void generate();
+
+//! @name STXXL Streaming Interface
+//! @{
+    //! Edges are normalized and sorted in ascending order
+    bool empty() const { return _edges[_current_edges].empty(); }
+    const value_type & operator*() const { return *_edges[_current_edges]; }
+    const value_type * operator->() const { return &(*_edges[_current_edges]); }
+
+    CommunityStubMatching & operator++() {
+        ++_edges[_current_edges];
+        return *this;
+    }
+//! @}
+
+    external_size_t size() const { return _edges[_current_edges].size(); }
+
+    //! Number of stubs dropped since they could not be matched
+    edgeid_t unmatchedStubs() const { return _unmatched_stubs; }
+
+private:
+    struct Stub {
+        uint64_t key;
+        node_t node;
+
+        DECL_LEX_COMPARE(Stub, key, node)
+    };
+
+    //! Candidate edge {tail, head} (tail < head) annotated with a community of tail; -1 marks the edge itself
+    struct CandidateCommunity {
+        node_t head;
+        node_t tail;
+        community_t tail_community;
+
+        DECL_LEX_COMPARE(CandidateCommunity, head, tail, tail_community)
+    };
+
+    using stub_sorter_t = stxxl::sorter<Stub, GenericComparatorStruct<Stub>::Ascending>;
+    using edge_sorter_t = stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending>;
+    using candidate_sorter_t = stxxl::sorter<CandidateCommunity, GenericComparatorStruct<CandidateCommunity>::Ascending>;
+
+    node_community_vector_t _node_communities;
+    std::unique_ptr<stub_sorter_t> _stubs;
+    node_t _num_nodes;
+
+    STDRandomEngine _random_gen;
+    const unsigned int _max_rounds;
+
+    // accepted edges; a round merges the edges of _current_edges into the other stream
+    std::array<EdgeStream, 2> _edges;
+    unsigned int _current_edges;
+
+    edgeid_t _unmatched_stubs;
+
+    void _pushStub(stub_sorter_t & sorter, node_t u) {
+        sorter.push(Stub {_random_gen(), u});
+    }
+
+    //! Matches all stubs once; returns the number of stubs left for the next round
+    uint_t _matchRound();
+};
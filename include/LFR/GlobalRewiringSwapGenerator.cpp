@@ -6,32 +6,18 @@ GlobalRewiringSwapGenerator::GlobalRewiringSwapGenerator(const stxxl::vector< LF
       _num_edges(numEdges),
       _empty(true),
       _rand_gen(seed),
-      _rand_distr(0, numEdges-1),
-      _bool_stream(_rand_gen())
+      _bool_stream(seed, 1)
     {
 
-    stxxl::sorter<NodeCommunity, GenericComparatorStruct<NodeCommunity>::Ascending> node_community_sorter(GenericComparatorStruct<NodeCommunity>::Ascending(), SORTER_MEM);
-    #pragma omp critical (_community_assignment)
-    {
-        stxxl::vector<LFR::CommunityAssignment>::bufreader_type communityReader(communityAssignment);
-
-        while (!communityReader.empty()) {
-            node_community_sorter.push(NodeCommunity {communityReader->node_id, communityReader->community_id});
-            ++communityReader;
-        }
-    }
-
-    for (node_community_sorter.sort(); !node_community_sorter.empty(); ++node_community_sorter) {
-        _node_communities.push_back(*node_community_sorter);
-    }
+    loadNodeCommunities(communityAssignment, _node_communities);
 }
 
 void GlobalRewiringSwapGenerator::generate() {
     assert(empty());
     std::swap(_edge_community_input_sorter, _edge_community_output_sorter);
     _edge_community_output_sorter->sort();
-    _node_community_reader.reset(new decltype(_node_communities)::stream(_node_communities));
-    _current_node = 0;
+    _node_community_reader.reset(new NodeCommunityReader(_node_communities, _edge_community_output_sorter->size()));
+    _current_node = INVALID_NODE;
     _empty = false;
 
     operator++();
@@ -40,9 +26,10 @@ void GlobalRewiringSwapGenerator::generate() {
 GlobalRewiringSwapGenerator &GlobalRewiringSwapGenerator::operator++() {
     assert(_node_community_reader);
     while (!_edge_community_output_sorter->empty()) {
-        while (!_node_community_reader->empty() && (**_node_community_reader).node == _current_node) {
-            _current_communities.push_back((**_node_community_reader).community);
-            ++(*_node_community_reader);
+        // we may return within the edges of a node, so only load communities of new nodes
+        if ((*_edge_community_output_sorter)->head != _current_node) {
+            _current_node = (*_edge_community_output_sorter)->head;
+            _node_community_reader->get(_current_node, _current_communities);
         }
 
         assert(!_current_communities.empty());
@@ -66,7 +53,7 @@ GlobalRewiringSwapGenerator &GlobalRewiringSwapGenerator::operator++() {
 
                 if ((*_edge_community_output_sorter)->tail_community == com) {
                     // generate swap with random partner
-                    edgeid_t eid1 = _rand_distr(_rand_gen);
+                    edgeid_t eid1 = static_cast<edgeid_t>(_rand_gen.bounded(_num_edges));
 
                     _swap = SemiLoadedSwapDescriptor {edge_t {(*_edge_community_output_sorter)->tail, (*_edge_community_output_sorter)->head}, eid1, *_bool_stream};
                     ++_bool_stream;
@@ -86,9 +73,6 @@ GlobalRewiringSwapGenerator &GlobalRewiringSwapGenerator::operator++() {
                 ++(*_edge_community_output_sorter);
             }
         }
-
-        ++_current_node;
-        _current_communities.clear();
     }
 
     _node_community_reader.reset(nullptr);
@@ -1,22 +1,15 @@
 #pragma once
 
 #include <LFR/LFR.h>
+#include <LFR/NodeCommunities.h>
 #include <Swaps.h>
 #include <GenericComparator.h>
 #include <memory>
-#include <stxxl/sequence>
+#include <Utils/PhiloxRNG.h>
 #include <Utils/RandomBoolStream.h>
-#include <random>
 
 class GlobalRewiringSwapGenerator {
 public:
-    struct NodeCommunity {
-        node_t node;
-        community_t community;
-
-        DECL_LEX_COMPARE(NodeCommunity, node, community)
-    };
-
     struct EdgeCommunity {
         node_t head;
         node_t tail;
@@ -26,9 +19,9 @@ public:
     };
 
 private:
-    stxxl::sequence<NodeCommunity> _node_communities;
+    node_community_vector_t _node_communities;
     using edge_community_sorter_t = stxxl::sorter<EdgeCommunity, GenericComparatorStruct<EdgeCommunity>::Ascending>;
-    std::unique_ptr<stxxl::sequence<NodeCommunity>::stream> _node_community_reader; // when storing this by value, the end iterator is initialized too early...
+    std::unique_ptr<NodeCommunityReader> _node_community_reader;
     std::unique_ptr<edge_community_sorter_t> _edge_community_input_sorter;
     std::unique_ptr<edge_community_sorter_t> _edge_community_output_sorter;
     edgeid_t _num_edges;
@@ -38,8 +31,7 @@ private:
     SemiLoadedSwapDescriptor _swap;
     bool _empty;
 
-    STDRandomEngine _rand_gen;
-    std::uniform_int_distribution<edgeid_t> _rand_distr;
+    PhiloxRNG _rand_gen;
     RandomBoolStream _bool_stream;
 
 public:
@@ -69,18 +61,14 @@ public:
             _edge_community_input_sorter.reset(new edge_community_sorter_t(edge_community_sorter_t::cmp_type(), SORTER_MEM));
         }
 
-        decltype(_node_communities)::stream nodeCommunityReader(_node_communities);
+        NodeCommunityReader nodeCommunityReader(_node_communities, edgeIterator.size());
 
         std::vector<community_t> currentCommunities;
 
-        // for each node
-        for (node_t u = 0; !nodeCommunityReader.empty(); ++u) {
-            currentCommunities.clear();
-            // read all communities from sorter
-            while (!nodeCommunityReader.empty() && (*nodeCommunityReader).node == u) {
-                currentCommunities.push_back((*nodeCommunityReader).community);
-                ++nodeCommunityReader;
-            }
+        // for each node with edges
+        while (!edgeIterator.empty()) {
+            const node_t u = edgeIterator->first;
+            nodeCommunityReader.get(u, currentCommunities);
 
             // iterate over edges in currentEdges that start with that node
             while (!edgeIterator.empty() && edgeIterator->first == u) {
@@ -150,7 +150,18 @@ namespace LFR {
         {
             IOStatistics iols("LFR");
 
-            _compute_node_distributions();
+            if (_directed) {
+                const bool is_disjoint = (_overlap_method == OverlapMethod::constDegree && _overlap_config.constDegree.overlappingNodes == 0);
+                if (!is_disjoint)
+                    throw std::runtime_error("Directed LFR graphs only support disjoint communities.");
+                if (_community_randomisation == curveball || _global_randomisation == curveball)
+                    throw std::runtime_error("Directed LFR graphs can only be randomised with edge swaps.");
+
+                _compute_directed_node_distributions();
+            } else {
+                _compute_node_distributions();
+            }
+
             _compute_community_size();
             _correct_community_sizes();
             _compute_community_assignments();
@@ -169,7 +180,9 @@ namespace LFR {
             {
                 IOStatistics ios("GenCommGraphs");
                 const bool is_disjoint = (_overlap_method == OverlapMethod::constDegree && _overlap_config.constDegree.overlappingNodes == 0);
-                if (is_disjoint) {
+                if (_directed) {
+                    _generate_directed_community_graphs();
+                } else if (is_disjoint) {
                     _generate_community_graphs<true>();
                 } else {
                     _generate_community_graphs<false>();
@@ -180,7 +193,11 @@ namespace LFR {
             }
             {
                 IOStatistics ios("GenGlobGraph");
-                _generate_global_graph(globalSwapsPerIteration);
+                if (_directed) {
+                    _generate_directed_global_graph(globalSwapsPerIteration);
+                } else {
+                    _generate_global_graph(globalSwapsPerIteration);
+                }
                 std::cout << "Current EM allocation after GenGlobGraph: " <<  stxxl::block_manager::get_instance()->get_current_allocation() << std::endl;
                 std::cout << "Maximum EM allocation after GenGlobGraph: " <<  stxxl::block_manager::get_instance()->get_maximum_allocation() << std::endl;
             }
@@ -190,6 +207,10 @@ namespace LFR {
                 std::cout << "Current EM allocation after MergeGraphs: " <<  stxxl::block_manager::get_instance()->get_current_allocation() << std::endl;
                 std::cout << "Maximum EM allocation after MergeGraphs: " <<  stxxl::block_manager::get_instance()->get_maximum_allocation() << std::endl;
             }
+            if (_weighted) {
+                IOStatistics ios("AssignWeights");
+                _assign_edge_weights();
+            }
 
             std::cout << "Resulting graph has " << _edges.size() << " edges, " << _intra_community_edges.size() << " of them are intra-community edges and " <<
             _inter_community_edges.size() << " of them are inter-community edges. Mixing: "
@@ -198,7 +219,11 @@ namespace LFR {
             << std::endl;
         }
 
-        _verify_result_graph();
+        if (_directed) {
+            _verify_directed_result_graph();
+        } else {
+            _verify_result_graph();
+        }
     }
 
 }
@@ -9,10 +9,15 @@
 #include <stxxl/sorter>
 #include <stxxl/vector>
 #include <EdgeStream.h>
+#include <BoolStream.h>
+#include <EdgeSwaps/SwapConvergenceMonitor.h>
 
 //#define LFR_TESTING
 
 namespace LFR {
+//! Weight of an edge in weighted mode, see LFR::setWeighted()
+using edge_weight_t = float;
+
 class NodeDegreeMembership {
     degree_t _degree;
     community_t _memberships;
@@ -99,6 +104,51 @@ struct CommunityEdge {
     DECL_LEX_COMPARE_OS(CommunityEdge, edge, community_id);
 };
 
+//! In- and out-degree of a node in a directed LFR graph and the parts within its community
+struct DirectedNodeDegree {
+    degree_t in_degree;
+    degree_t out_degree;
+    degree_t intra_in_degree;
+    degree_t intra_out_degree;
+
+    DirectedNodeDegree() {}
+    DirectedNodeDegree(degree_t in_degree, degree_t out_degree, degree_t intra_in_degree, degree_t intra_out_degree)
+        : in_degree(in_degree), out_degree(out_degree), intra_in_degree(intra_in_degree), intra_out_degree(intra_out_degree) {}
+
+    //! The community assignment only needs to respect the larger of both degrees
+    NodeDegreeMembership membership() const {
+        return NodeDegreeMembership(std::max(in_degree, out_degree), 1);
+    }
+
+    DECL_LEX_COMPARE_OS(DirectedNodeDegree, in_degree, out_degree, intra_in_degree, intra_out_degree);
+};
+
+//! Orders nodes like NodeDegreeMembershipInternalDegComparator, ties are broken by the directed degrees
+class DirectedNodeDegreeComparator {
+    const NodeDegreeMembershipInternalDegComparator _membership_comparator;
+
+public:
+    DirectedNodeDegreeComparator(double m) : _membership_comparator(m) {}
+
+    bool operator()(const DirectedNodeDegree &a, const DirectedNodeDegree &b) const {
+        const auto am = a.membership();
+        const auto bm = b.membership();
+        if (_membership_comparator(am, bm)) return true;
+        if (_membership_comparator(bm, am)) return false;
+        return a > b;
+    }
+
+    DirectedNodeDegree max_value() const {
+        const auto d = std::numeric_limits<degree_t>::min();
+        return {d, d, d, d};
+    }
+
+    DirectedNodeDegree min_value() const {
+        const auto d = std::numeric_limits<degree_t>::max();
+        return {d, d, d, d};
+    }
+};
+
 struct OverlapConfigConstDegree {
     community_t multiCommunityDegree;
     node_t overlappingNodes;
@@ -117,6 +167,16 @@ enum OverlapMethod {
     constDegree, geometric
 };
 
+//! Algorithm used to randomise the Havel-Hakimi materialisations of the community and global graphs
+enum RandomisationMethod {
+    edgeSwaps, curveball
+};
+
+//! Generator of the global graph; stub matching avoids intra-community edges and needs no randomisation
+enum GlobalGenerationMethod {
+    havelHakimi, stubMatching
+};
+
 class LFR {
     friend class LFRCommunityAssignBenchmark;
 
@@ -144,6 +204,21 @@ protected:
     uint_t _degree_sum;
 
     double _community_rewiring_random {0.0};
+    bool _community_rewiring_per_community {false};
+
+    SwapConvergenceMonitor::Config _swap_convergence;
+
+    RandomisationMethod _community_randomisation {edgeSwaps};
+    RandomisationMethod _global_randomisation {edgeSwaps};
+    GlobalGenerationMethod _global_generation {havelHakimi};
+
+    bool _directed {false};
+    NodeDegreeDistribution::Parameters _out_degree_distribution_params;
+
+    bool _weighted {false};
+    double _weight_exponent {1.5};
+    double _weight_mixing {0.0};
+    unsigned int _weight_max_passes {50};
 
     // model materialization
     stxxl::sorter<NodeDegreeMembership, NodeDegreeMembershipInternalDegComparator> _node_sorter;
@@ -161,10 +236,21 @@ protected:
      * of community k */
     stxxl::vector<CommunityAssignment> _community_assignments;
 
+    /**
+     * Directed degrees indexed by node id, i.e. in the order of _node_sorter;
+     * only used in directed mode */
+    stxxl::vector<DirectedNodeDegree> _directed_degrees;
+
     EdgeStream _intra_community_edges;
     EdgeStream _inter_community_edges;
     EdgeStream _edges;
 
+    //! Weights of _edges in the same order; only computed in weighted mode
+    stxxl::vector<edge_weight_t> _edge_weights;
+
+    //! Whether the i-th edge of _edges is an intra-community edge; only recorded in weighted mode
+    BoolStream _intra_edge_flags;
+
 
     /// Get community size based on _community_cumulative_sizes
     node_t _community_size(community_t com) const {
@@ -181,8 +267,16 @@ protected:
     void _generate_global_graph(int_t swaps_per_iteration);
     void _merge_community_and_global_graph();
 
+    // directed mode, see setDirected()
+    void _compute_directed_node_distributions();
+    void _generate_directed_community_graphs();
+    void _generate_directed_global_graph(int_t swaps_per_iteration);
+
+    void _assign_edge_weights();
+
     void _verify_assignment();
     void _verify_result_graph();
+    void _verify_directed_result_graph();
 
 public:
     LFR(const NodeDegreeDistribution::Parameters & node_degree_dist,
@@ -213,6 +307,11 @@ public:
           : LFR(other._degree_distribution_params, other._community_distribution_params, other._mixing, other._max_memory_usage)
     {
         setOverlap(other._overlap_method, other._overlap_config);
+        setRandomisation(other._community_randomisation, other._global_randomisation);
+        if (other._directed)
+            setDirected(other._out_degree_distribution_params);
+        if (other._weighted)
+            setWeighted(other._weight_exponent, other._weight_mixing, other._weight_max_passes);
     }
 
     void setOverlap(OverlapMethod method, const OverlapConfig & config) {
@@ -224,11 +323,69 @@ public:
         return _edges;
     }
 
+    //! Weights of get_edges() in the same order; empty unless setWeighted() was called
+    stxxl::vector<edge_weight_t> & get_edge_weights() {
+        return _edge_weights;
+    }
+
     void setCommunityRewiringRandom(const double& v) {
         assert(v >= 0);
         _community_rewiring_random = v;
     }
 
+    //! Remove duplicate edges of overlapping communities by rewiring the affected
+    //! communities independently and in parallel instead of on the whole edge vector.
+    void setCommunityRewiringPerCommunity(bool v) {
+        _community_rewiring_per_community = v;
+    }
+
+    //! Stop the edge swap randomisation of external communities and the global graph
+    //! early if the criteria are met; by default all 10*|E| swaps are executed.
+    void setSwapConvergence(const SwapConvergenceMonitor::Config & config) {
+        _swap_convergence = config;
+    }
+
+    //! Randomisation of the community graphs and the global graph respectively.
+    //! Curveball runs in internal memory for communities fitting into it.
+    void setRandomisation(RandomisationMethod community, RandomisationMethod global) {
+        _community_randomisation = community;
+        _global_randomisation = global;
+    }
+
+    //! With stubMatching, the global randomisation is skipped and the rewiring only cleans up
+    void setGlobalGeneration(GlobalGenerationMethod method) {
+        _global_generation = method;
+    }
+
+    /**
+     * Generate a directed graph. The node degree distribution passed to the constructor is used
+     * for the in-degrees, out_degree_dist for the out-degrees; both are paired randomly.
+     * Community graphs are materialised with DirectedHavelHakimiGenerator and randomised
+     * with directed edge swaps, the global graph is a random stub matching which is rewired
+     * to avoid intra-community edges. Only disjoint communities and edge swaps are supported,
+     * the global generation method is ignored.
+     */
+    void setDirected(const NodeDegreeDistribution::Parameters & out_degree_dist) {
+        _directed = true;
+        _out_degree_distribution_params = out_degree_dist;
+        _out_degree_distribution_params.numberOfNodes = _number_of_nodes;
+    }
+
+    /**
+     * Assign weights to the edges of the final graph as in the weighted LFR benchmark: the
+     * strength of a node is its degree to the power of exponent, and the fraction weight_mixing
+     * of it should lie on inter-community edges. The weights are computed in streaming passes
+     * which reduce the squared deviation from the wished strengths until the relative improvement
+     * drops below one percent or max_passes are done.
+     */
+    void setWeighted(double exponent, double weight_mixing, unsigned int max_passes = 50) {
+        assert(weight_mixing >= 0 && weight_mixing <= 1);
+        _weighted = true;
+        _weight_exponent = exponent;
+        _weight_mixing = weight_mixing;
+        _weight_max_passes = max_passes;
+    }
+
     /**
      * This exports the community assignments such that in every line a node id and its community/communities are written (separated by space).
      * Node ids are 1-based.
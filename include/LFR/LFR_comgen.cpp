@@ -2,14 +2,14 @@
 #include "CommunityEdgeRewiringSwaps.h"
 #include <HavelHakimi/HavelHakimiIMGenerator.h>
 #include <SwapGenerator.h>
-#include <IMGraph.h>
-#include <EdgeSwaps/IMEdgeSwap.h>
-#include <EdgeSwaps/EdgeSwapTFP.h>
+#include <CompactIMGraph.h>
+#include <EdgeSwaps/EdgeSwapFactory.h>
 
 #include <Utils/RandomSeed.h>
 
 #include <Utils/NodeHash.h>
 #include <Curveball/EMCurveball.h>
+#include <Curveball/IMCurveball.h>
 
 namespace LFR {
     namespace {
@@ -36,6 +36,91 @@ namespace LFR {
             const CommunityEdge& get_community_edge(const CommunityEdge& e) {
                 return e;
             };
+
+            constexpr Curveball::tradeid_t curveball_rounds = 20;
+
+            //! Receiver pushing the edges of a community by the given callback
+            template <typename PushCallback>
+            class CommunityEdgeReceiver {
+                PushCallback & _push_com_edge;
+                const community_t _com;
+
+                #ifndef NDEBUG
+                // the edges arrive unsorted, hence duplicates are only found after sorting
+                stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending> _debug_edges;
+                #endif
+
+            public:
+                CommunityEdgeReceiver(PushCallback & push_com_edge, community_t com)
+                    : _push_com_edge(push_com_edge)
+                    , _com(com)
+                    #ifndef NDEBUG
+                    , _debug_edges(GenericComparator<edge_t>::Ascending(), SORTER_MEM)
+                    #endif
+                {}
+
+                void push(const edge_t & e) {
+                    assert(!e.is_loop());
+
+                    #ifndef NDEBUG
+                    _debug_edges.push(e);
+                    #endif
+
+                    _push_com_edge(_com, e);
+                }
+
+                //! Checks in debug builds that no edge has been pushed twice
+                void verify() {
+                    #ifndef NDEBUG
+                    _debug_edges.sort();
+
+                    edge_t last_e(edge_t::invalid());
+                    for (; !_debug_edges.empty(); ++_debug_edges) {
+                        assert(*_debug_edges != last_e);
+                        last_e = *_debug_edges;
+                    }
+                    #endif
+                }
+            };
+
+            /**
+             * Randomises the community graph with Curveball, in internal memory if it fits.
+             * The degrees have to be the realised ones. The edges are pushed into out_edges,
+             * which may be intra_edges itself or, e.g., an EdgeRelabeller; without sorted
+             * output, EMCurveball saves the final sort of the edges.
+             */
+            template <typename DegreeStream, typename OutReceiver>
+            void randomise_with_curveball(EdgeStream & intra_edges, DegreeStream & realised_degrees,
+                                          node_t com_size, int num_threads, uint_t max_memory,
+                                          OutReceiver & out_edges, bool sorted_output) {
+                constexpr Curveball::tradeid_t num_rounds = curveball_rounds;
+
+                if (Curveball::IMCurveball<>::memoryUsage(com_size, intra_edges.size()) < max_memory) {
+                    std::vector<degree_t> degrees;
+                    degrees.reserve(static_cast<size_t>(com_size));
+                    for (; !realised_degrees.empty(); ++realised_degrees)
+                        degrees.push_back(*realised_degrees);
+
+                    Curveball::IMCurveball<> randAlgo(degrees, num_rounds, num_threads);
+                    for (; !intra_edges.empty(); ++intra_edges)
+                        randAlgo.push(*intra_edges);
+                    randAlgo.run();
+
+                    out_edges.clear();
+                    randAlgo.forward_edges(out_edges);
+                } else {
+                    using CurveballType = Curveball::EMCurveball<Curveball::ModHash, DegreeStream, EdgeStream, OutReceiver>;
+                    CurveballType randAlgo(intra_edges,
+                                           realised_degrees,
+                                           com_size,
+                                           num_rounds,
+                                           out_edges,
+                                           num_threads,
+                                           max_memory,
+                                           sorted_output);
+                    randAlgo.run();
+                }
+            }
     }
 
     template <bool is_disjoint>
@@ -70,124 +155,151 @@ namespace LFR {
                 }
 
                 std::vector<node_t> node_ids;
-                std::vector<degree_t> node_degrees;
-
-                int_t degree_sum = 0;
 
-                #ifdef CURVEBALL_RAND
-                HavelHakimiIMGeneratorWithDegrees gen(HavelHakimiIMGeneratorWithDegrees::DecreasingDegree);
-                #else
-                HavelHakimiIMGenerator gen(HavelHakimiIMGenerator::DecreasingDegree);
-                #endif
+                // the generator additionally reports the realised degrees if Curveball needs them
+                auto generate_community = [&] (auto & gen) {
+                    int_t degree_sum = 0;
+
+                    external_node_ids.clear();
+                    external_node_ids.resize(static_cast<size_t>(com_size));
+                    stxxl::vector<node_t>::bufwriter_type node_id_writer(external_node_ids);
+
+                    #pragma omp critical (_community_assignment)
+                    for (auto it(_community_assignments.cbegin() + _community_cumulative_sizes[external_com]);
+                         it < _community_assignments.cbegin() + _community_cumulative_sizes[external_com + 1];
+                         ++it)
+                    {
+                        const auto ca = *it;
+                        assert(ca.community_id == external_com);
+                        node_id_writer << ca.node_id;
+                        degree_sum += ca.degree;
+                        gen.push(ca.degree);
+                    }
 
-                external_node_ids.clear();
-                external_node_ids.resize(static_cast<size_t>(com_size));
-                stxxl::vector<node_t>::bufwriter_type node_id_writer(external_node_ids);
-
-                #pragma omp critical (_community_assignment)
-                for (auto it(_community_assignments.cbegin() + _community_cumulative_sizes[external_com]);
-                     it < _community_assignments.cbegin() + _community_cumulative_sizes[external_com + 1];
-                     ++it)
-                {
-                    const auto ca = *it;
-                    assert(ca.community_id == external_com);
-                    node_id_writer << ca.node_id;
-                    degree_sum += ca.degree;
-                    gen.push(ca.degree);
-                }
+                    node_id_writer.finish();
 
-                node_id_writer.finish();
+                    gen.generate();
 
-                gen.generate();
+                    std::cout << "internalNodes: " << 0 << " "
+                              << "memoryEstimate: " << CompactIMGraph::memoryUsage(com_size, degree_sum / 2) << " "
+                              << "memoryAvail: " << _max_memory_usage << " "
+                              << "degreeSum: " << degree_sum/2 << " "
+                              << "maxEdges: " << CompactIMGraph::maxEdges()
+                              << std::endl;
 
-                std::cout << "internalNodes: " << 0 << " "
-                          << "memoryEstimate: " << IMGraph::memoryUsage(com_size, degree_sum / 2) << " "
-                          << "memoryAvail: " << _max_memory_usage << " "
-                          << "degreeSum: " << degree_sum/2 << " "
-                          << "maxEdges: " << IMGraph::maxEdges()
-                          << std::endl;
+                    EdgeStream intra_edges;
 
-                EdgeStream intra_edges;
+                    for (; !gen.empty(); ++gen) {
+                        assert(gen->first < gen->second);
+                        intra_edges.push(*gen);
+                    }
 
-                for (; !gen.empty(); ++gen) {
-                    assert(gen->first < gen->second);
-                    intra_edges.push(*gen);
-                }
+                    intra_edges.consume();
 
-                intra_edges.consume();
-
-                #ifdef CURVEBALL_RAND
-                gen.finalize();
-                auto & realised_degrees = gen.get_degree_stream();
-                realised_degrees.rewind();
-                assert(realised_degrees.size() == static_cast<size_t>(com_size));
-
-                using CurveballType = Curveball::EMCurveball<Curveball::ModHash, decltype(realised_degrees)>;
-                CurveballType randAlgo(intra_edges,
-                                       realised_degrees,
-                                       com_size,
-                                       20,
-                                       intra_edges,
-                                       static_cast<int>(n_threads),
-                                       _max_memory_usage,
-                                       true);
-                randAlgo.run();
-                #else
-                // Generate swaps
-                uint_t numSwaps = 10 * intra_edges.size();
-                SwapGenerator swap_gen(numSwaps, intra_edges.size(), RandomSeed::get_instance().get_seed(external_com));
-
-                uint_t run_length = intra_edges.size() / 8;
-
-                // perform swaps
-                EdgeSwapTFP::EdgeSwapTFP swap_algo(intra_edges, run_length, _number_of_nodes, memory_per_thread);
-
-                StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
-
-                swap_algo.run();
-                #endif
+                    if (_community_randomisation == curveball) {
+                        gen.finalize();
+                        auto & realised_degrees = gen.get_degree_stream();
+                        realised_degrees.rewind();
+                        assert(realised_degrees.size() == static_cast<size_t>(com_size));
+
+                        const uint_t node_ids_size = static_cast<uint_t>(com_size) * sizeof(node_t);
+                        if (node_ids_size < _max_memory_usage / 4) {
+                            // the node ids fit into memory, hence Curveball pushes the relabelled
+                            // edges directly into the edge sorter; communities in external memory
+                            // are processed sequentially, so no critical section is needed
+                            node_ids.reserve(static_cast<size_t>(com_size));
+                            for (decltype(external_node_ids)::bufreader_type node_id_reader(external_node_ids);
+                                 !node_id_reader.empty(); ++node_id_reader)
+                                node_ids.push_back(*node_id_reader);
+
+                            CommunityEdgeReceiver<decltype(push_com_edge)> com_edges(push_com_edge, external_com);
+                            auto relabeller = Curveball::make_edge_relabeller(node_ids, com_edges);
+                            randomise_with_curveball(intra_edges, realised_degrees, com_size,
+                                                     static_cast<int>(n_threads),
+                                                     _max_memory_usage - node_ids_size,
+                                                     relabeller, false);
+                            com_edges.verify();
+                            return;
+                        }
 
-                intra_edges.rewind();
+                        randomise_with_curveball(intra_edges, realised_degrees, com_size,
+                                                 static_cast<int>(n_threads), _max_memory_usage,
+                                                 intra_edges, true);
+                    } else {
+                        // Generate swaps
+                        uint_t numSwaps = 10 * intra_edges.size();
+                        SwapGenerator swap_gen(numSwaps, intra_edges.size(), RandomSeed::get_instance().get_seed(external_com));
+
+                        SwapConvergenceMonitor monitor(com_size, _swap_convergence);
+
+                        // the factory picks internal memory swaps for communities fitting into memory;
+                        // communities in external memory are processed one after another, hence the
+                        // whole memory is available to the selected engine
+                        const EdgeSwapInstance instance(intra_edges.size(), com_size, numSwaps, _max_memory_usage, static_cast<int>(n_threads));
+                        EdgeSwapFactory::ProcessSwapCallback callback;
+                        if (_swap_convergence.enabled()) {
+                            monitor.observe(intra_edges);
+                            callback = [&](uint_t) {monitor.observe(intra_edges);};
+                        }
 
-                stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending>
-                        intra_edgeSorter(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
+                        auto swap_algo = EdgeSwapFactory().create(intra_edges, instance, callback);
+                        STXXL_MSG("Swapping community " << external_com << " with " << EdgeSwapFactory::name(swap_algo->algorithm()));
 
-                {
-                    decltype(external_node_ids)::bufreader_type node_id_reader(external_node_ids);
+                        monitor.pushSwaps(swap_gen, *swap_algo);
 
-                    for (node_t u = 0; !node_id_reader.empty(); ++u, ++node_id_reader) {
-                        while (!intra_edges.empty() && intra_edges->first == u) {
-                            intra_edgeSorter.push(edge_t {intra_edges->second, *node_id_reader});
-                            ++intra_edges;
-                        }
+                        swap_algo->run();
                     }
-                }
 
-                intra_edgeSorter.sort();
+                    intra_edges.rewind();
 
-                {
-                    decltype(external_node_ids)::bufreader_type node_id_reader(external_node_ids);
+                    stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending>
+                            intra_edgeSorter(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
 
-                    #ifndef NDEBUG
-                    edge_t last_e(edge_t::invalid());
-                    #endif
+                    {
+                        decltype(external_node_ids)::bufreader_type node_id_reader(external_node_ids);
 
-                    #pragma omp critical (_edgeSorter)
-                    for (node_t u = 0; !node_id_reader.empty(); ++u, ++node_id_reader) {
-                        while (!intra_edgeSorter.empty() && intra_edgeSorter->first == u) {
-                            edge_t e(intra_edgeSorter->second, *node_id_reader);
-                            e.normalize();
+                        for (node_t u = 0; !node_id_reader.empty(); ++u, ++node_id_reader) {
+                            while (!intra_edges.empty() && intra_edges->first == u) {
+                                intra_edgeSorter.push(edge_t {intra_edges->second, *node_id_reader});
+                                ++intra_edges;
+                            }
+                        }
+                    }
 
-                            #ifndef NDEBUG
-                            assert(e != last_e);
-                            assert(!e.is_loop());
-                            last_e = e;
-                            #endif
+                    intra_edgeSorter.sort();
+
+                    {
+                        decltype(external_node_ids)::bufreader_type node_id_reader(external_node_ids);
+
+                        #ifndef NDEBUG
+                        edge_t last_e(edge_t::invalid());
+                        #endif
 
-                            push_com_edge(external_com, e);
-                            ++intra_edgeSorter;
+                        #pragma omp critical (_edgeSorter)
+                        for (node_t u = 0; !node_id_reader.empty(); ++u, ++node_id_reader) {
+                            while (!intra_edgeSorter.empty() && intra_edgeSorter->first == u) {
+                                edge_t e(intra_edgeSorter->second, *node_id_reader);
+                                e.normalize();
+
+                                #ifndef NDEBUG
+                                assert(e != last_e);
+                                assert(!e.is_loop());
+                                last_e = e;
+                                #endif
+
+                                push_com_edge(external_com, e);
+                                ++intra_edgeSorter;
+                            }
                         }
                     }
+                };
+
+                if (_community_randomisation == curveball) {
+                    HavelHakimiIMGeneratorWithDegrees gen(HavelHakimiIMGeneratorWithDegrees::DecreasingDegree);
+                    generate_community(gen);
+                } else {
+                    HavelHakimiIMGenerator gen(HavelHakimiIMGenerator::DecreasingDegree);
+                    generate_community(gen);
                 }
             }
         }
@@ -210,131 +322,135 @@ namespace LFR {
                     continue; // no edges to create
                 }
 
-                int_t degree_sum = 0;
-                uint_t available_memory = memory_per_thread;
-
-                #ifdef CURVEBALL_RAND
-                HavelHakimiIMGeneratorWithDegrees gen(HavelHakimiIMGeneratorWithDegrees::DecreasingDegree);
-                #else
-                HavelHakimiIMGenerator gen(HavelHakimiIMGenerator::DecreasingDegree);
-                #endif
-
-                available_memory -= (com_size * 2 * sizeof(node_t));
-                node_ids.reserve(static_cast<size_t>(com_size));
-                node_degrees.reserve(static_cast<size_t>(com_size));
-
-                #pragma omp critical (_community_assignment)
-                for (auto it(_community_assignments.cbegin() + _community_cumulative_sizes[com]);
-                     it < _community_assignments.cbegin() + _community_cumulative_sizes[com+1];
-                     ++it)
-                {
-                    const auto ca = *it;
-                    assert(ca.community_id == com);
-                    node_degrees.push_back(ca.degree);
-                    degree_sum += ca.degree;
-                    assert(node_ids.empty() || node_ids.back() != ca.node_id);
-                    node_ids.push_back(ca.node_id);
-                    gen.push(ca.degree);
-                }
-
-                gen.generate();
-
-                std::cout << "internalNodes: " << 1 << " "
-                          << "memoryEstimate: " << IMGraph::memoryUsage(com_size, degree_sum / 2) << " "
-                          << "memoryAvail: " << available_memory << " "
-                          << "degreeSum: " << degree_sum/2 << " "
-                          << "maxEdges: " << IMGraph::maxEdges()
-                          << std::endl;
-
-
-                if (IMGraph::memoryUsage(com_size, degree_sum / 2) < available_memory && degree_sum / 2 < IMGraph::maxEdges()) {
-                    IMGraph graph(node_degrees);
-                    while (!gen.empty()) {
-                        graph.addEdge(*gen);
-                        ++gen;
+                // the generator additionally reports the realised degrees if Curveball needs them
+                auto generate_community = [&] (auto & gen) {
+                    int_t degree_sum = 0;
+                    uint_t available_memory = memory_per_thread;
+
+                    available_memory -= (com_size * 2 * sizeof(node_t));
+                    node_ids.reserve(static_cast<size_t>(com_size));
+                    node_degrees.reserve(static_cast<size_t>(com_size));
+
+                    #pragma omp critical (_community_assignment)
+                    for (auto it(_community_assignments.cbegin() + _community_cumulative_sizes[com]);
+                         it < _community_assignments.cbegin() + _community_cumulative_sizes[com+1];
+                         ++it)
+                    {
+                        const auto ca = *it;
+                        assert(ca.community_id == com);
+                        node_degrees.push_back(ca.degree);
+                        degree_sum += ca.degree;
+                        assert(node_ids.empty() || node_ids.back() != ca.node_id);
+                        node_ids.push_back(ca.node_id);
+                        gen.push(ca.degree);
                     }
 
-                    STXXL_MSG("Running internal swaps with " << graph.numEdges() << " edges");
+                    gen.generate();
+
+                    std::cout << "internalNodes: " << 1 << " "
+                              << "memoryEstimate: " << CompactIMGraph::memoryUsage(com_size, degree_sum / 2) << " "
+                              << "memoryAvail: " << available_memory << " "
+                              << "degreeSum: " << degree_sum/2 << " "
+                              << "maxEdges: " << CompactIMGraph::maxEdges()
+                              << std::endl;
 
-                    if (graph.numEdges() > 1) {
-                        // Generate swaps
-                        uint_t numSwaps = 10*graph.numEdges();
 
-                        IMEdgeSwap swapAlgo(graph);
-                        for (SwapGenerator swapGen(numSwaps, graph.numEdges(), RandomSeed::get_instance().get_seed(com)); !swapGen.empty(); ++swapGen) {
-                            swapAlgo.push(*swapGen);
+                    // communities are randomised by internal memory swaps unless Curveball is requested
+                    if (_community_randomisation != curveball
+                        && CompactIMGraph::memoryUsage(com_size, degree_sum / 2) < available_memory
+                        && degree_sum / 2 < CompactIMGraph::maxEdges()) {
+                        CompactIMGraph graph(node_degrees);
+                        while (!gen.empty()) {
+                            graph.addEdge(*gen);
+                            ++gen;
                         }
 
-                        swapAlgo.run();
-                    }
+                        STXXL_MSG("Running internal swaps with " << graph.numEdges() << " edges");
 
-                    #ifndef NDEBUG
-                    edge_t last_e(edge_t::invalid());
-                    #endif
+                        if (graph.numEdges() > 1) {
+                            // Generate swaps
+                            uint_t numSwaps = 10*graph.numEdges();
 
-                    #pragma omp critical (_edgeSorter)
-                    for (auto it = graph.getEdges(); !it.empty(); ++it) {
-                        edge_t e = {node_ids[it->first], node_ids[it->second]};
-                        e.normalize();
+                            for (SwapGenerator swapGen(numSwaps, graph.numEdges(), RandomSeed::get_instance().get_seed(com)); !swapGen.empty(); ++swapGen) {
+                                const auto & swap = *swapGen;
+                                graph.swapEdges(swap.edges()[0], swap.edges()[1], swap.direction());
+                            }
+                        }
 
                         #ifndef NDEBUG
-                        assert(e != last_e);
-                        assert(!e.is_loop());
-                        last_e = e;
+                        edge_t last_e(edge_t::invalid());
                         #endif
 
-                        push_com_edge(com, e);
-                    }
-                } else {
-                    EdgeStream intra_edges;
+                        #pragma omp critical (_edgeSorter)
+                        for (auto it = graph.getEdges(); !it.empty(); ++it) {
+                            edge_t e = {node_ids[it->first], node_ids[it->second]};
+                            e.normalize();
 
-                    for (; !gen.empty(); ++gen) {
-                        assert(gen->first < gen->second);
-                        intra_edges.push(*gen);
-                    }
+                            #ifndef NDEBUG
+                            assert(e != last_e);
+                            assert(!e.is_loop());
+                            last_e = e;
+                            #endif
 
-                    intra_edges.consume();
+                            push_com_edge(com, e);
+                        }
+                    } else {
+                        EdgeStream intra_edges;
+
+                        for (; !gen.empty(); ++gen) {
+                            assert(gen->first < gen->second);
+                            intra_edges.push(*gen);
+                        }
 
-                    #ifdef CURVEBALL_RAND
-                    gen.finalize();
-                    auto & realised_degrees = gen.get_degree_stream();
-                    realised_degrees.rewind();
-                    assert(realised_degrees.size() == static_cast<size_t>(com_size));
+                        intra_edges.consume();
 
-                    using CurveballType = Curveball::EMCurveball<Curveball::ModHash, decltype(realised_degrees)>;
-                    CurveballType randAlgo(intra_edges,
-                                           realised_degrees,
-                                           com_size,
-                                           20,
-                                           intra_edges,
-                                           1,
-                                           _max_memory_usage,
-                                           true);
-                    randAlgo.run();
-                    #else
-                    // Generate swaps
-                    uint_t numSwaps = 10 * intra_edges.size();
-                    SwapGenerator swap_gen(numSwaps, intra_edges.size(), RandomSeed::get_instance().get_seed(com));
+                        if (_community_randomisation == curveball) {
+                            gen.finalize();
+                            auto & realised_degrees = gen.get_degree_stream();
+                            realised_degrees.rewind();
+                            assert(realised_degrees.size() == static_cast<size_t>(com_size));
 
-                    uint_t run_length = intra_edges.size() / 8;
+                            randomise_with_curveball(intra_edges, realised_degrees, com_size,
+                                                     1, available_memory, intra_edges, true);
+                        } else {
+                            // Generate swaps
+                            uint_t numSwaps = 10 * intra_edges.size();
+                            SwapGenerator swap_gen(numSwaps, intra_edges.size(), RandomSeed::get_instance().get_seed(com));
 
-                    // perform swaps
-                    EdgeSwapTFP::EdgeSwapTFP swap_algo(intra_edges, run_length, _number_of_nodes, memory_per_thread);
+                            // perform swaps
+                            SwapConvergenceMonitor monitor(com_size, _swap_convergence);
+                            const EdgeSwapInstance instance(intra_edges.size(), com_size, numSwaps, memory_per_thread, 1);
+                            EdgeSwapFactory::ProcessSwapCallback callback;
+                            if (_swap_convergence.enabled()) {
+                                monitor.observe(intra_edges);
+                                callback = [&](uint_t) {monitor.observe(intra_edges);};
+                            }
 
-                    StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
+                            auto swap_algo = EdgeSwapFactory().create(intra_edges, instance, callback);
 
-                    swap_algo.run();
-                    #endif
+                            monitor.pushSwaps(swap_gen, *swap_algo);
 
-                    intra_edges.rewind();
+                            swap_algo->run();
+                        }
+
+                        intra_edges.rewind();
 
-                    #pragma omp critical (_edgeSorter)
-                    while (!intra_edges.empty()) {
-                        edge_t e = {node_ids[intra_edges->first], node_ids[intra_edges->second]};
-                        e.normalize();
-                        push_com_edge(com, e);
-                        ++intra_edges;
+                        #pragma omp critical (_edgeSorter)
+                        while (!intra_edges.empty()) {
+                            edge_t e = {node_ids[intra_edges->first], node_ids[intra_edges->second]};
+                            e.normalize();
+                            push_com_edge(com, e);
+                            ++intra_edges;
+                        }
                     }
+                };
+
+                if (_community_randomisation == curveball) {
+                    HavelHakimiIMGeneratorWithDegrees gen(HavelHakimiIMGeneratorWithDegrees::DecreasingDegree);
+                    generate_community(gen);
+                } else {
+                    HavelHakimiIMGenerator gen(HavelHakimiIMGenerator::DecreasingDegree);
+                    generate_community(gen);
                 }
             }
         }
@@ -359,7 +475,8 @@ namespace LFR {
                 writer.finish();
             }
 
-            CommunityEdgeRewiringSwaps rewiringSwaps(intra_com_edges, _intra_community_edges.size() / 3, _community_rewiring_random);
+            CommunityEdgeRewiringSwaps rewiringSwaps(intra_com_edges, intra_com_edges.size() / 3, _community_rewiring_random,
+                                                     _community_rewiring_per_community);
             rewiringSwaps.run();
 
             for (stxxl::vector<CommunityEdge>::bufreader_type reader(intra_com_edges); !reader.empty(); ++reader) {
@@ -0,0 +1,454 @@
+#include "LFR.h"
+#include "GlobalRewiringSwapGenerator.h"
+#include <HavelHakimi/DirectedHavelHakimiGenerator.h>
+#include <EdgeSwaps/EdgeSwapTFP.h>
+#include <EdgeSwaps/SemiLoadedEdgeSwapTFP.h>
+#include <EdgeSwaps/EdgeSwapFactory.h>
+#include <SwapGenerator.h>
+#include <GenericComparator.h>
+#include <Utils/IOStatistics.h>
+#include <Utils/RandomSeed.h>
+#include <Utils/StreamPusher.h>
+
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+
+namespace LFR {
+    namespace {
+        //! Rough upper bound on the internal memory of a community with the in-memory swaps below
+        constexpr uint_t directed_im_bytes_per_edge = 64;
+
+        uint64_t directed_edge_key(const edge_t & e) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(e.first)) << 32) | static_cast<uint32_t>(e.second);
+        }
+
+        //! Edge swaps of directed edges in internal memory; the edges are sorted afterwards
+        void randomise_directed_edges(std::vector<edge_t> & edges, seed_t seed) {
+            if (edges.size() < 2)
+                return;
+
+            std::unordered_set<uint64_t> existing;
+            existing.reserve(edges.size());
+            for (const auto & e : edges)
+                existing.insert(directed_edge_key(e));
+
+            for (SwapGenerator swap_gen(10 * edges.size(), edges.size(), seed); !swap_gen.empty(); ++swap_gen) {
+                edge_t & e0 = edges[swap_gen->edges()[0]];
+                edge_t & e1 = edges[swap_gen->edges()[1]];
+
+                const edge_t t0 {e0.first, e1.second};
+                const edge_t t1 {e1.first, e0.second};
+
+                if (t0.is_loop() || t1.is_loop() || existing.count(directed_edge_key(t0)) || existing.count(directed_edge_key(t1)))
+                    continue;
+
+                existing.erase(directed_edge_key(e0));
+                existing.erase(directed_edge_key(e1));
+                existing.insert(directed_edge_key(t0));
+                existing.insert(directed_edge_key(t1));
+                e0 = t0;
+                e1 = t1;
+            }
+
+            std::sort(edges.begin(), edges.end());
+        }
+
+        //! Reduces the larger of the intra-community degree sums such that both are equal.
+        //! The stubs removed are added to the external degrees, as those are derived from the realised intra-community edges.
+        void balance_directed_degrees(std::vector<degree_t> & in_degrees, std::vector<degree_t> & out_degrees) {
+            const edgeid_t in_sum = std::accumulate(in_degrees.begin(), in_degrees.end(), edgeid_t(0));
+            const edgeid_t out_sum = std::accumulate(out_degrees.begin(), out_degrees.end(), edgeid_t(0));
+
+            auto & degrees = (in_sum > out_sum) ? in_degrees : out_degrees;
+            edgeid_t excess = std::abs(in_sum - out_sum);
+
+            // nodes are sorted by decreasing degree, so the largest degrees are reduced first
+            while (excess > 0) {
+                for (auto it = degrees.begin(); it != degrees.end() && excess > 0; ++it) {
+                    if (*it > 0) {
+                        --*it;
+                        --excess;
+                    }
+                }
+            }
+        }
+    }
+
+    void LFR::_compute_directed_node_distributions() {
+        if (std::max(_degree_distribution_params.maxDegree, _out_degree_distribution_params.maxDegree) * (1.0 - _mixing) >=
+            _community_distribution_params.maxDegree) {
+            throw std::runtime_error("Error, the maximum community is too small to fit the node of the highest degree.");
+        }
+
+        const seed_t in_seed = RandomSeed::get_instance().get_next_seed();
+        std::mt19937_64 generator(RandomSeed::get_instance().get_next_seed());
+        std::uniform_real_distribution<double> fdis;
+
+        // the in-degrees are monotonic; pair them with the out-degrees in random order
+        using key_degree_t = std::pair<uint64_t, degree_t>;
+        using key_degree_comparator_t = GenericComparator<key_degree_t>::Ascending;
+        stxxl::sorter<key_degree_t, key_degree_comparator_t> out_degrees(key_degree_comparator_t(), SORTER_MEM);
+
+        edgeid_t out_sum = 0;
+        for (NodeDegreeDistribution odd(_out_degree_distribution_params, RandomSeed::get_instance().get_next_seed()); !odd.empty(); ++odd) {
+            out_degrees.push({generator(), *odd});
+            out_sum += *odd;
+        }
+        out_degrees.sort();
+
+        edgeid_t in_sum = 0;
+        for (NodeDegreeDistribution idd(_degree_distribution_params, in_seed); !idd.empty(); ++idd)
+            in_sum += *idd;
+
+        assert(static_cast<node_t>(out_degrees.size()) == _number_of_nodes);
+
+        // the sums of in- and out-degrees have to match; the difference is spread evenly over all nodes
+        const edgeid_t diff = in_sum - out_sum;
+        const edgeid_t diff_quot = std::abs(diff) / _number_of_nodes;
+        const edgeid_t diff_rem = std::abs(diff) % _number_of_nodes;
+
+        auto split = [&] (degree_t degree) {
+            double external = degree * _mixing;
+            const degree_t floor = static_cast<degree_t>(external);
+            return degree - floor - (fdis(generator) < external - floor);
+        };
+
+        stxxl::sorter<DirectedNodeDegree, DirectedNodeDegreeComparator> degree_sorter(DirectedNodeDegreeComparator(_mixing), SORTER_MEM);
+
+        NodeDegreeDistribution idd(_degree_distribution_params, in_seed);
+        for (edgeid_t i = 0; i < _number_of_nodes; ++i, ++idd, ++out_degrees) {
+            assert(!idd.empty());
+            const degree_t extra = static_cast<degree_t>(diff_quot + ((i + 1) * diff_rem) / _number_of_nodes - (i * diff_rem) / _number_of_nodes);
+
+            const degree_t in_degree = *idd + (diff < 0) * extra;
+            const degree_t out_degree = out_degrees->second + (diff > 0) * extra;
+
+            degree_sorter.push(DirectedNodeDegree(in_degree, out_degree, split(in_degree), split(out_degree)));
+        }
+
+        degree_sorter.sort();
+
+        // node ids correspond to the order of the node sorter
+        _directed_degrees.clear();
+        _directed_degrees.resize(degree_sorter.size());
+        {
+            stxxl::vector<DirectedNodeDegree>::bufwriter_type writer(_directed_degrees);
+            for (; !degree_sorter.empty(); ++degree_sorter) {
+                _node_sorter.push(degree_sorter->membership());
+                writer << *degree_sorter;
+            }
+            writer.finish();
+        }
+
+        _node_sorter.sort();
+
+        _degree_sum = 2 * std::max(in_sum, out_sum);
+        _overlap_max_memberships = 1;
+
+        std::cout << "In-degree sum: " << in_sum << " Out-degree sum: " << out_sum << "\n";
+    }
+
+    void LFR::_generate_directed_community_graphs() {
+        // intra-community degrees in the order of _community_assignments
+        using degree_pair_t = std::pair<degree_t, degree_t>;
+        stxxl::vector<degree_pair_t> intra_degrees(_community_assignments.size());
+        {
+            using node_pos_t = std::pair<node_t, edgeid_t>;
+            stxxl::sorter<node_pos_t, GenericComparator<node_pos_t>::Ascending> node_sorter(GenericComparator<node_pos_t>::Ascending(), SORTER_MEM);
+
+            edgeid_t pos = 0;
+            for (stxxl::vector<CommunityAssignment>::bufreader_type reader(_community_assignments); !reader.empty(); ++reader, ++pos)
+                node_sorter.push({reader->node_id, pos});
+            node_sorter.sort();
+
+            using pos_degrees_t = std::pair<edgeid_t, degree_pair_t>;
+            stxxl::sorter<pos_degrees_t, GenericComparator<pos_degrees_t>::Ascending> pos_sorter(GenericComparator<pos_degrees_t>::Ascending(), SORTER_MEM);
+
+            stxxl::vector<DirectedNodeDegree>::bufreader_type degree_reader(_directed_degrees);
+            for (node_t u = 0; !node_sorter.empty(); ++node_sorter) {
+                for (; u < node_sorter->first; ++u, ++degree_reader);
+                pos_sorter.push({node_sorter->second, {degree_reader->intra_in_degree, degree_reader->intra_out_degree}});
+            }
+            pos_sorter.sort();
+
+            stxxl::vector<degree_pair_t>::bufwriter_type writer(intra_degrees);
+            for (; !pos_sorter.empty(); ++pos_sorter)
+                writer << pos_sorter->second;
+            writer.finish();
+        }
+
+        stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending> edgeSorter(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
+
+        const auto n_threads = static_cast<uint_t>(omp_get_max_threads());
+        const uint_t memory_per_thread = _max_memory_usage / n_threads;
+        const uint_t internal_com_size_limit = memory_per_thread / 10;
+
+        auto generate_community = [&] (community_t com, uint_t available_memory, int num_threads) {
+            const node_t com_size = _community_size(com);
+            if (com_size < 2)
+                return;
+
+            std::vector<node_t> node_ids;
+            std::vector<degree_t> in_degrees;
+            std::vector<degree_t> out_degrees;
+            node_ids.reserve(com_size);
+            in_degrees.reserve(com_size);
+            out_degrees.reserve(com_size);
+
+            #pragma omp critical (_community_assignment)
+            {
+                auto degree_it = intra_degrees.cbegin() + _community_cumulative_sizes[com];
+                for (auto it(_community_assignments.cbegin() + _community_cumulative_sizes[com]);
+                     it < _community_assignments.cbegin() + _community_cumulative_sizes[com + 1];
+                     ++it, ++degree_it)
+                {
+                    const auto ca = *it;
+                    assert(ca.community_id == com);
+                    const auto degrees = *degree_it;
+                    node_ids.push_back(ca.node_id);
+                    in_degrees.push_back(std::min<degree_t>(degrees.first, com_size - 1));
+                    out_degrees.push_back(std::min<degree_t>(degrees.second, com_size - 1));
+                }
+            }
+
+            balance_directed_degrees(in_degrees, out_degrees);
+            const edgeid_t num_edges = std::accumulate(in_degrees.begin(), in_degrees.end(), edgeid_t(0));
+
+            DirectedHavelHakimiGenerator gen;
+            for (node_t u = 0; u < com_size; ++u)
+                gen.push(in_degrees[u], out_degrees[u]);
+            gen.generate();
+
+            if (static_cast<uint_t>(num_edges) * directed_im_bytes_per_edge < available_memory) {
+                std::vector<edge_t> edges;
+                edges.reserve(num_edges);
+                for (; !gen.empty(); ++gen)
+                    edges.push_back(*gen);
+
+                randomise_directed_edges(edges, RandomSeed::get_instance().get_seed(com));
+
+                #pragma omp critical (_edgeSorter)
+                for (const auto & e : edges)
+                    edgeSorter.push({node_ids[e.first], node_ids[e.second]});
+
+            } else {
+                EdgeStream intra_edges;
+                for (; !gen.empty(); ++gen)
+                    intra_edges.push(*gen);
+                intra_edges.consume();
+
+                if (intra_edges.size() > 1) {
+                    const uint_t numSwaps = 10 * intra_edges.size();
+                    const EdgeSwapInstance instance(intra_edges.size(), com_size, numSwaps, available_memory, num_threads);
+                    const swapid_t run_length = EdgeSwapFactory::withRunLength(EdgeSwapAlgorithm::TFP, instance).run_length;
+
+                    STXXL_MSG("Swapping directed community " << com << " with " << intra_edges.size() << " edges in external memory");
+
+                    EdgeSwapTFP::DirectedEdgeSwapTFP swap_algo(intra_edges, run_length, com_size, available_memory);
+                    for (SwapGenerator swap_gen(numSwaps, intra_edges.size(), RandomSeed::get_instance().get_seed(com)); !swap_gen.empty(); ++swap_gen)
+                        swap_algo.push(*swap_gen);
+                    swap_algo.run();
+                }
+
+                intra_edges.rewind();
+
+                #pragma omp critical (_edgeSorter)
+                for (; !intra_edges.empty(); ++intra_edges)
+                    edgeSorter.push({node_ids[intra_edges->first], node_ids[intra_edges->second]});
+            }
+
+            if (gen.unsatisfiedDegree()) {
+                STXXL_MSG("Community " << com << " misses " << gen.unsatisfiedDegree() << " edges of the directed Havel-Hakimi materialisation");
+            }
+        };
+
+        const community_t number_of_communities = static_cast<community_t>(_community_cumulative_sizes.size()) - 1;
+
+        // large communities one after another with all memory and possibly external memory swaps
+        community_t external_com = 0;
+        for (; external_com < number_of_communities; ++external_com) {
+            if (_community_size(external_com) * 2 * sizeof(node_t) < internal_com_size_limit)
+                break;
+
+            generate_community(external_com, _max_memory_usage, static_cast<int>(n_threads));
+        }
+
+        // small communities in parallel
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(n_threads)
+        for (community_t com = external_com; com < number_of_communities; ++com) {
+            generate_community(com, memory_per_thread, 1);
+        }
+
+        edgeSorter.sort();
+
+        _intra_community_edges.clear();
+        StreamPusher<decltype(edgeSorter), decltype(_intra_community_edges)> (edgeSorter, _intra_community_edges);
+        _intra_community_edges.consume();
+    }
+
+    void LFR::_generate_directed_global_graph(int_t globalSwapsPerIteration) {
+        {
+            IOStatistics ios("GlobalGenDirectedStubMatching");
+
+            // the external degrees are those not realised within the communities
+            stxxl::sorter<node_t, GenericComparator<node_t>::Ascending> intra_targets(GenericComparator<node_t>::Ascending(), SORTER_MEM);
+            for (_intra_community_edges.rewind(); !_intra_community_edges.empty(); ++_intra_community_edges)
+                intra_targets.push(_intra_community_edges->second);
+            intra_targets.sort();
+            _intra_community_edges.rewind();
+
+            // matching the out-stubs with the in-stubs, both in random order, yields a random digraph
+            using key_node_t = std::pair<uint64_t, node_t>;
+            using key_node_comparator_t = GenericComparator<key_node_t>::Ascending;
+            stxxl::sorter<key_node_t, key_node_comparator_t> out_stubs(key_node_comparator_t(), SORTER_MEM);
+            stxxl::sorter<key_node_t, key_node_comparator_t> in_stubs(key_node_comparator_t(), SORTER_MEM);
+
+            std::mt19937_64 generator(RandomSeed::get_instance().get_next_seed());
+
+            node_t u = 0;
+            for (stxxl::vector<DirectedNodeDegree>::bufreader_type reader(_directed_degrees); !reader.empty(); ++reader, ++u) {
+                degree_t intra_out = 0;
+                for (; !_intra_community_edges.empty() && _intra_community_edges->first == u; ++_intra_community_edges)
+                    ++intra_out;
+
+                degree_t intra_in = 0;
+                for (; !intra_targets.empty() && *intra_targets == u; ++intra_targets)
+                    ++intra_in;
+
+                assert(intra_out <= reader->out_degree && intra_in <= reader->in_degree);
+
+                for (degree_t i = intra_out; i < reader->out_degree; ++i)
+                    out_stubs.push({generator(), u});
+
+                for (degree_t i = intra_in; i < reader->in_degree; ++i)
+                    in_stubs.push({generator(), u});
+            }
+
+            _intra_community_edges.rewind();
+
+            assert(out_stubs.size() == in_stubs.size());
+            out_stubs.sort();
+            in_stubs.sort();
+
+            // self-loops and multi-edges are rejected as the rewiring below cannot resolve them;
+            // as in CommunityStubMatching, the stubs of rejected edges are shuffled and matched
+            // again until a round makes no progress, the remaining ones are dropped
+            constexpr unsigned int max_rounds = 32;
+
+            _inter_community_edges.clear();
+            _inter_community_edges.consume();
+
+            for (unsigned int round = 0; round < max_rounds && !out_stubs.empty(); ++round) {
+                const uint_t stubs = out_stubs.size();
+
+                using edge_sorter_t = stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending>;
+                edge_sorter_t candidates(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
+                for (; !out_stubs.empty() && !in_stubs.empty(); ++out_stubs, ++in_stubs)
+                    candidates.push({out_stubs->second, in_stubs->second});
+                candidates.sort();
+
+                out_stubs.clear();
+                in_stubs.clear();
+
+                // reject loops and edges matched twice or in an earlier round
+                edge_sorter_t accepted_round(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
+                {
+                    _inter_community_edges.rewind();
+
+                    edge_t last_edge = edge_t::invalid();
+                    for (; !candidates.empty(); ++candidates) {
+                        const edge_t e = *candidates;
+
+                        while (!_inter_community_edges.empty() && *_inter_community_edges < e)
+                            ++_inter_community_edges;
+
+                        if (e.is_loop() || e == last_edge
+                            || (!_inter_community_edges.empty() && *_inter_community_edges == e)) {
+                            out_stubs.push({generator(), e.first});
+                            in_stubs.push({generator(), e.second});
+                            continue;
+                        }
+
+                        accepted_round.push(e);
+                        last_edge = e;
+                    }
+                }
+                accepted_round.sort();
+
+                // merge edges accepted in this round into the previously accepted ones
+                {
+                    EdgeStream merged_edges;
+
+                    _inter_community_edges.rewind();
+                    while (!_inter_community_edges.empty() || !accepted_round.empty()) {
+                        if (!accepted_round.empty() && (_inter_community_edges.empty() || *accepted_round < *_inter_community_edges)) {
+                            merged_edges.push(*accepted_round);
+                            ++accepted_round;
+                        } else {
+                            merged_edges.push(*_inter_community_edges);
+                            ++_inter_community_edges;
+                        }
+                    }
+
+                    merged_edges.consume();
+                    _inter_community_edges = std::move(merged_edges);
+                }
+
+                out_stubs.sort();
+                in_stubs.sort();
+
+                std::cout << "Directed global stub matching round " << round
+                          << " stubs: " << stubs
+                          << " left: " << out_stubs.size()
+                          << " edges: " << _inter_community_edges.size()
+                          << std::endl;
+
+                if (out_stubs.size() >= stubs)
+                    break;
+            }
+
+            _inter_community_edges.rewind();
+
+            std::cout << "Dropped " << out_stubs.size() << " unmatched stub pairs of the global graph" << std::endl;
+        }
+
+        if (_inter_community_edges.size() < 2)
+            return;
+
+        IOStatistics ios("GlobalGenRewire");
+
+        // rewiring in order to not to generate new intra-community edges
+        EdgeSwapTFP::DirectedSemiLoadedEdgeSwapTFP swapAlgo(_inter_community_edges, globalSwapsPerIteration, _number_of_nodes, _max_memory_usage);
+
+        GlobalRewiringSwapGenerator rewiringSwapGenerator(_community_assignments, _inter_community_edges.size(), RandomSeed::get_instance().get_next_seed());
+        _inter_community_edges.rewind();
+        rewiringSwapGenerator.pushEdges(_inter_community_edges);
+        _inter_community_edges.rewind();
+        rewiringSwapGenerator.generate();
+
+        swapAlgo.setUpdatedEdgesCallback([&rewiringSwapGenerator](EdgeSwapTFP::SemiLoadedEdgeSwapTFP::edge_update_sorter_t &updatedEdges) {
+            rewiringSwapGenerator.pushEdges(updatedEdges);
+        });
+
+        while (!rewiringSwapGenerator.empty()) {
+            int_t numSwaps = 0;
+            while (!rewiringSwapGenerator.empty()) {
+                swapAlgo.push(*rewiringSwapGenerator);
+                ++numSwaps;
+                ++rewiringSwapGenerator;
+            }
+
+            if (numSwaps > 0) {
+                STXXL_MSG("Executing directed global rewiring phase with " << numSwaps << " swaps.");
+
+                swapAlgo.process_swaps(); // this triggers the callback and thus pushes new edges in the generator
+                rewiringSwapGenerator.generate();
+            }
+        }
+
+        // flush any swaps that have not been processed yet, writes edges vector
+        swapAlgo.run();
+    }
+}
@@ -2,8 +2,10 @@
 
 #include "LFR.h"
 #include "GlobalRewiringSwapGenerator.h"
+#include "CommunityStubMatching.h"
 #include <HavelHakimi/HavelHakimiIMGenerator.h>
 #include <EdgeSwaps/SemiLoadedEdgeSwapTFP.h>
+#include <EdgeSwaps/ParallelIMEdgeSwap.h>
 #include <Utils/AsyncStream.h>
 #include <Utils/IOStatistics.h>
 #include <SwapGenerator.h>
@@ -12,10 +14,8 @@
 #include <Utils/RandomSeed.h>
 
 namespace LFR {
-    void LFR::_generate_global_graph(int_t globalSwapsPerIteration) {
-        #ifdef CURVEBALL_RAND
-        HavelHakimiIMGeneratorWithDeficits gen(HavelHakimiIMGeneratorWithDeficits::DecreasingDegree);
-        DegreeStream temp_rewindable_ext_degrees;
+    namespace {
+        //! Degree stream of the external degrees reduced by the deficits of the Havel-Hakimi materialisation
         class FixedDegreeStreamWrapper {
         protected:
             DegreeStream & _unrealisable_degrees;
@@ -62,110 +62,134 @@ namespace LFR {
                 }
             }
         };
-        #else
-        HavelHakimiIMGenerator gen(HavelHakimiIMGenerator::DecreasingDegree);
-        #endif
-        {
-            using deg_node_t = std::pair<degree_t, node_t>;
-            stxxl::sorter<deg_node_t, GenericComparator<deg_node_t>::Descending> extDegree(GenericComparator<deg_node_t>::Descending(), SORTER_MEM);
+    }
 
-            int_t degree_sum = 0;
+    void LFR::_generate_global_graph(int_t globalSwapsPerIteration) {
+        const bool use_curveball = (_global_randomisation == curveball);
 
-            { // push node degrees in descending order in generator
-                _node_sorter.rewind();
+        // Curveball needs the degrees actually realised by the Havel-Hakimi materialisation
+        DegreeStream temp_rewindable_ext_degrees;
+        std::vector<std::pair<node_t, degree_t>> deficits;
 
-                for(node_t nid = 0; !_node_sorter.empty(); ++_node_sorter, ++nid) {
-                    extDegree.push({_node_sorter->externalDegree(_mixing), nid});
-                    #ifdef CURVEBALL_RAND
-                    temp_rewindable_ext_degrees.push(_node_sorter->externalDegree(_mixing));
-                    #endif
-                }
+        auto materialise = [&] (auto & gen) {
+            {
+                using deg_node_t = std::pair<degree_t, node_t>;
+                stxxl::sorter<deg_node_t, GenericComparator<deg_node_t>::Descending> extDegree(GenericComparator<deg_node_t>::Descending(), SORTER_MEM);
 
-                extDegree.sort();
+                int_t degree_sum = 0;
 
-                while (!extDegree.empty()) {
-                    degree_t deg = (*extDegree).first;
-                    gen.push(deg);
-                    degree_sum += deg;
-                    ++extDegree;
-                }
-            }
+                { // push node degrees in descending order in generator
+                    _node_sorter.rewind();
 
-            gen.generate();
-
-            // FIXME: This is only necessary, if nodes are not sorted by externalDegree (which happens if we apply ceiling!)
-            // We may change the ceiling scheme to avoid it. For the moment, this is the more general solution
+                    for(node_t nid = 0; !_node_sorter.empty(); ++_node_sorter, ++nid) {
+                        extDegree.push({_node_sorter->externalDegree(_mixing), nid});
+                        if (use_curveball)
+                            temp_rewindable_ext_degrees.push(_node_sorter->externalDegree(_mixing));
+                    }
 
-            // translate target node id's
-            // the sorter is in the outer scope as it is needed for longer
-            stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending> edge_sorter2(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
+                    extDegree.sort();
 
-            {
-                // translate source node id's
-                stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending> edge_sorter1(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
-
-                extDegree.rewind();
-                for (node_t i = 0; !gen.empty(); ++gen) {
-                    const edge_t & orig_edge = *gen;
-
-                    // this for loop only does something if the current run of nodes,
-                    // which was i to this point is no longer i, when that run ends,
-                    // we have to forward the external degree stream until we hit the
-                    // next node of the next run
-                    for (; i < orig_edge.first; ++extDegree, ++i);
-
-                    // the first entry of the generated Havel-Hakimi edge not necessarily
-                    // matches the second entry of the current external degree stream, since
-                    // it was sorted previously and just mapped 1-1 starting from 0,
-                    // additionally it may not have the same degree, in a Havel-Hakimi
-                    // materialisation unsatisfied nodes and edges can occur
-                    edge_sorter1.push({orig_edge.second, (*extDegree).second});
+                    while (!extDegree.empty()) {
+                        degree_t deg = (*extDegree).first;
+                        gen.push(deg);
+                        degree_sum += deg;
+                        ++extDegree;
+                    }
                 }
 
-                edge_sorter1.sort();
-                extDegree.rewind();
+                gen.generate();
+
+                // FIXME: This is only necessary, if nodes are not sorted by externalDegree (which happens if we apply ceiling!)
+                // We may change the ceiling scheme to avoid it. For the moment, this is the more general solution
 
-                #ifdef CURVEBALL_RAND
-                assert(gen.unsatisfiedNodes() == static_cast<node_t>(gen.get_deficits().size()));
+                // translate target node id's
+                // the sorter is in the outer scope as it is needed for longer
+                stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending> edge_sorter2(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
 
-                bool check_deficits = (gen.unsatisfiedNodes() > 0);
-                auto & deficits = gen.get_deficits();
-                auto deficits_it = deficits.begin();
-                for (node_t i = 0; !edge_sorter1.empty(); ++edge_sorter1) {
-                    const edge_t &orig_edge = *edge_sorter1;
-                    for (; i < orig_edge.first; ++extDegree, ++i);
+                {
+                    // translate source node id's
+                    stxxl::sorter<edge_t, GenericComparator<edge_t>::Ascending> edge_sorter1(GenericComparator<edge_t>::Ascending(), SORTER_MEM);
 
-                    if (check_deficits) {
-                        auto & node_deficit_pair = *deficits_it;
-                        if (UNLIKELY(i == node_deficit_pair.first)) {
-                            node_deficit_pair.first = (*extDegree).second;
-                            assert(node_deficit_pair.first == (*extDegree).second);
+                    extDegree.rewind();
+                    for (node_t i = 0; !gen.empty(); ++gen) {
+                        const edge_t & orig_edge = *gen;
 
-                            ++deficits_it;
-                            if (deficits_it == deficits.end())
-                                check_deficits = false;
+                        // this for loop only does something if the current run of nodes,
+                        // which was i to this point is no longer i, when that run ends,
+                        // we have to forward the external degree stream until we hit the
+                        // next node of the next run
+                        for (; i < orig_edge.first; ++extDegree, ++i);
+
+                        // the first entry of the generated Havel-Hakimi edge not necessarily
+                        // matches the second entry of the current external degree stream, since
+                        // it was sorted previously and just mapped 1-1 starting from 0,
+                        // additionally it may not have the same degree, in a Havel-Hakimi
+                        // materialisation unsatisfied nodes and edges can occur
+                        edge_sorter1.push({orig_edge.second, (*extDegree).second});
+                    }
+
+                    edge_sorter1.sort();
+                    extDegree.rewind();
+
+                    // only the generator used for Curveball records deficits
+                    assert(!use_curveball || gen.unsatisfiedNodes() == static_cast<node_t>(gen.get_deficits().size()));
+
+                    bool check_deficits = use_curveball && (gen.unsatisfiedNodes() > 0);
+                    auto & gen_deficits = gen.get_deficits();
+                    auto deficits_it = gen_deficits.begin();
+                    for (node_t i = 0; !edge_sorter1.empty(); ++edge_sorter1) {
+                        const edge_t &orig_edge = *edge_sorter1;
+                        for (; i < orig_edge.first; ++extDegree, ++i);
+
+                        if (check_deficits) {
+                            auto & node_deficit_pair = *deficits_it;
+                            if (UNLIKELY(i == node_deficit_pair.first)) {
+                                node_deficit_pair.first = (*extDegree).second;
+                                assert(node_deficit_pair.first == (*extDegree).second);
+
+                                ++deficits_it;
+                                if (deficits_it == gen_deficits.end())
+                                    check_deficits = false;
+                            }
                         }
+
+                        assert(orig_edge.second != (*extDegree).second);
+                        edge_sorter2.push({orig_edge.second, (*extDegree).second});
                     }
 
-                    assert(orig_edge.second != (*extDegree).second);
-                    edge_sorter2.push({orig_edge.second, (*extDegree).second});
+                    if (use_curveball)
+                        deficits.swap(gen_deficits);
                 }
-                #else
-                for (node_t i = 0; !edge_sorter1.empty(); ++edge_sorter1) {
-                    const edge_t &orig_edge = *edge_sorter1;
-                    for (; i < orig_edge.first; ++extDegree, ++i);
 
-                    assert(orig_edge.second != (*extDegree).second);
-                    edge_sorter2.push({orig_edge.second, (*extDegree).second});
-                }
-                #endif
+                edge_sorter2.sort();
+
+                _inter_community_edges.clear();
+                StreamPusher<decltype(edge_sorter2), decltype(_inter_community_edges)> (edge_sorter2, _inter_community_edges);
+                _inter_community_edges.consume();
             }
+        };
+
+        if (_global_generation == stubMatching) {
+            IOStatistics ios("GlobalGenStubMatching");
+            CommunityStubMatching gen(_community_assignments, RandomSeed::get_instance().get_next_seed());
 
-            edge_sorter2.sort();
+            // node ids correspond to the order of the node sorter
+            for (_node_sorter.rewind(); !_node_sorter.empty(); ++_node_sorter)
+                gen.push(_node_sorter->externalDegree(_mixing));
+
+            gen.generate();
+            std::cout << "Unmatched stubs of global graph: " << gen.unmatchedStubs() << std::endl;
 
             _inter_community_edges.clear();
-            StreamPusher<decltype(edge_sorter2), decltype(_inter_community_edges)> (edge_sorter2, _inter_community_edges);
+            StreamPusher<decltype(gen), decltype(_inter_community_edges)> (gen, _inter_community_edges);
             _inter_community_edges.consume();
+
+        } else if (use_curveball) {
+            HavelHakimiIMGeneratorWithDeficits gen(HavelHakimiIMGeneratorWithDeficits::DecreasingDegree);
+            materialise(gen);
+        } else {
+            HavelHakimiIMGenerator gen(HavelHakimiIMGenerator::DecreasingDegree);
+            materialise(gen);
         }
 
         std::cout << "Current EM allocation after InitialGlobalGen: " <<  stxxl::block_manager::get_instance()->get_current_allocation() << std::endl;
@@ -176,20 +200,31 @@ namespace LFR {
             const size_t num_inter_community_edges = _inter_community_edges.size();
             #endif
 
-            #ifdef CURVEBALL_RAND
-            temp_rewindable_ext_degrees.rewind();
+            // the monitor is only used for the initial randomisation, not for the rewiring below
+            SwapConvergenceMonitor monitor(_number_of_nodes, _swap_convergence);
+            bool initial_randomisation = true;
+
+            // Generate swaps
+            uint_t numSwaps = 10*_inter_community_edges.size();
+            SwapGenerator swapGen(numSwaps, _inter_community_edges.size(), RandomSeed::get_instance().get_next_seed());
+
+            if (_global_generation == stubMatching) {
+                // the stub matching is random already
+                initial_randomisation = false;
 
-            if (1) {
+            } else if (use_curveball) {
                 IOStatistics ios("GlobalGenInitialRandCurveball");
-                if (gen.unsatisfiedNodes() == 0) {
+                temp_rewindable_ext_degrees.rewind();
+
+                if (deficits.empty()) {
                     using CurveballType = Curveball::EMCurveball<Curveball::ModHash>;
                     CurveballType randAlgo(_inter_community_edges, temp_rewindable_ext_degrees, _number_of_nodes,
                                            20, _inter_community_edges, omp_get_max_threads(), _max_memory_usage,
                                            true);
                     randAlgo.run();
-                } else if (gen.unsatisfiedNodes() > 0){
+                } else {
                     // use realised degrees, by applying the wrapper
-                    FixedDegreeStreamWrapper rewindable_ext_degrees(temp_rewindable_ext_degrees, gen.get_deficits());
+                    FixedDegreeStreamWrapper rewindable_ext_degrees(temp_rewindable_ext_degrees, deficits);
 
                     using CurveballType = Curveball::EMCurveball<Curveball::ModHash, FixedDegreeStreamWrapper>;
                     CurveballType randAlgo(_inter_community_edges, rewindable_ext_degrees, _number_of_nodes,
@@ -197,25 +232,37 @@ namespace LFR {
                                            true);
                     randAlgo.run();
                 }
-            }
 
-            _inter_community_edges.rewind();
+                _inter_community_edges.rewind();
+                initial_randomisation = false;
+
+            } else if (ParallelIMEdgeSwap::memoryUsage(_inter_community_edges.size()) < _max_memory_usage) {
+                // small global graphs are randomised in internal memory using all threads
+                IOStatistics ios("GlobalGenInitialRandIM");
+                ParallelIMEdgeSwap imSwapAlgo(_inter_community_edges, omp_get_max_threads());
+                if (_swap_convergence.enabled()) {
+                    monitor.observe(_inter_community_edges);
+                    imSwapAlgo.setProcessSwapCallback([&](uint_t) {
+                        imSwapAlgo.flush();
+                        monitor.observe(_inter_community_edges);
+                    });
+                }
+
+                monitor.pushSwaps(swapGen, imSwapAlgo);
+                imSwapAlgo.run();
+                initial_randomisation = false;
+            }
 
             // regular edge swaps in the rewiring
-            EdgeSwapTFP::SemiLoadedEdgeSwapTFP swapAlgo(_inter_community_edges, globalSwapsPerIteration, _number_of_nodes, _max_memory_usage);
-            #else
-            // regular edge swaps
-            EdgeSwapTFP::SemiLoadedEdgeSwapTFP swapAlgo(_inter_community_edges, globalSwapsPerIteration, _number_of_nodes, _max_memory_usage);
-            // Generate swaps
-            uint_t numSwaps = 10*_inter_community_edges.size();
-            SwapGenerator swapGen(numSwaps, _inter_community_edges.size(), RandomSeed::get_instance().get_next_seed());
+            EdgeSwapTFP::SemiLoadedEdgeSwapTFP swapAlgo(_inter_community_edges, globalSwapsPerIteration, _number_of_nodes, _max_memory_usage,
+                                                        [&](uint_t) {if (initial_randomisation) monitor.observe(_inter_community_edges);});
 
-            if (1) {
+            if (initial_randomisation) {
                 IOStatistics ios("GlobalGenInitialRand");
-                StreamPusher<decltype(swapGen), decltype(swapAlgo)>(swapGen, swapAlgo);
+                monitor.pushSwaps(swapGen, swapAlgo);
                 swapAlgo.run();
+                initial_randomisation = false;
             }
-            #endif
 
             #ifndef NDEBUG
             assert(_inter_community_edges.size() == num_inter_community_edges);
@@ -6,6 +6,7 @@ namespace LFR {
         _intra_community_edges.rewind();
 
         _edges.clear();
+        _intra_edge_flags.clear();
 
         edge_t curEdge = {-1, -1};
 
@@ -16,6 +17,7 @@ namespace LFR {
                 if (curEdge != *_intra_community_edges) {
                     curEdge = *_intra_community_edges;
                     _edges.push(curEdge);
+                    if (_weighted) _intra_edge_flags.push(true);
                 } else {
                     ++discardedEdges;
                 }
@@ -25,6 +27,7 @@ namespace LFR {
                 if (curEdge != *_inter_community_edges) {
                     curEdge = *_inter_community_edges;
                     _edges.push(curEdge);
+                    if (_weighted) _intra_edge_flags.push(false);
                 } else {
                     assert(false && "Global edges should have been rewired to not to conflict with any internal edge!");
                 }
@@ -33,6 +36,8 @@ namespace LFR {
             }
         }
 
+        _intra_edge_flags.consume();
+
         if (discardedEdges > 0) {
             STXXL_MSG("Discarded " << discardedEdges << " internal edges that were in multiple communities of in total " << _edges.size() << " edges.");
             assert(false && "Duplicate intra-community edges should have been rewired!");
@@ -20,6 +20,10 @@ namespace LFR {
         std::cout << "[LFR::_verify_assignment] is disabled" << std::endl;
     }
 
+    void LFR::_verify_directed_result_graph() {
+        std::cout << "[LFR::_verify_directed_result_graph] is disabled" << std::endl;
+    }
+
 #else
     void LFR::_verify_assignment() {
         community_t com = 0;
@@ -308,5 +312,59 @@ namespace LFR {
             abort();
     }
 
+    void LFR::_verify_directed_result_graph() {
+        // check:
+        //  - no multiedges
+        //  - no self-loops
+        //  - in- and out-degrees do not exceed the requested ones
+
+        stxxl::sorter<node_t, GenericComparator<node_t>::Ascending> targets(GenericComparator<node_t>::Ascending(), SORTER_MEM);
+
+        edge_t last_edge = edge_t::invalid();
+        for(_edges.consume(); !_edges.empty(); ++_edges) {
+            const auto & edge = *_edges;
+
+            STABLE_EXPECT(last_edge.is_invalid() || last_edge < edge);
+            STABLE_EXPECT(!edge.is_loop());
+
+            targets.push(edge.second);
+            last_edge = edge;
+        }
+
+        targets.sort();
+
+        node_t not_matching = 0;
+        edgeid_t unmaterialized = 0;
+
+        node_t u = 0;
+        _edges.consume();
+        for (stxxl::vector<DirectedNodeDegree>::bufreader_type reader(_directed_degrees); !reader.empty(); ++reader, ++u) {
+            degree_t out_degree = 0;
+            for (; !_edges.empty() && _edges->first == u; ++_edges)
+                ++out_degree;
+
+            degree_t in_degree = 0;
+            for (; !targets.empty() && *targets == u; ++targets)
+                ++in_degree;
+
+            STABLE_EXPECT_LE(out_degree, reader->out_degree);
+            STABLE_EXPECT_LE(in_degree, reader->in_degree);
+
+            if (out_degree < reader->out_degree || in_degree < reader->in_degree) {
+                not_matching++;
+                unmaterialized += (reader->out_degree - out_degree) + (reader->in_degree - in_degree);
+            }
+        }
+
+        STABLE_EXPECT(_edges.empty());
+        STABLE_EXPECT(targets.empty());
+
+        std::cout << "Found " << not_matching << " nodes with too low in- or out-degree. "
+                     "Miss " << unmaterialized << " (" << (static_cast<double>(unmaterialized) / _number_of_nodes) << " per node) edge endpoints in total."
+        << std::endl;
+
+        _edges.consume();
+    }
+
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "LFR.h"
+#include <GenericComparator.h>
+#include <TupleHelper.h>
+
+#include <cmath>
+
+namespace LFR {
+    namespace {
+        //! Weight of an edge as seen from one of its endpoints
+        struct EndpointWeight {
+            node_t node;
+            bool intra;
+            edge_weight_t weight;
+
+            EndpointWeight() {}
+            EndpointWeight(node_t node, bool intra, edge_weight_t weight) : node(node), intra(intra), weight(weight) {}
+
+            DECL_LEX_COMPARE(EndpointWeight, node, intra, weight);
+        };
+
+        //! Per-edge corrections of the intra- and inter-community strength of a node
+        using strength_correction_t = std::pair<edge_weight_t, edge_weight_t>;
+    }
+
+    void LFR::_assign_edge_weights() {
+        _edges.consume();
+        const edgeid_t num_edges = _edges.size();
+        assert(static_cast<edgeid_t>(_intra_edge_flags.size()) == num_edges);
+
+        _edge_weights.clear();
+        _edge_weights.resize(num_edges);
+        {
+            stxxl::vector<edge_weight_t>::bufwriter_type writer(_edge_weights);
+            for (edgeid_t eid = 0; eid < num_edges; ++eid)
+                writer << 0;
+            writer.finish();
+        }
+
+        double last_deviation = std::numeric_limits<double>::max();
+
+        for (unsigned int pass = 0; pass < _weight_max_passes; ++pass) {
+            // compute realised strengths, compare them to the wished ones and derive corrections
+            stxxl::vector<strength_correction_t> corrections(_number_of_nodes);
+            double deviation = 0.0;
+            double total_strength = 0.0;
+            {
+                using endpoint_comparator_t = GenericComparatorStruct<EndpointWeight>::Ascending;
+                stxxl::sorter<EndpointWeight, endpoint_comparator_t> endpoints(endpoint_comparator_t(), SORTER_MEM);
+
+                _edges.rewind();
+                _intra_edge_flags.rewind();
+                for (stxxl::vector<edge_weight_t>::bufreader_type weights(_edge_weights); !_edges.empty(); ++_edges, ++_intra_edge_flags, ++weights) {
+                    endpoints.push(EndpointWeight(_edges->first, *_intra_edge_flags, *weights));
+                    endpoints.push(EndpointWeight(_edges->second, *_intra_edge_flags, *weights));
+                }
+                endpoints.sort();
+
+                stxxl::vector<strength_correction_t>::bufwriter_type writer(corrections);
+                for (node_t u = 0; u < _number_of_nodes; ++u) {
+                    degree_t degree[2] = {0, 0};
+                    double strength[2] = {0.0, 0.0};
+                    for (; !endpoints.empty() && endpoints->node == u; ++endpoints) {
+                        degree[endpoints->intra]++;
+                        strength[endpoints->intra] += endpoints->weight;
+                    }
+
+                    // as in the original benchmark, the strength is a power of the realised degree
+                    const double wished_strength = std::pow(static_cast<double>(degree[0] + degree[1]), _weight_exponent);
+                    const double wished[2] = {_weight_mixing * wished_strength, (1.0 - _weight_mixing) * wished_strength};
+
+                    edge_weight_t correction[2] = {0, 0};
+                    for (int intra = 0; intra < 2; ++intra) {
+                        const double diff = wished[intra] - strength[intra];
+                        deviation += diff * diff;
+                        if (degree[intra])
+                            correction[intra] = static_cast<edge_weight_t>(diff / degree[intra]);
+                    }
+
+                    total_strength += wished_strength;
+                    writer << strength_correction_t(correction[0], correction[1]);
+                }
+                writer.finish();
+            }
+
+            const double relative_improvement = (last_deviation - deviation) / last_deviation;
+            std::cout << "Weight assignment pass " << pass << ": squared strength deviation " << deviation
+                      << " (relative improvement " << relative_improvement << ")" << std::endl;
+
+            if (deviation < 1e-9 * total_strength * total_strength || relative_improvement < 1e-2)
+                break;
+
+            last_deviation = deviation;
+
+            // corrections of the second endpoints ordered by edge id
+            using corr_comparator_t = GenericComparator<std::pair<edgeid_t, edge_weight_t>>::Ascending;
+            stxxl::sorter<std::pair<edgeid_t, edge_weight_t>, corr_comparator_t> second_corrections(corr_comparator_t(), SORTER_MEM);
+            {
+                using node_edge_t = std::pair<node_t, edgeid_t>;
+                stxxl::sorter<node_edge_t, GenericComparator<node_edge_t>::Ascending> seconds(GenericComparator<node_edge_t>::Ascending(), SORTER_MEM);
+
+                _edges.rewind();
+                for (edgeid_t eid = 0; !_edges.empty(); ++_edges, ++eid)
+                    seconds.push({_edges->second, eid});
+                seconds.sort();
+
+                // the edge kind is not known here, so both corrections are pushed: inter at 2*id, intra at 2*id+1
+                stxxl::vector<strength_correction_t>::bufreader_type reader(corrections);
+                for (node_t u = 0; !seconds.empty(); ++seconds) {
+                    for (; u < seconds->first; ++u, ++reader);
+                    second_corrections.push({2 * seconds->second, reader->first});
+                    second_corrections.push({2 * seconds->second + 1, reader->second});
+                }
+                second_corrections.sort();
+            }
+
+            // move every weight by the average correction of its endpoints (Jacobi-style variant of the original propagation)
+            stxxl::vector<edge_weight_t> new_weights(num_edges);
+            {
+                stxxl::vector<edge_weight_t>::bufwriter_type writer(new_weights);
+                stxxl::vector<strength_correction_t>::bufreader_type reader(corrections);
+
+                _edges.rewind();
+                _intra_edge_flags.rewind();
+                node_t u = 0;
+                edgeid_t eid = 0;
+                for (stxxl::vector<edge_weight_t>::bufreader_type weights(_edge_weights); !_edges.empty(); ++_edges, ++_intra_edge_flags, ++weights, ++eid) {
+                    for (; u < _edges->first; ++u, ++reader);
+
+                    const bool intra = *_intra_edge_flags;
+                    const edge_weight_t first_correction = intra ? reader->second : reader->first;
+
+                    assert(second_corrections->first == 2 * eid);
+                    const edge_weight_t second_inter_correction = second_corrections->second;
+                    ++second_corrections;
+                    const edge_weight_t second_intra_correction = second_corrections->second;
+                    ++second_corrections;
+                    const edge_weight_t second_correction = intra ? second_intra_correction : second_inter_correction;
+
+                    writer << std::max<edge_weight_t>(0, *weights + (first_correction + second_correction) / 2);
+                }
+                writer.finish();
+            }
+
+            _edge_weights.swap(new_weights);
+        }
+
+        _edges.rewind();
+        _intra_edge_flags.rewind();
+    }
+}
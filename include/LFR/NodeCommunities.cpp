@@ -0,0 +1,56 @@
+#include <LFR/NodeCommunities.h>
+#include <GenericComparator.h>
+#include <stxxl/sorter>
+#include <algorithm>
+
+void loadNodeCommunities(const stxxl::vector<LFR::CommunityAssignment> &community_assignment,
+                         node_community_vector_t &node_communities) {
+    stxxl::sorter<NodeCommunity, GenericComparatorStruct<NodeCommunity>::Ascending> node_community_sorter(GenericComparatorStruct<NodeCommunity>::Ascending(), SORTER_MEM);
+    #pragma omp critical (_community_assignment)
+    {
+        stxxl::vector<LFR::CommunityAssignment>::bufreader_type communityReader(community_assignment);
+
+        while (!communityReader.empty()) {
+            node_community_sorter.push(NodeCommunity {communityReader->node_id, communityReader->community_id});
+            ++communityReader;
+        }
+    }
+
+    node_community_sorter.sort();
+    node_communities.clear();
+    node_communities.resize(node_community_sorter.size());
+
+    node_community_vector_t::bufwriter_type writer(node_communities);
+    for (; !node_community_sorter.empty(); ++node_community_sorter) {
+        writer << *node_community_sorter;
+    }
+    writer.finish();
+}
+
+NodeCommunityReader::NodeCommunityReader(const node_community_vector_t &node_communities, uint_t expected_requests)
+    : _node_communities(node_communities),
+      // a lookup touches about log2(n) entries, a scan all n entries
+      _lookup(expected_requests * 64 < node_communities.size()),
+      _position(node_communities.cbegin())
+{
+    if (!_lookup)
+        _reader.reset(new node_community_vector_t::bufreader_type(_node_communities));
+}
+
+void NodeCommunityReader::get(node_t u, std::vector<community_t> &communities) {
+    communities.clear();
+
+    if (_lookup) {
+        _position = std::lower_bound(_position, _node_communities.cend(), NodeCommunity {u, 0});
+
+        for (; _position != _node_communities.cend() && (*_position).node == u; ++_position)
+            communities.push_back((*_position).community);
+
+    } else {
+        while (!_reader->empty() && (**_reader).node < u)
+            ++(*_reader);
+
+        for (; !_reader->empty() && (**_reader).node == u; ++(*_reader))
+            communities.push_back((**_reader).community);
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file
+ * @brief Node to community memberships sorted by node for streaming joins with edges
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <stxxl/vector>
+#include <TupleHelper.h>
+#include <LFR/LFR.h>
+
+struct NodeCommunity {
+    node_t node;
+    community_t community;
+
+    DECL_LEX_COMPARE(NodeCommunity, node, community)
+};
+
+using node_community_vector_t = stxxl::vector<NodeCommunity>;
+
+//! Replaces node_communities by the memberships of community_assignment sorted by node and community
+void loadNodeCommunities(const stxxl::vector<LFR::CommunityAssignment> &community_assignment,
+                         node_community_vector_t &node_communities);
+
+/**
+ * Provides the communities of nodes requested in ascending order. If only few nodes are
+ * requested, they are looked up by binary search in the node communities, otherwise
+ * the node communities are scanned. The cost is hence proportional to the number of
+ * requested nodes and not to the number of nodes of the graph if there are few requests.
+ */
+class NodeCommunityReader {
+    const node_community_vector_t & _node_communities;
+    const bool _lookup;
+
+    std::unique_ptr<node_community_vector_t::bufreader_type> _reader;
+    node_community_vector_t::const_iterator _position;
+
+public:
+    NodeCommunityReader(const node_community_vector_t & node_communities, uint_t expected_requests);
+
+    //! Replaces the content of communities by the (ascending) communities of node u
+    void get(node_t u, std::vector<community_t> & communities);
+};
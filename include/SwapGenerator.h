@@ -7,8 +7,9 @@
  */
 
 #pragma once
-#include <random>
+#include <array>
 #include "Swaps.h"
+#include <Utils/PhiloxRNG.h>
 #include <Utils/RandomBoolStream.h>
 
 class SwapGenerator {
@@ -22,19 +23,31 @@ protected:
     int64_t _current_number_of_swaps;
     value_type _current_swap;
 
-    STDRandomEngine _rand_gen;
-    std::uniform_int_distribution<edgeid_t> _random_integer;
+    // edge ids are drawn in batches to allow for vectorised generation
+    constexpr static unsigned int _edge_buffer_size = 2048;
+
+    PhiloxRNG _rand_gen;
+    std::array<edgeid_t, _edge_buffer_size> _edge_buffer;
+    unsigned int _edge_buffer_pos;
 
     RandomBoolStream _bool_stream;
 
+    edgeid_t _random_edge() {
+        if (UNLIKELY(_edge_buffer_pos == _edge_buffer_size)) {
+            _rand_gen.fill_bounded(_edge_buffer.data(), _edge_buffer_size, _number_of_edges_in_graph);
+            _edge_buffer_pos = 0;
+        }
+        return _edge_buffer[_edge_buffer_pos++];
+    }
+
 public:
     SwapGenerator(int64_t number_of_swaps, int64_t edges_in_graph, uint32_t seed)
         : _number_of_edges_in_graph(edges_in_graph)
         , _requested_number_of_swaps(number_of_swaps)
         , _current_number_of_swaps(0)
         , _rand_gen(seed)
-        , _random_integer(0, _number_of_edges_in_graph-1)
-        , _bool_stream(_rand_gen())
+        , _edge_buffer_pos(_edge_buffer_size)
+        , _bool_stream(seed, 1)
     {
         assert(_number_of_edges_in_graph > 1);
         ++(*this);
@@ -55,8 +68,8 @@ public:
 
         while (1) {
             // generate two disjoint random edge ids
-            edgeid_t e1 = _random_integer(_rand_gen);
-            edgeid_t e2 = _random_integer(_rand_gen);
+            edgeid_t e1 = _random_edge();
+            edgeid_t e2 = _random_edge();
             if (e1 == e2) continue;
 
             // direction flag
@@ -0,0 +1,173 @@
+/**
+ * @file
+ * @brief Cache-line blocked Bloom filter over 64 bit keys and edges
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <defs.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Probabilistic set membership with one-sided error.
+ *
+ * Each key is mapped to a single block of 512 bits (i.e. one cache line);
+ * all of its probe bits are set within this block. Hence an insertion or a
+ * query touches exactly one cache line. The filter has no false negatives:
+ * if contains(x) returns false, x has never been inserted since the last clear().
+ * The false positive rate is roughly (1 - exp(-k/b))^k where b is the number of
+ * bits per element and k the number of probes (slightly higher due to blocking).
+ */
+class BlockedBloomFilter {
+public:
+    using key_type = uint64_t;
+
+protected:
+    using word_t = uint64_t;
+    constexpr static unsigned int _words_per_block = 8;
+    constexpr static unsigned int _bits_per_block = 8 * sizeof(word_t) * _words_per_block;
+    constexpr static unsigned int _bits_per_probe = 9; // log2(_bits_per_block)
+    constexpr static unsigned int _max_probes = 64 / _bits_per_probe;
+
+    static_assert((1u << _bits_per_probe) == _bits_per_block, "Probe width has to address a whole block");
+
+    // we over-allocate by one block to align the first block to a cache line
+    std::vector<word_t> _data;
+    word_t* _words;
+    uint_t _num_blocks;
+
+    unsigned int _num_probes;
+    uint_t _num_inserted;
+
+    //! Finalizer of MurmurHash3; a bijection on 64 bit keys with good avalanche properties
+    static uint64_t _mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdllu;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53llu;
+        h ^= h >> 33;
+        return h;
+    }
+
+    //! Maps the hash value uniformly onto [0, _num_blocks) without a division
+    word_t* _block_of(const uint64_t hash) const {
+        const uint_t block = static_cast<uint_t>((static_cast<unsigned __int128>(hash) * _num_blocks) >> 64);
+        return _words + block * _words_per_block;
+    }
+
+public:
+    //! Creates an empty filter; use resize() before inserting elements
+    BlockedBloomFilter() : _words(nullptr), _num_blocks(0), _num_probes(0), _num_inserted(0) {}
+
+    BlockedBloomFilter(const BlockedBloomFilter&) = delete;
+    BlockedBloomFilter& operator=(const BlockedBloomFilter&) = delete;
+
+    //! Creates an empty filter for the given number of elements and bits per element
+    BlockedBloomFilter(uint_t expected_elements, double bits_per_element) : BlockedBloomFilter() {
+        resize(expected_elements, bits_per_element);
+    }
+
+    //! (Re)allocates the filter and clears it. The number of probes is chosen to
+    //! minimize the false positive rate, i.e. k = ln(2) * bits_per_element.
+    void resize(uint_t expected_elements, double bits_per_element) {
+        assert(bits_per_element > 0);
+
+        _num_blocks = memoryUsage(expected_elements, bits_per_element) / (_bits_per_block / 8);
+        std::vector<word_t>((_num_blocks + 1) * _words_per_block).swap(_data);
+
+        const auto misalignment = reinterpret_cast<uintptr_t>(_data.data()) % (_bits_per_block / 8);
+        _words = _data.data() + (misalignment ? ((_bits_per_block / 8) - misalignment) / sizeof(word_t) : 0);
+
+        _num_probes = static_cast<unsigned int>(std::lround(std::log(2.0) * bits_per_element));
+        _num_probes = std::min(_max_probes, std::max(1u, _num_probes));
+
+        clear();
+    }
+
+    //! Removes all elements but keeps the allocation
+    void clear() {
+        std::fill(_data.begin(), _data.end(), word_t(0));
+        _num_inserted = 0;
+    }
+
+    //! Releases the allocation; the filter has to be resized before it can be used again
+    void release() {
+        std::vector<word_t>().swap(_data);
+        _words = nullptr;
+        _num_blocks = 0;
+        _num_inserted = 0;
+    }
+
+    bool allocated() const {
+        return _num_blocks;
+    }
+
+    void insert(const key_type key) {
+        assert(allocated());
+        const uint64_t hash = _mix(key);
+        word_t* block = _block_of(hash);
+
+        uint64_t probes = _mix(hash ^ 0x9e3779b97f4a7c15llu);
+        for(unsigned int i = 0; i < _num_probes; ++i, probes >>= _bits_per_probe) {
+            const unsigned int bit = probes & (_bits_per_block - 1);
+            block[bit / 64] |= word_t(1) << (bit % 64);
+        }
+
+        ++_num_inserted;
+    }
+
+    //! Returns false only if the key was not inserted since the last clear()
+    bool contains(const key_type key) const {
+        assert(allocated());
+        const uint64_t hash = _mix(key);
+        const word_t* block = _block_of(hash);
+
+        uint64_t probes = _mix(hash ^ 0x9e3779b97f4a7c15llu);
+        word_t missing = 0;
+        for(unsigned int i = 0; i < _num_probes; ++i, probes >>= _bits_per_probe) {
+            const unsigned int bit = probes & (_bits_per_block - 1);
+            missing |= ~block[bit / 64] & (word_t(1) << (bit % 64));
+        }
+
+        return !missing;
+    }
+
+//! @name Edge interface
+//! @{
+    static key_type edge_key(const edge_t & edge) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(edge.first)) << 32) | static_cast<uint32_t>(edge.second);
+    }
+
+    void insert(const edge_t & edge) {
+        insert(edge_key(edge));
+    }
+
+    bool contains(const edge_t & edge) const {
+        return contains(edge_key(edge));
+    }
+//! @}
+
+    //! Number of insert operations since last clear()
+    const uint_t& size() const {
+        return _num_inserted;
+    }
+
+    //! Number of probes per element
+    unsigned int probes() const {
+        return _num_probes;
+    }
+
+    //! Memory allocated for the bit array in bytes
+    uint_t memoryUsage() const {
+        return _num_blocks * (_bits_per_block / 8);
+    }
+
+    //! Memory needed in bytes for the given configuration
+    static uint_t memoryUsage(uint_t expected_elements, double bits_per_element) {
+        const uint_t bits = static_cast<uint_t>(std::ceil(bits_per_element * std::max<uint_t>(1, expected_elements)));
+        return (bits + _bits_per_block - 1) / _bits_per_block * (_bits_per_block / 8);
+    }
+};
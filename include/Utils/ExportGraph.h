@@ -3,6 +3,7 @@
 #include <EdgeStream.h>
 #include <fstream>
 #include <stxxl/sorter>
+#include <stxxl/vector>
 #include <defs.h>
 #include <GenericComparator.h>
 
@@ -294,6 +295,29 @@ void export_as_thrillbin_sorted(EdgeStream &edges, const std::string &filename,
 	out_stream.close();
 };
 
+//! Writes the edges in stream order without normalising them, e.g. directed edges, followed by their weights if given
+template <typename WeightVector = stxxl::vector<float>>
+void export_as_edgelist_in_order(EdgeStream &edges, const std::string& filename, const WeightVector * weights = nullptr) {
+	edges.rewind();
+
+	std::ofstream out_stream(filename, std::ios::trunc);
+
+	if (weights) {
+		assert(weights->size() == edges.size());
+		typename WeightVector::bufreader_type weight_reader(*weights);
+		for (; !edges.empty(); ++edges, ++weight_reader) {
+			out_stream << edges->first << " " << edges->second << " " << *weight_reader << std::endl;
+		}
+	} else {
+		for (; !edges.empty(); ++edges) {
+			out_stream << edges->first << " " << edges->second << std::endl;
+		}
+	}
+
+	edges.rewind();
+	out_stream.close();
+};
+
 void export_as_edgelist(EdgeStream &edges, const std::string& filename) {
 	edges.rewind();
 
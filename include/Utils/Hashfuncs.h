@@ -7,6 +7,7 @@
 #pragma once
 
 #include "defs.h"
+#include <algorithm>
 #include <vector>
 
 namespace Curveball {
@@ -48,6 +49,28 @@ public:
 		_next = hash_funcs[_shift + 1];
 	}
 
+	/**
+	 * Continues a sequence of hash-functions, e.g. from a checkpoint.
+	 * @param num_nodes Number of nodes.
+	 * @param funcs Hash-functions of the remaining rounds, the last one has to be the identity.
+	 */
+	Hashfuncs(const node_t num_nodes, std::vector<HashClass> funcs) :
+					_num_nodes(num_nodes),
+					_num_rounds(static_cast<uint_t>(funcs.size() - 1)),
+					hash_funcs(std::move(funcs)),
+					_shift(0)
+	{
+		assert(!hash_funcs.empty());
+
+		#ifndef NDEBUG
+			for (node_t node = 0; node < num_nodes; node++)
+				assert(node == hash_funcs[_num_rounds].hash(node));
+		#endif
+
+		_current = hash_funcs[_shift];
+		_next = hash_funcs[std::min<size_t>(_shift + 1, _num_rounds)];
+	}
+
 	Hashfuncs(Hashfuncs const &) = delete;
 
 	void operator=(Hashfuncs const &) = delete;
@@ -80,6 +103,11 @@ public:
 		return hash_funcs[index];
 	};
 
+	//! Hash-functions from the current round on, the last one is the identity
+	std::vector<HashClass> remaining() const {
+		return std::vector<HashClass>(hash_funcs.begin() + _shift, hash_funcs.end());
+	}
+
 	bool at_last() const {
 		return _num_rounds == _shift;
 	}
@@ -8,6 +8,9 @@
 #pragma once
 
 #include "defs.h"
+#include "RandomSeed.h"
+#include <algorithm>
+#include <array>
 #include <random>
 
 namespace Curveball {
@@ -130,4 +133,126 @@ namespace Curveball {
 		}
 	};
 
+	/**
+	 * Bijective hash on [0, n) by a Feistel network over the smallest
+	 * power-of-two domain of even bit-width covering n; values outside of
+	 * [0, n) are mapped again (cycle-walking), at most four times in
+	 * expectation. The round functions are multiply-shift hashes, so neither
+	 * hashing nor inverting needs a division and the rounds are branch-free.
+	 * Nodes outside of [0, n) are mapped to themselves, as cycle-walking
+	 * would not terminate for them.
+	 */
+	class FeistelHash {
+	public:
+		static constexpr unsigned int NUM_ROUNDS = 4;
+
+	private:
+		uint32_t _num_nodes;
+		unsigned int _half_bits;
+		uint32_t _half_mask;
+		unsigned int _num_rounds;
+		std::array<uint64_t, NUM_ROUNDS> _mults;
+		std::array<uint32_t, NUM_ROUNDS> _keys;
+
+		uint32_t _round_func(const unsigned int round, const uint32_t half) const {
+			return static_cast<uint32_t>(((half ^ _keys[round]) * _mults[round]) >> (64 - _half_bits));
+		}
+
+		uint32_t _permute(const uint32_t x) const {
+			uint32_t left = x >> _half_bits;
+			uint32_t right = x & _half_mask;
+			for (unsigned int round = 0; round < _num_rounds; round++) {
+				const uint32_t tmp = right;
+				right = left ^ _round_func(round, right);
+				left = tmp;
+			}
+			return (left << _half_bits) | right;
+		}
+
+		uint32_t _unpermute(const uint32_t x) const {
+			uint32_t left = x >> _half_bits;
+			uint32_t right = x & _half_mask;
+			for (unsigned int round = _num_rounds; round-- > 0; ) {
+				const uint32_t tmp = left;
+				left = right ^ _round_func(round, left);
+				right = tmp;
+			}
+			return (left << _half_bits) | right;
+		}
+
+	public:
+		FeistelHash() = default;
+
+		FeistelHash(const FeistelHash&) = default;
+
+		FeistelHash& operator = (const FeistelHash&) = default;
+
+		FeistelHash(FeistelHash&&) = default;
+
+		FeistelHash& operator = (FeistelHash&&) = default;
+
+		/**
+		 * @param num_nodes Size of the domain [0, num_nodes).
+		 * @param seed Seed of the round keys.
+		 * @param num_rounds Number of Feistel rounds, 0 yields the identity.
+		 */
+		FeistelHash(const node_t num_nodes, const uint64_t seed, const unsigned int num_rounds = NUM_ROUNDS) :
+			_num_nodes(static_cast<uint32_t>(std::max<node_t>(num_nodes, 1))),
+			_num_rounds(num_rounds) {
+			assert(num_rounds <= NUM_ROUNDS);
+
+			unsigned int bits = 2;
+			while (bits < 32 && (uint64_t(1) << bits) < _num_nodes)
+				bits += 2;
+			_half_bits = bits / 2;
+			_half_mask = (uint32_t(1) << _half_bits) - 1;
+
+			STDRandomEngine gen(seed);
+			for (unsigned int round = 0; round < NUM_ROUNDS; round++) {
+				_mults[round] = gen() | 1;
+				_keys[round] = static_cast<uint32_t>(gen()) & _half_mask;
+			}
+		}
+
+		hnode_t hash(const node_t node) const {
+			if (static_cast<uint32_t>(node) >= _num_nodes)
+				return static_cast<hnode_t>(node);
+
+			uint32_t x = _permute(static_cast<uint32_t>(node));
+			while (x >= _num_nodes)
+				x = _permute(x);
+			return static_cast<hnode_t>(x);
+		}
+
+		node_t invert(const hnode_t hnode) const {
+			if (static_cast<uint32_t>(hnode) >= _num_nodes)
+				return static_cast<node_t>(hnode);
+
+			uint32_t x = _unpermute(static_cast<uint32_t>(hnode));
+			while (x >= _num_nodes)
+				x = _unpermute(x);
+			return static_cast<node_t>(x);
+		}
+
+		bool operator()(const node_t &a, const node_t &b) const {
+			return hash(a) < hash(b);
+		}
+
+		hnode_t min_value() const {
+			return invert(0);
+		}
+
+		hnode_t max_value() const {
+			return invert(static_cast<hnode_t>(_num_nodes - 1));
+		}
+
+		static FeistelHash get_random(const node_t num_nodes) {
+			return FeistelHash{num_nodes, RandomSeed::get_instance().get_next_seed()};
+		}
+
+		static FeistelHash get_identity(const node_t num_nodes) {
+			return FeistelHash{num_nodes, 0, 0};
+		}
+	};
+
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * @file
+ * @brief Counter-based Philox4x32-10 random number generator with batch interface
+ * @copyright to be decided
+ */
+#pragma once
+
+#include <defs.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+
+/**
+ * @brief Counter-based pseudo random number generator (Philox4x32-10, Salmon et al. 2011)
+ *
+ * The i-th output block is a keyed bijection of the counter i, i.e. the generator
+ * has no state besides a counter and blocks can be computed independently. Hence,
+ * fill() computes several blocks in one loop without data dependencies, which
+ * the compiler is able to vectorise, and each pair (seed, stream) yields an
+ * independent sequence. The latter can be used to derive reproducible randomness
+ * for work items (e.g. one stream per swap run or per trade) regardless of the
+ * number of threads processing them.
+ *
+ * The class models UniformRandomBitGenerator and can be used with std distributions.
+ */
+class PhiloxRNG {
+public:
+    using result_type = uint64_t;
+
+protected:
+    constexpr static uint32_t _mult0 = 0xD2511F53;
+    constexpr static uint32_t _mult1 = 0xCD9E8D57;
+    constexpr static uint32_t _weyl0 = 0x9E3779B9;
+    constexpr static uint32_t _weyl1 = 0xBB67AE85;
+    constexpr static unsigned int _rounds = 10;
+
+    //! Number of 64 bit values buffered for operator()
+    constexpr static unsigned int _buffer_size = 32;
+
+    uint32_t _key[2];
+    uint32_t _stream[2];
+    uint64_t _block;
+
+    std::array<result_type, _buffer_size> _buffer;
+    unsigned int _buffer_pos;
+
+    //! Computes the 128 bit output of the given block and writes it into out[0] and out[1]
+    void _compute_block(uint64_t block, result_type * out) const {
+        uint32_t c0 = static_cast<uint32_t>(block);
+        uint32_t c1 = static_cast<uint32_t>(block >> 32);
+        uint32_t c2 = _stream[0];
+        uint32_t c3 = _stream[1];
+        uint32_t k0 = _key[0];
+        uint32_t k1 = _key[1];
+
+        for (unsigned int r = 0; r < _rounds; ++r) {
+            const uint64_t p0 = static_cast<uint64_t>(_mult0) * c0;
+            const uint64_t p1 = static_cast<uint64_t>(_mult1) * c2;
+
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+
+            c0 = n0;
+            c1 = static_cast<uint32_t>(p1);
+            c2 = n2;
+            c3 = static_cast<uint32_t>(p0);
+
+            k0 += _weyl0;
+            k1 += _weyl1;
+        }
+
+        out[0] = (static_cast<uint64_t>(c1) << 32) | c0;
+        out[1] = (static_cast<uint64_t>(c3) << 32) | c2;
+    }
+
+    //! Writes the output of n/2 consecutive blocks into out; n has to be even
+    void _fill_blocks(result_type * out, size_t n) {
+        assert(!(n % 2));
+        const uint64_t first = _block;
+        for (size_t i = 0; i < n / 2; ++i)
+            _compute_block(first + i, out + 2 * i);
+        _block += n / 2;
+    }
+
+    void _refill_buffer() {
+        _fill_blocks(_buffer.data(), _buffer_size);
+        _buffer_pos = 0;
+    }
+
+public:
+    //! Sequences with different seed or stream are independent
+    explicit PhiloxRNG(uint64_t seed = 0, uint64_t stream = 0) {
+        this->seed(seed, stream);
+    }
+
+    //! Restarts the generator at the begin of the given sequence
+    void seed(uint64_t seed, uint64_t stream = 0) {
+        _key[0] = static_cast<uint32_t>(seed);
+        _key[1] = static_cast<uint32_t>(seed >> 32);
+        _stream[0] = static_cast<uint32_t>(stream);
+        _stream[1] = static_cast<uint32_t>(stream >> 32);
+        _block = 0;
+        _buffer_pos = _buffer_size;
+    }
+
+    static constexpr result_type min() {return std::numeric_limits<result_type>::min();}
+    static constexpr result_type max() {return std::numeric_limits<result_type>::max();}
+
+    result_type operator()() {
+        if (UNLIKELY(_buffer_pos == _buffer_size))
+            _refill_buffer();
+        return _buffer[_buffer_pos++];
+    }
+
+//! @name Batch interface
+//! @{
+    //! Writes the next n values of the sequence into out
+    void fill(result_type * out, size_t n) {
+        // use up buffered values first to keep the sequence consistent with operator()
+        for (; n && _buffer_pos < _buffer_size; --n)
+            *out++ = _buffer[_buffer_pos++];
+
+        const size_t direct = n & ~size_t(1);
+        _fill_blocks(out, direct);
+
+        if (n > direct)
+            out[direct] = operator()();
+    }
+
+    //! Writes n independent uniform integers from [0, range) into out.
+    //! Uses Lemire's multiply-shift reduction; rejections (which are required
+    //! to remove the bias) are handled after the vectorised part.
+    template <typename T>
+    void fill_bounded(T * out, size_t n, uint64_t range) {
+        assert(range > 0);
+        const uint64_t threshold = (0 - range) % range;
+
+        constexpr size_t chunk = 256;
+        result_type raw[chunk];
+
+        while (n) {
+            const size_t m = std::min(n, chunk);
+            fill(raw, m);
+
+            for (size_t i = 0; i < m; ++i) {
+                uint64_t x = raw[i];
+                unsigned __int128 prod = static_cast<unsigned __int128>(x) * range;
+                while (UNLIKELY(static_cast<uint64_t>(prod) < threshold)) {
+                    x = operator()();
+                    prod = static_cast<unsigned __int128>(x) * range;
+                }
+                out[i] = static_cast<T>(prod >> 64);
+            }
+
+            out += m;
+            n -= m;
+        }
+    }
+
+    //! Returns a uniform integer from [0, range)
+    uint64_t bounded(uint64_t range) {
+        assert(range > 0);
+        unsigned __int128 prod = static_cast<unsigned __int128>(operator()()) * range;
+        if (UNLIKELY(static_cast<uint64_t>(prod) < range)) {
+            const uint64_t threshold = (0 - range) % range;
+            while (static_cast<uint64_t>(prod) < threshold)
+                prod = static_cast<unsigned __int128>(operator()()) * range;
+        }
+        return static_cast<uint64_t>(prod >> 64);
+    }
+//! @}
+};
@@ -1,18 +1,19 @@
 #pragma once
 #include <defs.h>
-#include <random>
+#include <Utils/PhiloxRNG.h>
 
 class RandomBoolStream {
 private:
     unsigned int _flag_bits_remaining = 0;
     uint64_t _flag_bits;
 
-    std::mt19937_64 _rand_gen;
+    PhiloxRNG _rand_gen;
 
 
 public:
-    RandomBoolStream(seed_t seed)
-          : _rand_gen(seed)
+    //! Streams with different (seed, stream) pairs are independent
+    RandomBoolStream(seed_t seed, uint64_t stream = 0)
+          : _rand_gen(seed, stream)
     {
        operator++();
     }
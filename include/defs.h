@@ -173,6 +173,10 @@ namespace Curveball {
 	constexpr int DUMMY_Z = 8;
 	constexpr node_t DUMMY_PRIME = 2147483647;
 
+	//! Pairs with at least this many neighbours in total may be traded
+	//! by all threads together
+	constexpr degree_t MIN_HEAVY_TRADE_DEGREE = 1 << 14;
+
 	struct CurveballParams {
 		const tradeid_t rounds = 0;
 		const chunkid_t macrochunks = 1;
@@ -182,6 +186,8 @@ namespace Curveball {
 		const msgid_t msg_limit = 0;
 		const int threads = 1;
 		const msgid_t insertion_buffer_size = 0;
+		const bool compressed_msgs = false;
+		const degree_t min_heavy_trade_degree = MIN_HEAVY_TRADE_DEGREE;
 
 		CurveballParams() = default;
 
@@ -193,7 +199,9 @@ namespace Curveball {
 			uint_t sorter_mem_size_,
 			msgid_t msg_limit_,
 			int threads_,
-			msgid_t insertion_buffer_size_
+			msgid_t insertion_buffer_size_,
+			bool compressed_msgs_ = false,
+			degree_t min_heavy_trade_degree_ = MIN_HEAVY_TRADE_DEGREE
 		) :
 			rounds(rounds_),
 			macrochunks(macrochunks_),
@@ -202,7 +210,9 @@ namespace Curveball {
 			sorter_mem_size(sorter_mem_size_),
 			msg_limit(msg_limit_),
 			threads(threads_),
-			insertion_buffer_size(insertion_buffer_size_) {}
+			insertion_buffer_size(insertion_buffer_size_),
+			compressed_msgs(compressed_msgs_),
+			min_heavy_trade_degree(min_heavy_trade_degree_) {}
 	};
 
 	struct NeighbourMsg {
@@ -12,6 +12,7 @@
 #include <list>
 
 #include <stxxl/cmdline>
+#include <omp.h>
 
 #include <stack>
 #include <stxxl/vector>
@@ -30,6 +31,8 @@
 #include "SwapGenerator.h"
 
 #include <EdgeSwaps/EdgeSwapTFP.h>
+#include <EdgeSwaps/EdgeSwapFactory.h>
+#include <EdgeSwaps/SwapConvergenceMonitor.h>
 
 #include <ConfigurationModel/ConfigurationModelRandom.h>
 #include <SwapStream.h>
@@ -79,6 +82,15 @@ struct RunConfig {
 
     double randomSwapsInCMES;
 
+    double existenceFilterBits;
+    bool presortedSwaps;
+
+    EdgeSwapAlgorithm edgeSwapAlgo;
+    std::string calibrationFile;
+    unsigned int numThreads;
+
+    SwapConvergenceMonitor::Config swapConvergence;
+
     RunConfig()
             : numNodes(10 * IntScale::Mi)
             , minDeg(2)
@@ -99,6 +111,10 @@ struct RunConfig {
             , noRuns(8)
             , edgeSizeFactor(1)
             , randomSwapsInCMES(0)
+            , existenceFilterBits(0)
+            , presortedSwaps(false)
+            , edgeSwapAlgo(EdgeSwapAlgorithm::Auto)
+            , numThreads(omp_get_max_threads())
     {
         using myclock = std::chrono::high_resolution_clock;
         myclock::duration d = myclock::now() - myclock::time_point::min();
@@ -119,6 +135,7 @@ struct RunConfig {
         bool input_hh = false;
         bool input_cm = false;
         bool input_file = false;
+        std::string swap_algo_name;
 
 
         // setup and gather parameters
@@ -136,6 +153,13 @@ struct RunConfig {
             cp.add_bytes (CMDLINE_COMP('k', "batch-size", batchSize, "Batch size of PTFP"));
 
             cp.add_bytes (CMDLINE_COMP('i', "ram", internalMem, "Internal memory"));
+            cp.add_double(CMDLINE_COMP('E', "swap-edges-changed", swapConvergence.min_edges_changed, "Stop swaps once this fraction of edges changed; default: 0 (disabled)"));
+            cp.add_double(CMDLINE_COMP('T', "swap-assortativity-tol", swapConvergence.assortativity_tolerance, "Stop swaps once assortativity is stable within this tolerance; default: 0 (disabled)"));
+            cp.add_flag  (CMDLINE_COMP('P', "presorted-swaps", presortedSwaps, "Generate swap requests in edge order, skipping their sorting; ignores -E/-T"));
+            cp.add_double(CMDLINE_COMP('F', "existence-filter", existenceFilterBits, "Bits per edge of Bloom filter for existence requests; default: 0 (disabled)"));
+            cp.add_string(CMDLINE_COMP('e', "swap-algo", swap_algo_name, "SwapAlgo to use: IM, PIM, SEMI, TFP, PTFP, AUTO (default); -P and -F imply TFP"));
+            cp.add_string(CMDLINE_COMP('l', "calibration", calibrationFile, "Calibration file used by AUTO"));
+            cp.add_uint  (CMDLINE_COMP('t', "threads", numThreads, "Number of threads; default: all"));
 
             cp.add_flag  (CMDLINE_COMP('v', "verbose", verbose, "Include debug information selectable at runtime"));
 
@@ -158,6 +182,25 @@ struct RunConfig {
             }
         }
 
+        // select edge swap algo; presorted swaps and the existence filter are only supported by TFP
+        if (!swap_algo_name.empty()) {
+            try {
+                edgeSwapAlgo = EdgeSwapFactory::parse(swap_algo_name);
+            } catch (const std::invalid_argument & e) {
+                std::cerr << e.what() << std::endl;
+                cp.print_usage();
+                return false;
+            }
+        }
+
+        if (presortedSwaps || existenceFilterBits > 0) {
+            if (edgeSwapAlgo != EdgeSwapAlgorithm::Auto && edgeSwapAlgo != EdgeSwapAlgorithm::TFP) {
+                std::cerr << "Presorted swaps and the existence filter require the TFP swap algo" << std::endl;
+                return false;
+            }
+            edgeSwapAlgo = EdgeSwapAlgorithm::TFP;
+        }
+
         // set the input gamma value to the corresponding negative value
         if (gamma > 0)
             gamma = (-1.0) * gamma;
@@ -443,12 +486,39 @@ void benchmark(RunConfig & config) {
         } else  {
             SwapGenerator swap_gen(config.numSwaps, edge_stream.size(), stxxl::get_next_seed());
 
-            EdgeSwapTFP::EdgeSwapTFP swap_algo(edge_stream, config.runSize, config.numNodes, config.internalMem, writeSnapshots);
+            SwapConvergenceMonitor monitor(config.numNodes, config.swapConvergence);
+
+            auto callback = [&] (uint_t iteration) {
+                monitor.observe(edge_stream);
+                writeSnapshots(iteration);
+            };
+
+            if (config.edgeSwapAlgo == EdgeSwapAlgorithm::TFP) {
+                EdgeSwapTFP::EdgeSwapTFP swap_algo(edge_stream, config.runSize, config.numNodes, config.internalMem, callback);
+                swap_algo.setExistenceFilter(config.existenceFilterBits);
+
+                IOStatistics swap_report("Randomization");
+                if (config.presortedSwaps) {
+                    swap_algo.runPresorted(config.numSwaps, stxxl::get_next_seed());
+                } else {
+                    monitor.pushSwaps(swap_gen, swap_algo);
+                    swap_algo.run();
+                }
+
+            } else {
+                EdgeSwapCalibration calibration;
+                if (!config.calibrationFile.empty() && !calibration.load(config.calibrationFile)) {
+                    std::cerr << "Could not read calibration file " << config.calibrationFile << std::endl;
+                }
+
+                const EdgeSwapInstance instance(edge_stream.size(), config.numNodes, config.numSwaps, config.internalMem,
+                                                config.numThreads, config.runSize);
+                auto swap_algo = EdgeSwapFactory(calibration).create(edge_stream, instance, callback, config.edgeSwapAlgo);
+                std::cout << "Using edge swap algo: " << EdgeSwapFactory::name(swap_algo->algorithm()) << std::endl;
 
-            {
                 IOStatistics swap_report("Randomization");
-                StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
-                swap_algo.run();
+                monitor.pushSwaps(swap_gen, *swap_algo);
+                swap_algo->run();
             }
         }
     }
@@ -6,10 +6,12 @@
  */
 
 #include <iostream>
+#include <string>
 #include <chrono>
 #include <EdgeStream.h>
 #include <stxxl/cmdline>
 #include <Curveball/EMCurveball.h>
+#include <Curveball/IMCurveball.h>
 
 #include <HavelHakimi/HavelHakimiIMGenerator.h>
 
@@ -34,6 +36,10 @@ struct PowerlawBenchmarkParams {
     uint32_t num_batch_splits;
     stxxl::uint64 insertion_buffer_size;
     stxxl::uint64 num_max_msgs;
+    bool in_memory;
+    bool estimate_params;
+    std::string calibration_file;
+    bool compress_msgs;
 
     PowerlawBenchmarkParams() :
             num_rounds(1),
@@ -47,7 +53,10 @@ struct PowerlawBenchmarkParams {
             num_microchunk_splits(16),
             num_batch_splits(1),
             insertion_buffer_size(1000),
-            num_max_msgs(Curveball::DUMMY_LIMIT) // not a concern
+            num_max_msgs(Curveball::DUMMY_LIMIT), // not a concern
+            in_memory(false),
+            estimate_params(false),
+            compress_msgs(false)
     {
         using my_clock = std::chrono::high_resolution_clock;
         my_clock::duration d = my_clock::now() - my_clock::time_point::min();
@@ -78,6 +87,10 @@ struct PowerlawBenchmarkParams {
             cp.add_uint(CMDLINE_COMP('j', "num_batch_splits", num_batch_splits, "Number of Microchunk Multiplier in a Batch"));
             cp.add_bytes(CMDLINE_COMP('y', "insertion_buffer_size", insertion_buffer_size, "Insertion Buffer Size"));
             cp.add_bytes(CMDLINE_COMP('l', "num_max_msgs", num_max_msgs, "Number of Max. Messages in RAM"));
+            cp.add_flag(CMDLINE_COMP('I', "in_memory", in_memory, "Use the internal memory Curveball (ignores chunk parameters)"));
+            cp.add_flag(CMDLINE_COMP('E', "estimate", estimate_params, "Estimate the chunk parameters from the degrees and the internal memory"));
+            cp.add_string(CMDLINE_COMP('C', "calibration", calibration_file, "Calibration file used by the estimation"));
+            cp.add_flag(CMDLINE_COMP('Z', "compress", compress_msgs, "Compress the messages of the macrochunks"));
 
             if (!cp.process(argc, argv)) {
                 cp.print_usage();
@@ -126,22 +139,54 @@ void benchmark(const PowerlawBenchmarkParams& config) {
     edge_stream.rewind();
     degree_stream.rewind();
     IOStatistics cb_report;
-    Curveball::EMCurveball<Curveball::ModHash, decltype(degree_stream)> algo(edge_stream,
-                                                                             degree_stream,
-                                                                             config.num_nodes,
-                                                                             config.num_rounds,
-                                                                             out_edge_stream,
-                                                                             config.num_macrochunks,
-                                                                             config.num_microchunk_splits,
-                                                                             config.num_batch_splits,
-                                                                             config.internal_mem / 4,
-                                                                             config.internal_mem,
-                                                                             config.num_max_msgs,
-                                                                             config.num_threads,
-                                                                             config.insertion_buffer_size,
-                                                                             true);
-
-    algo.run();
+    if (config.in_memory) {
+        std::vector<degree_t> degrees;
+        degrees.reserve(config.num_nodes);
+        for (; !degree_stream.empty(); ++degree_stream)
+            degrees.push_back(*degree_stream);
+
+        Curveball::IMCurveball<Curveball::ModHash> algo(degrees, config.num_rounds, config.num_threads);
+        for (; !edge_stream.empty(); ++edge_stream)
+            algo.push(*edge_stream);
+
+        algo.run();
+        algo.forward_edges(out_edge_stream);
+    } else if (config.estimate_params) {
+        Curveball::CurveballCalibration calibration;
+        if (!config.calibration_file.empty() && !calibration.load(config.calibration_file))
+            std::cerr << "Could not read calibration file " << config.calibration_file << std::endl;
+
+        Curveball::EMCurveball<Curveball::ModHash, decltype(degree_stream)> algo(edge_stream,
+                                                                                 degree_stream,
+                                                                                 config.num_nodes,
+                                                                                 config.num_rounds,
+                                                                                 out_edge_stream,
+                                                                                 config.num_threads,
+                                                                                 config.internal_mem,
+                                                                                 true,
+                                                                                 calibration);
+
+        algo.set_compressed_messages(config.compress_msgs);
+        algo.run();
+    } else {
+        Curveball::EMCurveball<Curveball::ModHash, decltype(degree_stream)> algo(edge_stream,
+                                                                                 degree_stream,
+                                                                                 config.num_nodes,
+                                                                                 config.num_rounds,
+                                                                                 out_edge_stream,
+                                                                                 config.num_macrochunks,
+                                                                                 config.num_microchunk_splits,
+                                                                                 config.num_batch_splits,
+                                                                                 config.internal_mem / 4,
+                                                                                 config.internal_mem,
+                                                                                 config.num_max_msgs,
+                                                                                 config.num_threads,
+                                                                                 config.insertion_buffer_size,
+                                                                                 true);
+
+        algo.set_compressed_messages(config.compress_msgs);
+        algo.run();
+    }
     cb_report.report("CurveballStats");
 
     std::cout << "Initial edgecount " << edge_stream.size() << std::endl;
@@ -5,6 +5,7 @@
 #include <locale>
 
 #include <stxxl/cmdline>
+#include <omp.h>
 
 #include <stack>
 #include <stxxl/vector>
@@ -20,17 +21,8 @@
 #include <DegreeDistributionCheck.h>
 #include "SwapGenerator.h"
 
-#include <EdgeSwaps/EdgeSwapParallelTFP.h>
-#include <EdgeSwaps/EdgeSwapInternalSwaps.h>
-#include <EdgeSwaps/EdgeSwapTFP.h>
-#include <EdgeSwaps/IMEdgeSwap.h>
-
-enum EdgeSwapAlgo {
-    IM,
-    SEMI, // InternalSwaps
-    TFP,
-    PTFP
-};
+#include <Utils/ScopedTimer.hpp>
+#include <EdgeSwaps/EdgeSwapFactory.h>
 
 struct RunConfig {
     stxxl::uint64 numNodes;
@@ -44,10 +36,13 @@ struct RunConfig {
     stxxl::uint64 batchSize;
 
     stxxl::uint64 internalMem;
+    unsigned int numThreads;
 
     unsigned int randomSeed;
 
-    EdgeSwapAlgo edgeSwapAlgo;
+    EdgeSwapAlgorithm edgeSwapAlgo;
+    std::string calibrationFile;
+    std::string recordCalibrationFile;
 
     bool verbose;
 
@@ -69,9 +64,12 @@ struct RunConfig {
         , scaleDegree(1.0)
 
         , numSwaps(numNodes)
-        , runSize(numNodes/10)
+        , runSize(0)
         , batchSize(IntScale::Mi)
         , internalMem(8 * IntScale::Gi)
+        , numThreads(omp_get_max_threads())
+
+        , edgeSwapAlgo(EdgeSwapAlgorithm::Auto)
 
         , verbose(false)
         , factorNoSwaps(-1)
@@ -108,12 +106,15 @@ struct RunConfig {
             cp.add_uint  (CMDLINE_COMP('s', "seed",      randomSeed,   "Initial seed for PRNG"));
 
             cp.add_bytes  (CMDLINE_COMP('m', "num-swaps", numSwaps,   "Number of swaps to perform"));
-            cp.add_bytes  (CMDLINE_COMP('r', "run-size", runSize, "Number of swaps per graph scan"));
+            cp.add_bytes  (CMDLINE_COMP('r', "run-size", runSize, "Number of swaps per graph scan; default: chosen per algo"));
             cp.add_bytes  (CMDLINE_COMP('k', "batch-size", batchSize, "Batch size of PTFP"));
 
             cp.add_bytes  (CMDLINE_COMP('i', "ram", internalMem, "Internal memory"));
+            cp.add_uint   (CMDLINE_COMP('t', "threads", numThreads, "Number of threads; default: all"));
 
-            cp.add_string(CMDLINE_COMP('e', "swap-algo", swap_algo_name, "SwapAlgo to use: IM, SEMI, TFP, PTFP (default)"));
+            cp.add_string(CMDLINE_COMP('e', "swap-algo", swap_algo_name, "SwapAlgo to use: IM, PIM, SEMI, TFP, PTFP, AUTO (default)"));
+            cp.add_string(CMDLINE_COMP('l', "calibration", calibrationFile, "Calibration file used by AUTO"));
+            cp.add_string(CMDLINE_COMP('L', "record-calibration", recordCalibrationFile, "Append the running time of the swaps to this calibration file"));
 
             cp.add_flag(CMDLINE_COMP('v', "verbose", verbose, "Include debug information selectable at runtime"));
 
@@ -134,20 +135,14 @@ struct RunConfig {
         }
 
         // select edge swap algo
-        {
-            std::transform(swap_algo_name.begin(), swap_algo_name.end(), swap_algo_name.begin(), ::toupper);
-
-            if      (swap_algo_name.empty() ||
-                     0 == swap_algo_name.compare("PTFP")) { edgeSwapAlgo = PTFP; }
-            else if (0 == swap_algo_name.compare("TFP"))  { edgeSwapAlgo = TFP; }
-            else if (0 == swap_algo_name.compare("SEMI")) { edgeSwapAlgo = SEMI; }
-            else if (0 == swap_algo_name.compare("IM"))   { edgeSwapAlgo = IM; }
-            else {
-                std::cerr << "Invalid edge swap algorithm specified: " << swap_algo_name << std::endl;
+        if (!swap_algo_name.empty()) {
+            try {
+                edgeSwapAlgo = EdgeSwapFactory::parse(swap_algo_name);
+            } catch (const std::invalid_argument & e) {
+                std::cerr << e.what() << std::endl;
                 cp.print_usage();
                 return false;
             }
-            std::cout << "Using edge swap algo: " << swap_algo_name << std::endl;
         }
 
         if (runSize > std::numeric_limits<swapid_t>::max()) {
@@ -229,41 +224,42 @@ void benchmark(RunConfig & config) {
 
     // Perform edge swaps
     {
+        EdgeSwapCalibration calibration;
+        if (!config.calibrationFile.empty() && !calibration.load(config.calibrationFile)) {
+            std::cerr << "Could not read calibration file " << config.calibrationFile << std::endl;
+        }
 
-        switch (config.edgeSwapAlgo) {
-            case IM: {
-                IMEdgeSwap swap_algo(edge_stream);
-                StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
-                swap_algo.run();
-                break;
-            }
+        const EdgeSwapFactory factory(calibration);
+        const EdgeSwapInstance instance(edge_stream.size(), config.numNodes, config.numSwaps, config.internalMem,
+                                        config.numThreads, config.runSize);
 
-            case SEMI: {
-                EdgeSwapInternalSwaps swap_algo(edge_stream, config.runSize);
-                StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
-                swap_algo.run();
-                break;
-            }
+        const EdgeSwapAlgorithm algo = (config.edgeSwapAlgo == EdgeSwapAlgorithm::Auto)
+                                     ? factory.select(instance) : config.edgeSwapAlgo;
+        const EdgeSwapInstance used_instance = EdgeSwapFactory::withRunLength(algo, instance);
 
-            case TFP: {
-                const swapid_t runSize = edge_stream.size() / 8;
+        std::cout << "Using edge swap algo: " << EdgeSwapFactory::name(algo)
+                  << " (run length " << used_instance.run_length << ")" << std::endl;
 
-                EdgeSwapTFP::EdgeSwapTFP swap_algo(edge_stream, runSize, config.numNodes, config.internalMem);
-                {
-                    IOStatistics swap_report("SwapStats");
-                    StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
-                    swap_algo.run();
-                }
+        double milliseconds = 0.0;
+        {
+            IOStatistics swap_report("SwapStats");
+            ScopedTimer timer(milliseconds);
 
-                edge_stream.consume();
-                break;
-            }
+            auto swap_algo = factory.create(edge_stream, used_instance, nullptr, algo);
+            StreamPusher<decltype(swap_gen), EdgeSwapEngine>(swap_gen, *swap_algo);
+            swap_algo->run();
+        }
+
+        edge_stream.consume();
+
+        if (!config.recordCalibrationFile.empty()) {
+            const EdgeSwapCalibration::Measurement measurement {
+                algo, static_cast<int>(config.numThreads), edge_stream.size(),
+                config.numSwaps, used_instance.run_length, 1e-3 * milliseconds
+            };
 
-            case PTFP: {
-                EdgeSwapParallelTFP::EdgeSwapParallelTFP swap_algo(edge_stream, config.runSize);
-                StreamPusher<decltype(swap_gen), decltype(swap_algo)>(swap_gen, swap_algo);
-                swap_algo.run();
-                break;
+            if (!EdgeSwapCalibration::append(config.recordCalibrationFile, measurement)) {
+                std::cerr << "Could not write calibration file " << config.recordCalibrationFile << std::endl;
             }
         }
     }
@@ -28,6 +28,12 @@ class RunConfig {
 	  node_distribution_param.numberOfNodes = number_of_nodes;
       node_distribution_param.scale = 1.0;
 
+	  // unspecified out-degree parameters default to the in-degree parameters
+	  out_degree_distribution_param = node_distribution_param;
+	  if (node_out_gamma) out_degree_distribution_param.exponent = node_out_gamma;
+	  if (node_min_out_degree) out_degree_distribution_param.minDegree = node_min_out_degree;
+	  if (node_max_out_degree) out_degree_distribution_param.maxDegree = node_max_out_degree;
+
 	  community_distribution_param.exponent = community_gamma;
       assert(community_gamma < 0);
 	  community_distribution_param.minDegree = community_min_members;
@@ -64,11 +70,31 @@ public:
   MonotonicPowerlawRandomStream<false>::Parameters node_distribution_param;
   MonotonicPowerlawRandomStream<false>::Parameters community_distribution_param;
 
+  bool directed = false;
+  stxxl::uint64 node_min_out_degree = 0;
+  stxxl::uint64 node_max_out_degree = 0;
+  double node_out_gamma = 0.0;
+  MonotonicPowerlawRandomStream<false>::Parameters out_degree_distribution_param;
+
+  bool weighted = false;
+  double weight_exponent = 1.5;
+  double weight_mixing = -1.0;
+
   unsigned int lfr_bench_rounds;
   bool lfr_bench_comassign;
   bool lfr_bench_comassign_retry;
 
   double community_rewiring_random = 1.0;
+  bool community_rewiring_per_community = false;
+
+  SwapConvergenceMonitor::Config swap_convergence;
+
+  std::string community_randomisation_name, global_randomisation_name;
+  LFR::RandomisationMethod community_randomisation = LFR::edgeSwaps;
+  LFR::RandomisationMethod global_randomisation = LFR::edgeSwaps;
+
+  std::string global_generation_name;
+  LFR::GlobalGenerationMethod global_generation = LFR::havelHakimi;
 
   RunConfig() :
 	  number_of_nodes      (100000),
@@ -112,10 +138,21 @@ public:
 	  cp.add_bytes (CMDLINE_COMP('a', "node-max-degree",   node_max_degree,   "Maximum node degree"));
 	  cp.add_double(CMDLINE_COMP('j', "node-gamma",        node_gamma,        "Exponent of node degree distribution"));
 
+	  cp.add_flag  (CMDLINE_COMP('D', "directed", directed, "Generate a directed graph; the node degree parameters then apply to the in-degrees. Requires disjoint communities and edge swaps"));
+	  cp.add_bytes (CMDLINE_COMP('u', "node-min-out-degree", node_min_out_degree, "Minimum out-degree of a directed graph; default: node-min-degree"));
+	  cp.add_bytes (CMDLINE_COMP('v', "node-max-out-degree", node_max_out_degree, "Maximum out-degree of a directed graph; default: node-max-degree"));
+	  cp.add_double(CMDLINE_COMP('w', "node-out-gamma",      node_out_gamma,      "Exponent of the out-degree distribution of a directed graph; default: node-gamma"));
+
 	  cp.add_bytes (CMDLINE_COMP('x', "community-min-members",   community_min_members,   "Minumum community size"));
 	  cp.add_bytes (CMDLINE_COMP('y', "community-max-members",   community_max_members,   "Maximum community size"));
 	  cp.add_double(CMDLINE_COMP('z', "community-gamma",         community_gamma,         "Exponent of community size distribution"));
 	  cp.add_double(CMDLINE_COMP('r', "community-rewiring-random", community_rewiring_random, "Fraction of addition random swaps to duplicate swaps"));
+	  cp.add_flag  (CMDLINE_COMP('P', "community-rewiring-per-community", community_rewiring_per_community, "Rewire communities with duplicate edges independently in parallel"));
+	  cp.add_double(CMDLINE_COMP('E', "swap-edges-changed", swap_convergence.min_edges_changed, "Stop swaps once this fraction of edges changed; default: 0 (disabled)"));
+	  cp.add_double(CMDLINE_COMP('A', "swap-assortativity-tol", swap_convergence.assortativity_tolerance, "Stop swaps once assortativity is stable within this tolerance; default: 0 (disabled)"));
+	  cp.add_string(CMDLINE_COMP('R', "community-randomisation", community_randomisation_name, "Randomisation of community graphs; SWAPS (default) or CURVEBALL"));
+	  cp.add_string(CMDLINE_COMP('G', "global-randomisation", global_randomisation_name, "Randomisation of the global graph; SWAPS (default) or CURVEBALL"));
+	  cp.add_string(CMDLINE_COMP('H', "global-generation", global_generation_name, "Generator of the global graph; HAVELHAKIMI (default) or STUBMATCHING, which avoids intra-community edges"));
 
 	  cp.add_uint  (CMDLINE_COMP('s', "seed",      randomSeed,   "Initial seed for PRNG"));
 
@@ -123,6 +160,10 @@ public:
 	  cp.add_bytes (CMDLINE_COMP('k', "overlap-members",   overlap_degree,   "Maximum node degree"));
 
 	  cp.add_double(CMDLINE_COMP('m', "mixing",        mixing,         "Fraction node edge being inter-community"));
+
+	  cp.add_flag  (CMDLINE_COMP('W', "weighted", weighted, "Assign edge weights; they are written with output file type EDGELIST"));
+	  cp.add_double(CMDLINE_COMP('B', "weight-exponent", weight_exponent, "Exponent beta of the node strength s = k^beta; default: 1.5"));
+	  cp.add_double(CMDLINE_COMP('M', "weight-mixing", weight_mixing, "Fraction of node strength on inter-community edges; default: mixing"));
 	  cp.add_bytes(CMDLINE_COMP('b', "max-bytes", max_bytes, "Maximum number of bytes of main memory to use"));
 
 	  cp.add_string(CMDLINE_COMP('o', "output", output_filename, "Output filename; the generated graph will be written as METIS graph"));
@@ -161,11 +202,43 @@ public:
 		  std::cout << "Using filetype: " << output_filetype << std::endl;
 	  }
 
+	  // select randomisation algorithms
+	  {
+		  auto parse_randomisation = [&] (std::string name, LFR::RandomisationMethod & method) {
+			  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+			  if      (name.empty() || 0 == name.compare("SWAPS")) { method = LFR::edgeSwaps; }
+			  else if (0 == name.compare("CURVEBALL")) { method = LFR::curveball; }
+			  else {
+				  std::cerr << "Invalid randomisation " << name << " specified, use SWAPS or CURVEBALL" << std::endl;
+				  cp.print_usage();
+				  return false;
+			  }
+			  return true;
+		  };
+
+		  if (!parse_randomisation(community_randomisation_name, community_randomisation) ||
+			  !parse_randomisation(global_randomisation_name, global_randomisation))
+			  return false;
+
+		  std::transform(global_generation_name.begin(), global_generation_name.end(), global_generation_name.begin(), ::toupper);
+
+		  if      (global_generation_name.empty() || 0 == global_generation_name.compare("HAVELHAKIMI")) { global_generation = LFR::havelHakimi; }
+		  else if (0 == global_generation_name.compare("STUBMATCHING")) { global_generation = LFR::stubMatching; }
+		  else {
+			  std::cerr << "Invalid global generation " << global_generation_name << " specified, use HAVELHAKIMI or STUBMATCHING" << std::endl;
+			  cp.print_usage();
+			  return false;
+		  }
+	  }
+
         // set community and node gamma to corresponding negative value
         if (community_gamma > 0)
             community_gamma = (-1.0) * community_gamma;
         if (node_gamma > 0)
             node_gamma = (-1.0) * node_gamma;
+        if (node_out_gamma > 0)
+            node_out_gamma = (-1.0) * node_out_gamma;
 
         if (community_rewiring_random < 0) {
             std::cerr << "community-rewiring-random has to be non-negative" << std::endl;
@@ -182,6 +255,38 @@ public:
             return false;
 	}
 
+        if (node_out_gamma != 0.0 && node_out_gamma > -1.0) {
+            std::cerr << "node-out-gamma has to be at least 1" << std::endl;
+            return false;
+        }
+
+        if (directed && overlapping_nodes > 0) {
+            std::cerr << "Directed graphs only support disjoint communities" << std::endl;
+            return false;
+        }
+
+        if (directed && (community_randomisation == LFR::curveball || global_randomisation == LFR::curveball)) {
+            std::cerr << "Directed graphs can only be randomised with SWAPS" << std::endl;
+            return false;
+        }
+
+        if (weighted) {
+            if (weight_mixing < 0)
+                weight_mixing = mixing;
+
+            if (weight_mixing > 1) {
+                std::cerr << "weight-mixing has to be at most 1" << std::endl;
+                return false;
+            }
+
+            if (outputFileType != EDGELIST)
+                std::cerr << "Warning: edge weights are only written with output file type EDGELIST" << std::endl;
+        }
+
+        if (directed && (outputFileType == METIS || outputFileType == SNAP)) {
+            std::cerr << "Warning: the output file type treats the directed edges as undirected, consider EDGELIST" << std::endl;
+        }
+
 
 	  cp.print_result();
 
@@ -224,6 +329,14 @@ int main(int argc, char* argv[]) {
 	lfr.setOverlap(LFR::OverlapMethod::constDegree, oconfig);
 
 	lfr.setCommunityRewiringRandom(config.community_rewiring_random);
+	lfr.setCommunityRewiringPerCommunity(config.community_rewiring_per_community);
+	lfr.setSwapConvergence(config.swap_convergence);
+	lfr.setRandomisation(config.community_randomisation, config.global_randomisation);
+	lfr.setGlobalGeneration(config.global_generation);
+	if (config.directed)
+		lfr.setDirected(config.out_degree_distribution_param);
+	if (config.weighted)
+		lfr.setWeighted(config.weight_exponent, config.weight_mixing);
 
 	if (config.lfr_bench_comassign) {
 		LFR::LFRCommunityAssignBenchmark bench(lfr);
@@ -247,7 +360,13 @@ int main(int argc, char* argv[]) {
 						export_as_thrillbin_sorted(lfr.get_edges(), config.output_filename,  config.node_distribution_param.numberOfNodes);
 						break;
 					case EDGELIST:
-						export_as_edgelist(lfr.get_edges(), config.output_filename);
+						// the edges are sorted already; directed edges must not be normalised
+						if (config.weighted)
+							export_as_edgelist_in_order(lfr.get_edges(), config.output_filename, &lfr.get_edge_weights());
+						else if (config.directed)
+							export_as_edgelist_in_order(lfr.get_edges(), config.output_filename);
+						else
+							export_as_edgelist(lfr.get_edges(), config.output_filename);
 						break;
 					case SNAP:
 						export_as_snap(lfr.get_edges(), config.node_distribution_param.numberOfNodes, config.output_filename);
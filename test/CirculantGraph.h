@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <defs.h>
+
+/**
+ * Sorted edge list of a circulant graph, i.e. each node is connected to the k nodes
+ * following it at distances offset, ..., offset + k - 1 (modulo num_nodes).
+ * Undirected edges are normalized, directed ones point from a node to its successors.
+ */
+inline std::vector<edge_t> circulant_graph(node_t num_nodes, node_t k, bool directed = false, node_t offset = 1) {
+    std::vector<edge_t> edge_list;
+    edge_list.reserve(static_cast<size_t>(num_nodes) * k);
+
+    for(node_t u = 0; u < num_nodes; ++u) {
+        for(node_t i = 0; i < k; ++i) {
+            edge_t e(u, (u + offset + i) % num_nodes);
+            if (!directed)
+                e.normalize();
+            edge_list.push_back(e);
+        }
+    }
+    std::sort(edge_list.begin(), edge_list.end());
+
+    return edge_list;
+}
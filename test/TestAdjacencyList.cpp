@@ -189,6 +189,16 @@ TEST_F(TestAdjacencyList, parallel_insertion) {
 	EXPECT_EQ(adj_list.received_msgs(1), NUM_THREADS * 100);
 	EXPECT_EQ(adj_list.received_msgs(2), NUM_THREADS * 100);
 	EXPECT_EQ(adj_list.received_msgs(3), NUM_THREADS * 100);
+
+	// no slot is written twice
+	for (node_t k = 0; k < 4; k++) {
+		std::vector<int> counts(static_cast<size_t>(NUM_THREADS), 0);
+		for (auto it = adj_list.cbegin(k); it != adj_list.cend(k); it++)
+			counts[*it]++;
+
+		for (node_t j = 0; j < NUM_THREADS; j++)
+			EXPECT_EQ(counts[j], 100);
+	}
 }
 
 TEST_F(TestAdjacencyList, organize_neighbours_sort) {
@@ -1,7 +1,48 @@
 #include <gtest/gtest.h>
 #include <LFR/CommunityEdgeRewiringSwaps.h>
 
-class TestCommunityRewiring : public ::testing::Test { };
+class TestCommunityRewiring : public ::testing::Test {
+protected:
+	using edge_community_vector_t = stxxl::vector<LFR::CommunityEdge>;
+	static constexpr node_t num_nodes = 200;
+	static constexpr community_t num_communities = 3;
+
+	// communities 0 and 1 are identical circulant graphs, community 2 overlaps with half of them
+	void _overlapping_communities(std::vector<LFR::CommunityEdge> & input, std::vector<std::vector<degree_t>> & degrees) {
+		degrees.assign(num_communities, std::vector<degree_t>(2 * num_nodes, 0));
+		for (community_t com = 0; com < num_communities; ++com) {
+			const node_t offset = (com == 2) ? num_nodes / 2 : 0;
+			for (node_t u = 0; u < num_nodes; ++u) {
+				for (node_t i = 1; i <= 3; ++i) {
+					edge_t e(offset + u, offset + (u + i) % num_nodes);
+					e.normalize();
+					input.emplace_back(com, e);
+					degrees[com][e.first]++;
+					degrees[com][e.second]++;
+				}
+			}
+		}
+		std::sort(input.begin(), input.end());
+	}
+
+	// the rewired edges are simple and preserve the degrees within each community
+	void _check(const edge_community_vector_t & edges, size_t num_edges, std::vector<std::vector<degree_t>> degrees) {
+		ASSERT_EQ(edges.size(), num_edges);
+
+		LFR::CommunityEdge prev = LFR::CommunityEdge(0, edge_t::invalid());
+		for (auto it = edges.cbegin(); it != edges.cend(); ++it) {
+			ASSERT_NE(prev.edge, it->edge);
+			ASSERT_FALSE(it->edge.is_loop());
+			degrees[it->community_id][it->edge.first]--;
+			degrees[it->community_id][it->edge.second]--;
+			prev = *it;
+		}
+
+		for (const auto & com_degrees : degrees)
+			for (const auto & d : com_degrees)
+				ASSERT_EQ(d, 0);
+	}
+};
 
 TEST_F(TestCommunityRewiring, testTwoCommunities) {
 	using edge_community_vector_t = stxxl::vector<LFR::CommunityEdge>;
@@ -22,3 +63,40 @@ TEST_F(TestCommunityRewiring, testTwoCommunities) {
 		EXPECT_NE(prev.edge, it->edge);
 	}
 };
+
+TEST_F(TestCommunityRewiring, testPerCommunity) {
+	std::vector<LFR::CommunityEdge> input;
+	std::vector<std::vector<degree_t>> degrees;
+	_overlapping_communities(input, degrees);
+
+	edge_community_vector_t edges;
+	for (const auto & e : input)
+		edges.push_back(e);
+
+	CommunityEdgeRewiringSwaps rewiring(edges, input.size(), 0.5, true);
+	rewiring.run();
+
+	_check(edges, input.size(), degrees);
+}
+
+TEST_F(TestCommunityRewiring, testPerCommunityBudget) {
+	std::vector<LFR::CommunityEdge> input;
+	std::vector<std::vector<degree_t>> degrees;
+	_overlapping_communities(input, degrees);
+
+	edge_community_vector_t edges;
+	for (const auto & e : input)
+		edges.push_back(e);
+
+	// the budget suffices for two of the three communities per iteration
+	CommunityEdgeRewiringSwaps rewiring(edges, 2 * input.size() / num_communities, 0.5, true);
+	rewiring.run();
+
+	_check(edges, input.size(), degrees);
+
+	const auto & per_iteration = rewiring.communities_per_iteration();
+	ASSERT_FALSE(per_iteration.empty());
+	ASSERT_EQ(per_iteration.front(), 2);
+	for (const auto & num_coms : per_iteration)
+		ASSERT_LE(num_coms, 2);
+}
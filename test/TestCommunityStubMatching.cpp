@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <LFR/CommunityStubMatching.h>
+
+class TestCommunityStubMatching : public ::testing::Test { };
+
+TEST_F(TestCommunityStubMatching, noIntraCommunityEdges) {
+    constexpr node_t num_nodes = 1000;
+    constexpr node_t community_size = 10;
+    constexpr degree_t degree = 6;
+
+    // every node is member of two overlapping communities
+    stxxl::vector<LFR::CommunityAssignment> assignments;
+    for (node_t u = 0; u < num_nodes; ++u) {
+        assignments.push_back(LFR::CommunityAssignment(u / community_size, 1, u));
+        assignments.push_back(LFR::CommunityAssignment(num_nodes / community_size + (u + community_size / 2) % num_nodes / community_size, 1, u));
+    }
+
+    auto community = [&] (node_t u, int i) {
+        return i ? num_nodes / community_size + (u + community_size / 2) % num_nodes / community_size : u / community_size;
+    };
+
+    CommunityStubMatching gen(assignments, 1234);
+    for (node_t u = 0; u < num_nodes; ++u)
+        gen.push(degree);
+    gen.generate();
+
+    std::vector<degree_t> degrees(num_nodes, 0);
+    edge_t last = edge_t::invalid();
+    edgeid_t num_edges = 0;
+    for (; !gen.empty(); ++gen, ++num_edges) {
+        const edge_t e = *gen;
+        ASSERT_LT(e.first, e.second);
+        ASSERT_TRUE(last.is_invalid() || last < e);
+
+        for (int i = 0; i < 2; ++i)
+            for (int j = 0; j < 2; ++j)
+                ASSERT_NE(community(e.first, i), community(e.second, j));
+
+        degrees[e.first]++;
+        degrees[e.second]++;
+        last = e;
+    }
+
+    ASSERT_EQ(2 * num_edges + gen.unmatchedStubs(), static_cast<edgeid_t>(num_nodes * degree));
+    ASSERT_LT(gen.unmatchedStubs(), num_nodes * degree / 100);
+
+    for (const auto & d : degrees)
+        ASSERT_LE(d, degree);
+}
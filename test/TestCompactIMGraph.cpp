@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <IMGraph.h>
+#include <CompactIMGraph.h>
+#include <SwapGenerator.h>
+
+class TestCompactIMGraph : public ::testing::Test {};
+
+TEST_F(TestCompactIMGraph, againstIMGraph) {
+    // star-like graph with a few hubs, s.t. IMGraph places nodes in its adjacency matrix
+    constexpr node_t num_nodes = 2000;
+    constexpr node_t num_hubs = 20;
+
+    std::vector<edge_t> edges;
+    for(node_t hub = 0; hub < num_hubs; ++hub) {
+        for(node_t v = hub + 1; v < num_nodes; v += 1 + hub)
+            edges.emplace_back(hub, v);
+    }
+    for(node_t u = num_hubs; u + 1 < num_nodes; u += 2)
+        edges.emplace_back(u, u + 1);
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<degree_t> degrees(num_nodes, 0);
+    for(const auto & e : edges) {
+        degrees[e.first]++;
+        degrees[e.second]++;
+    }
+
+    IMGraph reference(degrees);
+    CompactIMGraph graph(degrees);
+    for(const auto & e : edges) {
+        reference.addEdge(e);
+        graph.addEdge(e);
+    }
+
+    ASSERT_EQ(graph.numEdges(), edges.size());
+    ASSERT_LT(CompactIMGraph::memoryUsage(num_nodes, edges.size()), IMGraph::memoryUsage(num_nodes, edges.size()));
+
+    uint_t performed = 0;
+    for(SwapGenerator gen(20 * edges.size(), edges.size(), 1234); !gen.empty(); ++gen) {
+        const auto & swap = *gen;
+        const auto ref_result = reference.swapEdges(swap.edges()[0], swap.edges()[1], swap.direction());
+        const auto result = graph.swapEdges(swap.edges()[0], swap.edges()[1], swap.direction());
+
+        ASSERT_EQ(result.performed, ref_result.performed);
+        ASSERT_EQ(result.loop, ref_result.loop);
+        ASSERT_EQ(result.edges[0], ref_result.edges[0]);
+        ASSERT_EQ(result.edges[1], ref_result.edges[1]);
+        if (!result.loop) {
+            ASSERT_EQ(result.conflictDetected[0], ref_result.conflictDetected[0]);
+            ASSERT_EQ(result.conflictDetected[1], ref_result.conflictDetected[1]);
+        }
+
+        performed += result.performed;
+    }
+
+    ASSERT_GT(performed, edges.size());
+
+    std::vector<edge_t> ref_edges, compact_edges;
+    for(auto it = reference.getEdges(); !it.empty(); ++it)
+        ref_edges.push_back(*it);
+    for(auto it = graph.getEdges(); !it.empty(); ++it)
+        compact_edges.push_back(*it);
+
+    std::sort(ref_edges.begin(), ref_edges.end());
+    std::sort(compact_edges.begin(), compact_edges.end());
+    ASSERT_EQ(compact_edges, ref_edges);
+
+    for(const auto & e : compact_edges)
+        ASSERT_TRUE(graph.hasEdge(e.second, e.first));
+}
@@ -16,10 +16,23 @@
 #include <Utils/StreamPusherRedirectStream.h>
 #include <Utils/Hashfuncs.h>
 #include <Utils/NodeHash.h>
+#include "CirculantGraph.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+template <typename HashFactory>
 class TestCurveball : public ::testing::Test { };
 
-TEST_F(TestCurveball, pld_instance_without_paramest) {
+using TestCurveballHashFactories = ::testing::Types<Curveball::ModHash, Curveball::FeistelHash>;
+
+TYPED_TEST_CASE(TestCurveball, TestCurveballHashFactories);
+
+class TestCurveballThreadBounds : public ::testing::Test { };
+
+TYPED_TEST(TestCurveball, pld_instance_without_paramest) {
     // Config
     const node_t num_nodes = 4000;
     const degree_t min_deg = 5;
@@ -49,19 +62,19 @@ TEST_F(TestCurveball, pld_instance_without_paramest) {
     // Run algorithm
     edge_stream.rewind();
     degree_stream.rewind();
-    Curveball::EMCurveball<Curveball::ModHash, decltype(degree_stream)> algo(edge_stream,
-                                                                             degree_stream,
-                                                                             num_nodes,
-                                                                             num_rounds,
-                                                                             out_edge_stream,
-                                                                             num_macrochunks,
-                                                                             num_batches,
-                                                                             num_fanout,
-                                                                             2 * Curveball::UIntScale::Gi,
-                                                                             2 * Curveball::UIntScale::Gi,
-                                                                             num_max_msgs,
-                                                                             num_threads,
-                                                                             insertion_buffer_size);
+    Curveball::EMCurveball<TypeParam, decltype(degree_stream)> algo(edge_stream,
+                                                                    degree_stream,
+                                                                    num_nodes,
+                                                                    num_rounds,
+                                                                    out_edge_stream,
+                                                                    num_macrochunks,
+                                                                    num_batches,
+                                                                    num_fanout,
+                                                                    2 * Curveball::UIntScale::Gi,
+                                                                    2 * Curveball::UIntScale::Gi,
+                                                                    num_max_msgs,
+                                                                    num_threads,
+                                                                    insertion_buffer_size);
 
     algo.run();
 
@@ -85,7 +98,7 @@ TEST_F(TestCurveball, pld_instance_without_paramest) {
     }
 }
 
-TEST_F(TestCurveball, pld_instance_with_paramest) {
+TYPED_TEST(TestCurveball, pld_instance_with_paramest) {
     // Config
     const node_t num_nodes = 16000;
     const degree_t min_deg = 5;
@@ -109,14 +122,14 @@ TEST_F(TestCurveball, pld_instance_with_paramest) {
     // Run algorithm
     edge_stream.rewind();
     degree_stream.rewind();
-    Curveball::EMCurveball<Curveball::ModHash, decltype(degree_stream)> algo(edge_stream,
-                                                                             degree_stream,
-                                                                             num_nodes,
-                                                                             num_rounds,
-                                                                             out_edge_stream,
-                                                                             omp_get_max_threads(),
-                                                                             8 * Curveball::UIntScale::Gi,
-                                                                             true);
+    Curveball::EMCurveball<TypeParam, decltype(degree_stream)> algo(edge_stream,
+                                                                    degree_stream,
+                                                                    num_nodes,
+                                                                    num_rounds,
+                                                                    out_edge_stream,
+                                                                    omp_get_max_threads(),
+                                                                    8 * Curveball::UIntScale::Gi,
+                                                                    true);
 
     algo.run();
 
@@ -139,3 +152,340 @@ TEST_F(TestCurveball, pld_instance_with_paramest) {
         ASSERT_EQ(*degree_stream, static_cast<degree_t>((*token_count).count));
     }
 }
+
+TYPED_TEST(TestCurveball, pld_instance_resume_checkpoint) {
+    // Config
+    const node_t num_nodes = 4000;
+    const degree_t min_deg = 5;
+    const degree_t max_deg = 100;
+    const std::string checkpoint_file = "curveball_test.checkpoint";
+
+    // Build edge list
+    EdgeStream edge_stream;
+    EdgeStream out_edge_stream;
+
+    HavelHakimiIMGeneratorWithDegrees hh_gen(HavelHakimiIMGeneratorWithDegrees::PushDirection::DecreasingDegree);
+    MonotonicPowerlawRandomStream<false> degree_sequence(min_deg, max_deg, -2.0, num_nodes, 1.0, stxxl::get_next_seed());
+
+    StreamPusher<decltype(degree_sequence), decltype(hh_gen)>(degree_sequence, hh_gen);
+    hh_gen.generate();
+    StreamPusher<decltype(hh_gen), EdgeStream>(hh_gen, edge_stream);
+    hh_gen.finalize();
+
+    auto & degree_stream = hh_gen.get_degree_stream();
+
+    // Run three rounds writing checkpoints
+    edge_stream.rewind();
+    degree_stream.rewind();
+    {
+        Curveball::EMCurveball<TypeParam, decltype(degree_stream)> algo(edge_stream,
+                                                                        degree_stream,
+                                                                        num_nodes,
+                                                                        3,
+                                                                        out_edge_stream,
+                                                                        omp_get_max_threads(),
+                                                                        8 * Curveball::UIntScale::Gi,
+                                                                        true);
+        algo.set_checkpointing(checkpoint_file, 2);
+        algo.run();
+    }
+
+    // Extend the finished run by two rounds
+    edge_stream.rewind();
+    degree_stream.rewind();
+    {
+        Curveball::EMCurveball<TypeParam, decltype(degree_stream)> algo(edge_stream,
+                                                                        degree_stream,
+                                                                        num_nodes,
+                                                                        3,
+                                                                        out_edge_stream,
+                                                                        omp_get_max_threads(),
+                                                                        8 * Curveball::UIntScale::Gi,
+                                                                        true);
+        algo.resume(checkpoint_file, 2);
+    }
+    std::remove(checkpoint_file.c_str());
+
+    // Check edge count
+    ASSERT_EQ(out_edge_stream.size(), edge_stream.size());
+
+    // Check degrees
+    stxxl::sorter<node_t, Curveball::NodeComparator> node_tokens(Curveball::NodeComparator{}, 2 * UIntScale::Gi);
+    out_edge_stream.rewind();
+    for (; !out_edge_stream.empty(); ++out_edge_stream) {
+        const auto edge = *out_edge_stream;
+        node_tokens.push(edge.first);
+        node_tokens.push(edge.second);
+    }
+    node_tokens.sort();
+
+    DistributionCount<decltype(node_tokens), size_t> token_count(node_tokens);
+    degree_stream.rewind();
+    for (; !token_count.empty(); ++token_count, ++degree_stream) {
+        ASSERT_EQ(*degree_stream, static_cast<degree_t>((*token_count).count));
+    }
+}
+
+TYPED_TEST(TestCurveball, pld_instance_resume_mid_run) {
+    // Config
+    const node_t num_nodes = 4000;
+    const degree_t min_deg = 5;
+    const degree_t max_deg = 100;
+    const Curveball::tradeid_t num_rounds = 3;
+    const std::string checkpoint_file = "curveball_test_mid_run.checkpoint";
+
+    // Build edge list
+    EdgeStream edge_stream;
+    EdgeStream out_edge_stream;
+
+    HavelHakimiIMGeneratorWithDegrees hh_gen(HavelHakimiIMGeneratorWithDegrees::PushDirection::DecreasingDegree);
+    MonotonicPowerlawRandomStream<false> degree_sequence(min_deg, max_deg, -2.0, num_nodes, 1.0, stxxl::get_next_seed());
+
+    StreamPusher<decltype(degree_sequence), decltype(hh_gen)>(degree_sequence, hh_gen);
+    hh_gen.generate();
+    StreamPusher<decltype(hh_gen), EdgeStream>(hh_gen, edge_stream);
+    hh_gen.finalize();
+
+    auto & degree_stream = hh_gen.get_degree_stream();
+
+    // Run keeping a checkpoint after every round
+    edge_stream.rewind();
+    degree_stream.rewind();
+    {
+        EdgeStream discarded_edge_stream;
+        Curveball::EMCurveball<TypeParam, decltype(degree_stream)> algo(edge_stream,
+                                                                        degree_stream,
+                                                                        num_nodes,
+                                                                        num_rounds,
+                                                                        discarded_edge_stream,
+                                                                        omp_get_max_threads(),
+                                                                        8 * Curveball::UIntScale::Gi,
+                                                                        true);
+        algo.set_checkpointing(checkpoint_file, 1, true);
+        algo.run();
+    }
+
+    // Resume from the checkpoint taken before the last round
+    const std::string mid_run_checkpoint = checkpoint_file + "." + std::to_string(num_rounds - 1);
+    ASSERT_EQ(Curveball::EMCheckpointReader<TypeParam>(mid_run_checkpoint).remaining_rounds(), 1u);
+
+    edge_stream.rewind();
+    degree_stream.rewind();
+    {
+        Curveball::EMCurveball<TypeParam, decltype(degree_stream)> algo(edge_stream,
+                                                                        degree_stream,
+                                                                        num_nodes,
+                                                                        num_rounds,
+                                                                        out_edge_stream,
+                                                                        omp_get_max_threads(),
+                                                                        8 * Curveball::UIntScale::Gi,
+                                                                        true);
+        algo.resume(mid_run_checkpoint);
+    }
+    for (Curveball::tradeid_t round = 1; round <= num_rounds; round++)
+        std::remove((checkpoint_file + "." + std::to_string(round)).c_str());
+
+    // Check edge count
+    ASSERT_EQ(out_edge_stream.size(), edge_stream.size());
+
+    // Check simplicity and degrees
+    stxxl::sorter<node_t, Curveball::NodeComparator> node_tokens(Curveball::NodeComparator{}, 2 * UIntScale::Gi);
+    edge_t last_edge = edge_t::invalid();
+    out_edge_stream.rewind();
+    for (; !out_edge_stream.empty(); ++out_edge_stream) {
+        const auto edge = *out_edge_stream;
+        ASSERT_FALSE(edge.is_loop());
+        if (!last_edge.is_invalid())
+            ASSERT_LT(last_edge, edge);
+        node_tokens.push(edge.first);
+        node_tokens.push(edge.second);
+        last_edge = edge;
+    }
+    node_tokens.sort();
+
+    DistributionCount<decltype(node_tokens), size_t> token_count(node_tokens);
+    degree_stream.rewind();
+    for (; !token_count.empty(); ++token_count, ++degree_stream) {
+        ASSERT_EQ(*degree_stream, static_cast<degree_t>((*token_count).count));
+    }
+}
+
+TYPED_TEST(TestCurveball, relabelled_unsorted_output) {
+    // Config
+    const node_t num_nodes = 2000;
+    const uint32_t num_rounds = 5;
+    const Curveball::chunkid_t num_macrochunks = 4;
+    const Curveball::chunkid_t num_batches = 2;
+    const Curveball::chunkid_t num_fanout = 2;
+    const Curveball::msgid_t num_max_msgs = std::numeric_limits<Curveball::msgid_t>::max();
+    const int num_threads = 4;
+    const size_t insertion_buffer_size = 128;
+
+    struct EdgeVector : public std::vector<edge_t> {
+        void push(const edge_t & e) {push_back(e);}
+    };
+
+    // Circulant graph, node u is relabelled to 2 * (num_nodes - u) - 1
+    EdgeStream edge_stream;
+    DegreeStream degree_stream;
+
+    std::vector<degree_t> degrees(num_nodes, 0);
+    for (const auto & edge : circulant_graph(num_nodes, 3)) {
+        edge_stream.push(edge);
+        degrees[edge.first]++;
+        degrees[edge.second]++;
+    }
+
+    std::vector<node_t> node_ids(num_nodes);
+    for (node_t u = 0; u < num_nodes; u++)
+        node_ids[u] = 2 * (num_nodes - u) - 1;
+
+    for (const auto degree : degrees)
+        degree_stream.push(degree);
+
+    // Run algorithm, the edges of the last round are relabelled in the order they are produced
+    EdgeVector out_edges;
+    auto relabeller = Curveball::make_edge_relabeller(node_ids, out_edges);
+
+    edge_stream.rewind();
+    degree_stream.rewind();
+    Curveball::EMCurveball<TypeParam, DegreeStream, EdgeStream, decltype(relabeller)> algo(edge_stream,
+                                                                                            degree_stream,
+                                                                                            num_nodes,
+                                                                                            num_rounds,
+                                                                                            relabeller,
+                                                                                            num_macrochunks,
+                                                                                            num_batches,
+                                                                                            num_fanout,
+                                                                                            2 * Curveball::UIntScale::Gi,
+                                                                                            2 * Curveball::UIntScale::Gi,
+                                                                                            num_max_msgs,
+                                                                                            num_threads,
+                                                                                            insertion_buffer_size,
+                                                                                            false);
+    algo.run();
+
+    // Check edge count
+    ASSERT_EQ(out_edges.size(), edge_stream.size());
+
+    // Check simplicity and relabelled degrees
+    std::sort(out_edges.begin(), out_edges.end());
+
+    std::vector<degree_t> out_degrees(num_nodes, 0);
+    for (size_t i = 0; i < out_edges.size(); i++) {
+        const auto & edge = out_edges[i];
+        ASSERT_LT(edge.first, edge.second);
+        if (i)
+            ASSERT_LT(out_edges[i - 1], edge);
+
+        ASSERT_EQ(edge.first % 2, 1);
+        ASSERT_EQ(edge.second % 2, 1);
+        out_degrees[num_nodes - (edge.first + 1) / 2]++;
+        out_degrees[num_nodes - (edge.second + 1) / 2]++;
+    }
+
+    ASSERT_EQ(degrees, out_degrees);
+}
+
+TYPED_TEST(TestCurveball, hub_pair_heavy_trades) {
+    // Config
+    const node_t num_nodes = 2000;
+    const uint32_t num_rounds = 5;
+    const Curveball::chunkid_t num_macrochunks = 2;
+    const Curveball::chunkid_t num_batches = 2;
+    const Curveball::chunkid_t num_fanout = 2;
+    const Curveball::msgid_t num_max_msgs = std::numeric_limits<Curveball::msgid_t>::max();
+    const int num_threads = 4;
+    const size_t insertion_buffer_size = 128;
+
+    // Two adjacent hubs connected to all other nodes, which form a path
+    EdgeStream edge_stream;
+    EdgeStream out_edge_stream;
+    DegreeStream degree_stream;
+
+    std::vector<degree_t> degrees(num_nodes, 0);
+    edge_stream.push(edge_t(0, 1));
+    for (node_t hub = 0; hub < 2; hub++)
+        for (node_t u = 2; u < num_nodes; u++)
+            edge_stream.push(edge_t(hub, u));
+    for (node_t u = 2; u + 1 < num_nodes; u++)
+        edge_stream.push(edge_t(u, u + 1));
+    edge_stream.rewind();
+    for (; !edge_stream.empty(); ++edge_stream) {
+        degrees[(*edge_stream).first]++;
+        degrees[(*edge_stream).second]++;
+    }
+    for (const auto degree : degrees)
+        degree_stream.push(degree);
+
+    // Run algorithm, the trades of the hubs are shared by all threads
+    edge_stream.rewind();
+    degree_stream.rewind();
+    Curveball::EMCurveball<TypeParam, DegreeStream> algo(edge_stream,
+                                                         degree_stream,
+                                                         num_nodes,
+                                                         num_rounds,
+                                                         out_edge_stream,
+                                                         num_macrochunks,
+                                                         num_batches,
+                                                         num_fanout,
+                                                         2 * Curveball::UIntScale::Gi,
+                                                         2 * Curveball::UIntScale::Gi,
+                                                         num_max_msgs,
+                                                         num_threads,
+                                                         insertion_buffer_size);
+    algo.set_min_heavy_trade_degree(64);
+    algo.run();
+
+    // Check edge count
+    ASSERT_EQ(out_edge_stream.size(), edge_stream.size());
+
+    // Check simplicity and degrees
+    std::vector<degree_t> out_degrees(num_nodes, 0);
+    edge_t last_edge = edge_t::invalid();
+    out_edge_stream.rewind();
+    for (; !out_edge_stream.empty(); ++out_edge_stream) {
+        const auto edge = *out_edge_stream;
+        ASSERT_FALSE(edge.is_loop());
+        if (!last_edge.is_invalid())
+            ASSERT_LT(last_edge, edge);
+        out_degrees[edge.first]++;
+        out_degrees[edge.second]++;
+        last_edge = edge;
+    }
+
+    ASSERT_EQ(degrees, out_degrees);
+}
+
+TEST_F(TestCurveballThreadBounds, thread_bounds_by_work) {
+    const node_t num_nodes = 1001;
+    const Curveball::chunkid_t num_microchunks = 16;
+    const Curveball::chunkid_t num_fanout = 2;
+
+    // a few hubs at the front carry most of the work
+    std::vector<degree_t> degs_psum(num_nodes + 1, 0);
+    for (node_t u = 0; u < num_nodes; u++)
+        degs_psum[u + 1] = degs_psum[u] + (u < 4 ? 10000 : 1 + u % 7);
+
+    const auto bounds = Curveball::mc_get_thread_bounds_by_work(degs_psum, num_nodes,
+                                                                num_microchunks, num_fanout);
+
+    ASSERT_EQ(bounds.size(), static_cast<size_t>(num_microchunks * num_fanout));
+    ASSERT_EQ(bounds.l_bounds.front(), 0);
+    ASSERT_EQ(bounds.u_bounds.back(), num_nodes - 1);
+
+    const degree_t work_per_microchunk = degs_psum[num_nodes - 1] / (num_microchunks * num_fanout);
+    for (size_t i = 0; i < bounds.size(); i++) {
+        // microchunks are consecutive and hold whole pairs
+        ASSERT_LE(bounds.l_bounds[i], bounds.u_bounds[i]);
+        ASSERT_EQ(bounds.l_bounds[i] % 2, 0);
+        if (i)
+            ASSERT_EQ(bounds.l_bounds[i], bounds.u_bounds[i - 1]);
+
+        // apart from the hubs, the work exceeds the average by at most one pair
+        const node_t l = bounds.l_bounds[i];
+        const node_t u = bounds.u_bounds[i];
+        if (u - l > 2)
+            ASSERT_LE(degs_psum[u] - degs_psum[l], work_per_microchunk + 2 * 10000);
+    }
+}
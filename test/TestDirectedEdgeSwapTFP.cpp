@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <defs.h>
+#include <EdgeStream.h>
+#include <SwapGenerator.h>
+#include <EdgeSwaps/EdgeSwapTFP.h>
+#include "CirculantGraph.h"
+
+class TestDirectedEdgeSwapTFP : public ::testing::Test {};
+
+TEST_F(TestDirectedEdgeSwapTFP, singleSwap) {
+    // (0, 1) and (1, 0) are distinct edges and must not be normalized
+    EdgeStream edge_list;
+    edge_list.push({0, 1});
+    edge_list.push({1, 0});
+    edge_list.push({2, 3});
+    edge_list.consume();
+
+    EdgeSwapTFP::DirectedEdgeSwapTFP algo(edge_list, 100, 4, 1llu << 30);
+    algo.push(SwapDescriptor {1, 2, false});
+    algo.run();
+
+    // (1, 0) and (2, 3) become (1, 3) and (2, 0), independent of the direction bit
+    edge_list.rewind();
+    std::vector<edge_t> result;
+    for(; !edge_list.empty(); ++edge_list)
+        result.push_back(*edge_list);
+
+    ASSERT_EQ(result, std::vector<edge_t>({{0, 1}, {1, 3}, {2, 0}}));
+}
+
+TEST_F(TestDirectedEdgeSwapTFP, degreesPreserved) {
+    constexpr node_t num_nodes = 1000;
+    constexpr node_t k = 3;
+
+    // directed circulant graph, i.e. each node points to its next k neighbours
+    const auto edge_list = circulant_graph(num_nodes, k, true);
+
+    EdgeStream edge_stream;
+    for(const auto & e : edge_list)
+        edge_stream.push(e);
+    edge_stream.consume();
+
+    const swapid_t num_swaps = 4 * edge_list.size();
+    EdgeSwapTFP::DirectedEdgeSwapTFP algo(edge_stream, num_swaps / 4, num_nodes, 1llu << 30);
+    for(SwapGenerator gen(num_swaps, edge_list.size(), 1234); !gen.empty(); ++gen)
+        algo.push(*gen);
+    algo.run();
+
+    edge_stream.rewind();
+    ASSERT_EQ(edge_stream.size(), edge_list.size());
+
+    std::vector<degree_t> in_degrees(num_nodes, 0);
+    std::vector<degree_t> out_degrees(num_nodes, 0);
+    edge_t last = edge_t::invalid();
+    uint_t num_reversed = 0;
+    for(; !edge_stream.empty(); ++edge_stream) {
+        const auto & e = *edge_stream;
+        ASSERT_FALSE(e.is_loop());
+        ASSERT_TRUE(last.is_invalid() || last < e);
+        out_degrees[e.first]++;
+        in_degrees[e.second]++;
+        num_reversed += (e.first > e.second);
+        last = e;
+    }
+
+    for(node_t u = 0; u < num_nodes; ++u) {
+        ASSERT_EQ(out_degrees[u], k);
+        ASSERT_EQ(in_degrees[u], k);
+    }
+
+    // the graph was actually rewired: initially only k * (k+1) / 2 edges point backwards
+    ASSERT_GT(num_reversed, static_cast<uint_t>(k * (k + 1)));
+}
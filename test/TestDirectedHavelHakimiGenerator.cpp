@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <HavelHakimi/DirectedHavelHakimiGenerator.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+class TestDirectedHavelHakimiGenerator : public ::testing::Test {
+protected:
+    //! Returns the number of unsatisfied edges and checks the produced graph
+    edgeid_t _check(const std::vector<degree_t> & in_degrees, const std::vector<degree_t> & out_degrees) {
+        DirectedHavelHakimiGenerator gen;
+        for (size_t i = 0; i < in_degrees.size(); ++i)
+            gen.push(in_degrees[i], out_degrees[i]);
+
+        EXPECT_TRUE(gen.empty());
+        gen.generate();
+
+        std::vector<degree_t> in(in_degrees.size(), 0);
+        std::vector<degree_t> out(out_degrees.size(), 0);
+        edge_t last = edge_t::invalid();
+        for (; !gen.empty(); ++gen) {
+            const edge_t & e = *gen;
+            EXPECT_FALSE(e.is_loop());
+            EXPECT_TRUE(last.is_invalid() || last < e);
+            in[e.second]++;
+            out[e.first]++;
+            last = e;
+        }
+
+        for (size_t i = 0; i < in_degrees.size(); ++i) {
+            EXPECT_EQ(in[i] + gen.unsatisfiedInDegree(i), in_degrees[i]);
+            EXPECT_EQ(out[i] + gen.unsatisfiedOutDegree(i), out_degrees[i]);
+        }
+
+        return gen.unsatisfiedDegree();
+    }
+};
+
+TEST_F(TestDirectedHavelHakimiGenerator, cycle) {
+    // two nodes may be connected in both directions
+    ASSERT_EQ(_check({1, 1}, {1, 1}), 0);
+    ASSERT_EQ(_check({2, 2, 2}, {2, 2, 2}), 0);
+}
+
+TEST_F(TestDirectedHavelHakimiGenerator, unrealisable) {
+    // a single node cannot have an edge without self-loop
+    ASSERT_EQ(_check({1}, {1}), 1);
+    ASSERT_EQ(_check({3, 0, 0}, {1, 1, 1}), 1);
+}
+
+TEST_F(TestDirectedHavelHakimiGenerator, randomGraph) {
+    constexpr node_t num_nodes = 500;
+    std::mt19937_64 prng(1);
+    std::uniform_int_distribution<node_t> distr(0, num_nodes - 1);
+
+    // degrees of a random simple digraph are always realisable
+    std::set<edge_t> edges;
+    while (edges.size() < 5000) {
+        edge_t e(distr(prng), distr(prng));
+        if (!e.is_loop())
+            edges.insert(e);
+    }
+
+    std::vector<degree_t> in_degrees(num_nodes, 0);
+    std::vector<degree_t> out_degrees(num_nodes, 0);
+    for (const auto & e : edges) {
+        out_degrees[e.first]++;
+        in_degrees[e.second]++;
+    }
+
+    ASSERT_EQ(_check(in_degrees, out_degrees), 0);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "defs.h"
+#include <Curveball/EMCheckpoint.h>
+#include <Utils/NodeHash.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class TestEMCheckpoint : public ::testing::Test {
+protected:
+    const std::string _filename = "em_checkpoint_test.bin";
+
+    void TearDown() override {
+        std::remove(_filename.c_str());
+    }
+};
+
+TEST_F(TestEMCheckpoint, round_trip) {
+    const node_t num_nodes = 1000;
+    const std::vector<Curveball::ModHash> hash_funcs{Curveball::ModHash{2, 3, 1009},
+                                                     Curveball::ModHash{5, 7, 1009},
+                                                     Curveball::ModHash::get_identity(num_nodes)};
+
+    // more messages than fit into one buffer
+    const node_t num_msgs = 200000;
+    {
+        Curveball::EMCheckpointWriter<Curveball::ModHash> writer(_filename, num_nodes, hash_funcs);
+        for (node_t i = 0; i < num_msgs; i++)
+            writer.push(edge_t{i % num_nodes, i});
+        writer.finish();
+    }
+
+    Curveball::EMCheckpointReader<Curveball::ModHash> reader(_filename);
+    ASSERT_EQ(reader.num_nodes(), num_nodes);
+    ASSERT_EQ(reader.num_msgs(), num_msgs);
+    ASSERT_EQ(reader.remaining_rounds(), 2u);
+
+    for (node_t node = 0; node < num_nodes; node++) {
+        ASSERT_EQ(reader.hash_funcs()[0].hash(node), hash_funcs[0].hash(node));
+        ASSERT_EQ(reader.hash_funcs()[1].hash(node), hash_funcs[1].hash(node));
+        ASSERT_EQ(reader.hash_funcs()[2].hash(node), node);
+    }
+
+    node_t i = 0;
+    for (; !reader.empty(); ++reader, ++i) {
+        ASSERT_EQ((*reader).target, i % num_nodes);
+        ASSERT_EQ((*reader).neighbour, i);
+    }
+    ASSERT_EQ(i, num_msgs);
+}
+
+TEST_F(TestEMCheckpoint, empty_checkpoint) {
+    {
+        Curveball::EMCheckpointWriter<Curveball::FeistelHash> writer(_filename, 10, {Curveball::FeistelHash::get_identity(10)});
+        writer.finish();
+    }
+
+    Curveball::EMCheckpointReader<Curveball::FeistelHash> reader(_filename);
+    ASSERT_EQ(reader.remaining_rounds(), 0u);
+    ASSERT_TRUE(reader.empty());
+}
+
+TEST_F(TestEMCheckpoint, invalid_file) {
+    {
+        std::ofstream out(_filename);
+        out << "no checkpoint";
+    }
+
+    ASSERT_THROW(Curveball::EMCheckpointReader<Curveball::ModHash> reader(_filename), std::runtime_error);
+    ASSERT_THROW(Curveball::EMCheckpointReader<Curveball::ModHash> reader("does_not_exist.bin"), std::runtime_error);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <Curveball/EMParameterEstimation.h>
+
+#include <random>
+#include <vector>
+
+class TestEMParameterEstimation : public ::testing::Test {
+protected:
+    struct VectorDegreeStream {
+        std::vector<degree_t> degrees;
+        size_t index = 0;
+
+        bool empty() const {return index >= degrees.size();}
+        degree_t operator*() const {return degrees[index];}
+        VectorDegreeStream & operator++() {++index; return *this;}
+        void rewind() {index = 0;}
+    };
+
+    VectorDegreeStream _powerlaw_degrees(node_t num_nodes, degree_t min_deg, degree_t max_deg) {
+        std::mt19937_64 prng(1);
+        std::uniform_real_distribution<double> distr(0.0, 1.0);
+
+        VectorDegreeStream stream;
+        for (node_t u = 0; u < num_nodes; u++) {
+            // inverse transform sampling of a powerlaw with exponent -2
+            const double x = 1.0 / (1.0 / min_deg - distr(prng) * (1.0 / min_deg - 1.0 / max_deg));
+            stream.degrees.push_back(static_cast<degree_t>(x));
+        }
+        return stream;
+    }
+
+    static edgeid_t _num_edges(const VectorDegreeStream & stream) {
+        edgeid_t sum = 0;
+        for (const auto d : stream.degrees)
+            sum += d;
+        return sum / 2;
+    }
+};
+
+TEST_F(TestEMParameterEstimation, peakFitsIntoMemory) {
+    const node_t num_nodes = 1000000;
+    auto degrees = _powerlaw_degrees(num_nodes, 5, 10000);
+    const edgeid_t num_edges = _num_edges(degrees);
+
+    const size_t mem = 256 * IntScale::Mi;
+    const Curveball::CurveballCalibration calibration;
+    const Curveball::EMParameterEstimation est(degrees, num_nodes, num_edges, 10, mem, 4, calibration);
+
+    // the stream is rewound
+    ASSERT_FALSE(degrees.empty());
+    ASSERT_EQ(degrees.index, 0u);
+
+    ASSERT_GE(est.num_macrochunks(), 2u);
+    ASSERT_GE(est.num_batches(), 1u);
+    ASSERT_GE(est.num_fanout(), 1u);
+    ASSERT_GE(est.size_insertionbuffer(), 32u);
+
+    // the peak exceeds the mean degree sum and fits into the memory
+    const double mean = 2.0 * num_edges / est.num_macrochunks();
+    ASSERT_GT(est.predicted_msgs_per_macrochunk(), mean);
+    ASSERT_LT(est.predicted_msgs_per_macrochunk() * calibration.bytes_per_msg, mem);
+
+    // fewer macrochunks would not fit
+    const double smaller_mean = 2.0 * num_edges / (est.num_macrochunks() - 1);
+    if (est.num_macrochunks() > 2) {
+        ASSERT_GT(smaller_mean * calibration.bytes_per_msg, (1.0 - calibration.insertion_buffer_share) * mem
+                                                            - num_nodes * calibration.bytes_per_node);
+    }
+}
+
+TEST_F(TestEMParameterEstimation, moreMemoryFewerMacrochunks) {
+    const node_t num_nodes = 1000000;
+    auto degrees = _powerlaw_degrees(num_nodes, 5, 10000);
+    const edgeid_t num_edges = _num_edges(degrees);
+
+    const Curveball::EMParameterEstimation small(degrees, num_nodes, num_edges, 10, 128 * IntScale::Mi, 4);
+    const Curveball::EMParameterEstimation large(degrees, num_nodes, num_edges, 10, 1024 * IntScale::Mi, 4);
+
+    ASSERT_GT(small.num_macrochunks(), large.num_macrochunks());
+    ASSERT_GT(small.predicted_msgs_per_macrochunk(), 0);
+    ASSERT_LT(small.predicted_msgs_per_macrochunk(), large.predicted_msgs_per_macrochunk());
+}
+
+TEST_F(TestEMParameterEstimation, regularDegrees) {
+    const node_t num_nodes = 100000;
+    VectorDegreeStream degrees;
+    degrees.degrees.assign(num_nodes, 10);
+
+    const Curveball::EMParameterEstimation est(degrees, num_nodes, 5 * num_nodes, 10, 1024 * IntScale::Mi, 4);
+
+    // without deviation the peak is the mean degree sum
+    ASSERT_EQ(est.num_macrochunks(), 2u);
+    ASSERT_EQ(est.predicted_msgs_per_macrochunk(), 10 * num_nodes / 2);
+    ASSERT_EQ(est.num_fanout(), 1u);
+}
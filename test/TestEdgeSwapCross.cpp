@@ -14,9 +14,34 @@
 #include <EdgeSwaps/EdgeSwapParallelTFP.h>
 #include <EdgeSwaps/EdgeSwapFullyInternal.h>
 #include <EdgeSwaps/IMEdgeSwap.h>
+#include <EdgeSwaps/ParallelIMEdgeSwap.h>
 
 
 #ifdef EDGE_SWAP_DEBUG_VECTOR
+//! EdgeSwapTFP with several runs and a small existence filter, s.t. false positives occur
+class EdgeSwapTFPWithExistenceFilter : public EdgeSwapTFP::EdgeSwapTFP {
+public:
+   EdgeSwapTFPWithExistenceFilter(edge_buffer_t &edges, swap_vector &swaps) :
+      EdgeSwapTFP::EdgeSwapTFP(edges, swaps, swaps.size() / 4 + 1)
+   {
+      setExistenceFilter(4.0);
+   }
+};
+
+template <>
+struct EdgeSwapTrait<EdgeSwapTFPWithExistenceFilter> : public EdgeSwapTrait<EdgeSwapTFP::EdgeSwapTFP> {};
+
+//! ParallelIMEdgeSwap with a single thread and small batches, s.t. the edge set is rebuilt several times
+class ParallelIMEdgeSwapSingleThreaded : public ParallelIMEdgeSwap {
+public:
+   ParallelIMEdgeSwapSingleThreaded(EdgeStream &edges, swap_vector &) :
+      ParallelIMEdgeSwap(edges, 1, 64)
+   { }
+};
+
+template <>
+struct EdgeSwapTrait<ParallelIMEdgeSwapSingleThreaded> : public EdgeSwapTrait<ParallelIMEdgeSwap> {};
+
 namespace {
    using EdgeVector = stxxl::vector<edge_t>;
    using SwapVector = stxxl::vector<SwapDescriptor>;
@@ -77,8 +102,10 @@ namespace {
    using TestEdgeSwapCrossImplementations = ::testing::Types <
       EdgeSwapInternalSwaps,
       EdgeSwapTFP::EdgeSwapTFP,
+      EdgeSwapTFPWithExistenceFilter,
       EdgeSwapParallelTFP::EdgeSwapParallelTFP,
-      IMEdgeSwap
+      IMEdgeSwap,
+      ParallelIMEdgeSwapSingleThreaded
    >;
 
    TYPED_TEST_CASE(TestEdgeSwapCross, TestEdgeSwapCrossImplementations);
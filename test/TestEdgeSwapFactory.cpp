@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <EdgeStream.h>
+#include <SwapGenerator.h>
+#include <EdgeSwaps/EdgeSwapFactory.h>
+#include "CirculantGraph.h"
+
+class TestEdgeSwapFactory : public ::testing::Test {};
+
+TEST_F(TestEdgeSwapFactory, names) {
+    for(unsigned int i = 0; i <= num_edge_swap_algorithms; ++i) {
+        const auto algo = static_cast<EdgeSwapAlgorithm>(i);
+        ASSERT_EQ(EdgeSwapFactory::parse(EdgeSwapFactory::name(algo)), algo);
+    }
+
+    ASSERT_EQ(EdgeSwapFactory::parse("ptfp"), EdgeSwapAlgorithm::ParallelTFP);
+    ASSERT_THROW(EdgeSwapFactory::parse("foo"), std::invalid_argument);
+}
+
+TEST_F(TestEdgeSwapFactory, selection) {
+    const EdgeSwapFactory factory;
+
+    // fits into internal memory
+    ASSERT_EQ(factory.select(EdgeSwapInstance(1000000, 100000, 10000000, IntScale::Gi, 1)), EdgeSwapAlgorithm::IM);
+    ASSERT_EQ(factory.select(EdgeSwapInstance(1000000, 100000, 10000000, IntScale::Gi, 8)), EdgeSwapAlgorithm::ParallelIM);
+
+    // does not fit into internal memory
+    ASSERT_EQ(factory.select(EdgeSwapInstance(100000000, 1000000, 1000000000, IntScale::Gi, 1)), EdgeSwapAlgorithm::TFP);
+
+    // measurements overrule the defaults
+    EdgeSwapCalibration calibration;
+    calibration.add({EdgeSwapAlgorithm::TFP, 1, 1000000, 10000000, 125000, 0.001});
+    const EdgeSwapInstance instance(1000000, 100000, 10000000, IntScale::Gi, 1);
+    ASSERT_EQ(EdgeSwapFactory(calibration).select(instance), EdgeSwapAlgorithm::TFP);
+    ASSERT_NEAR(calibration.estimate(EdgeSwapAlgorithm::TFP, EdgeSwapFactory::withRunLength(EdgeSwapAlgorithm::TFP, instance)), 0.001, 1e-9);
+}
+
+TEST_F(TestEdgeSwapFactory, engines) {
+    constexpr node_t num_nodes = 2000;
+    constexpr node_t k = 4;
+
+    // circulant graph, i.e. each node is connected to its next k neighbours
+    const auto edge_list = circulant_graph(num_nodes, k);
+
+    for(auto algo : {EdgeSwapAlgorithm::IM, EdgeSwapAlgorithm::ParallelIM, EdgeSwapAlgorithm::Semi, EdgeSwapAlgorithm::TFP}) {
+        EdgeStream edge_stream;
+        for(const auto & e : edge_list)
+            edge_stream.push(e);
+        edge_stream.consume();
+
+        const uint_t num_swaps = 2 * edge_list.size();
+        const EdgeSwapInstance instance(edge_list.size(), num_nodes, num_swaps, IntScale::Gi, 2, edge_list.size() / 2);
+
+        uint_t callbacks = 0;
+        auto swap_algo = EdgeSwapFactory().create(edge_stream, instance, [&] (uint_t iteration) {
+            ASSERT_EQ(iteration, callbacks);
+            ASSERT_EQ(edge_stream.size(), edge_list.size());
+            callbacks++;
+        }, algo);
+        ASSERT_EQ(swap_algo->algorithm(), algo);
+
+        for(SwapGenerator gen(num_swaps, edge_list.size(), 1234); !gen.empty(); ++gen)
+            swap_algo->push(*gen);
+        swap_algo->run();
+
+        ASSERT_GE(callbacks, 4u);
+
+        edge_stream.rewind();
+        ASSERT_EQ(edge_stream.size(), edge_list.size());
+
+        std::vector<degree_t> degrees(num_nodes, 0);
+        edge_t last = edge_t::invalid();
+        for(; !edge_stream.empty(); ++edge_stream) {
+            const auto & e = *edge_stream;
+            ASSERT_FALSE(e.is_loop());
+            ASSERT_TRUE(last.is_invalid() || last < e);
+            degrees[e.first]++;
+            degrees[e.second]++;
+            last = e;
+        }
+
+        for(const auto & d : degrees)
+            ASSERT_EQ(d, 2 * k);
+    }
+}
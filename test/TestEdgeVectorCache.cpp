@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <EdgeSwaps/EdgeVectorCache.h>
+
+class TestEdgeVectorCache : public ::testing::Test {};
+
+TEST_F(TestEdgeVectorCache, loadModifyFlush) {
+    constexpr node_t num_nodes = 1000;
+
+    EdgeVectorCache::vector_type edges;
+    for(node_t u = 0; u + 1 < num_nodes; ++u)
+        edges.push_back(edge_t(u, u + 1));
+
+    const std::vector<int_t> requests = {0, 3, 3, 17, 500, 998};
+    struct IdStream {
+        std::vector<int_t>::const_iterator it, end;
+        const int_t & operator*() const {return *it;}
+        IdStream & operator++() {++it; return *this;}
+        bool empty() const {return it == end;}
+    } stream {requests.cbegin(), requests.cend()};
+
+    EdgeVectorCache cache(edges);
+    cache.loadEdges(stream);
+
+    ASSERT_EQ(cache.size(), 5u);
+    ASSERT_EQ(cache.rank(17), 2u);
+    ASSERT_EQ(cache.getEdge(500), edge_t(500, 501));
+    ASSERT_EQ(cache.getEdgeByRank(4), edge_t(998, 999));
+
+    // replace by edges which are not normalized and not in id order anymore
+    cache.setEdge(0, edge_t(999, 0));
+    cache.setEdge(3, edge_t(5, 1));
+    cache.setEdge(17, edge_t(2, 4));
+    cache.setEdge(500, edge_t(17, 100));
+    cache.setEdge(998, edge_t(3, 998));
+
+    cache.flushEdges();
+    ASSERT_EQ(cache.size(), 0u);
+
+    std::vector<edge_t> expected;
+    for(node_t u = 0; u + 1 < num_nodes; ++u) {
+        if (u != 0 && u != 3 && u != 17 && u != 500 && u != 998)
+            expected.push_back(edge_t(u, u + 1));
+    }
+    expected.insert(expected.end(), {edge_t(0, 999), edge_t(1, 5), edge_t(2, 4), edge_t(17, 100), edge_t(3, 998)});
+    std::sort(expected.begin(), expected.end());
+
+    ASSERT_EQ(edges.size(), expected.size());
+    ASSERT_TRUE(std::equal(expected.cbegin(), expected.cend(), edges.cbegin()));
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <EdgeStream.h>
+#include <LFR/GlobalRewiringSwapGenerator.h>
+
+class TestGlobalRewiringSwapGenerator : public ::testing::Test {
+protected:
+    static constexpr node_t num_nodes = 10000;
+    static constexpr node_t community_size = 10;
+
+    stxxl::vector<LFR::CommunityAssignment> _assignments;
+
+    void SetUp() override {
+        for (node_t u = 0; u < num_nodes; ++u)
+            _assignments.push_back(LFR::CommunityAssignment(u / community_size, 1, u));
+    }
+
+    // edges of the generated swaps, sorted
+    std::vector<edge_t> conflicts(std::vector<edge_t> edges) {
+        std::sort(edges.begin(), edges.end());
+
+        EdgeStream edge_stream;
+        for (const auto & e : edges)
+            edge_stream.push(e);
+        edge_stream.consume();
+
+        GlobalRewiringSwapGenerator gen(_assignments, edges.size(), 1234);
+        gen.pushEdges(edge_stream);
+        gen.generate();
+
+        std::vector<edge_t> result;
+        for (; !gen.empty(); ++gen) {
+            EXPECT_LT(gen->eid(), static_cast<edgeid_t>(edges.size()));
+            result.push_back(gen->edge());
+        }
+
+        EXPECT_TRUE(std::is_sorted(result.begin(), result.end(), [] (const edge_t & a, const edge_t & b) {
+            return std::make_pair(a.second, a.first) < std::make_pair(b.second, b.first);
+        }));
+        std::sort(result.begin(), result.end());
+
+        return result;
+    }
+};
+
+TEST_F(TestGlobalRewiringSwapGenerator, scan) {
+    std::vector<edge_t> edges, expected;
+    for (node_t u = 0; u + num_nodes / 2 < num_nodes; u += 3) {
+        edges.emplace_back(u, u + 1);
+        edges.emplace_back(u, u + num_nodes / 2);
+
+        if (u / community_size == (u + 1) / community_size)
+            expected.emplace_back(u, u + 1);
+    }
+
+    ASSERT_EQ(conflicts(edges), expected);
+}
+
+TEST_F(TestGlobalRewiringSwapGenerator, lookup) {
+    // few edges, hence the communities of the endpoints are looked up
+    const std::vector<edge_t> edges {{5, 7}, {9, 10}, {4711, 4719}, {9990, 9999}};
+    const std::vector<edge_t> expected {{5, 7}, {4711, 4719}, {9990, 9999}};
+
+    ASSERT_EQ(conflicts(edges), expected);
+}
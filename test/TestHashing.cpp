@@ -9,6 +9,8 @@
 #include "defs.h"
 #include "Utils/NodeHash.h"
 
+#include <vector>
+
 class TestHashing : public ::testing::Test {
 };
 
@@ -132,3 +134,56 @@ TEST_F(TestHashing, next_prime) {
 	ASSERT_EQ(Curveball::get_next_prime(100), 101ul);
 	ASSERT_EQ(Curveball::get_next_prime(1600), 1601ul);
 }
+
+TEST_F(TestHashing, feistel_bijection) {
+	for (node_t num_nodes : {1, 2, 3, 17, 1000, 4096, 100003}) {
+		const Curveball::FeistelHash h(num_nodes, 1234);
+
+		std::vector<bool> seen(static_cast<size_t>(num_nodes), false);
+		for (node_t node = 0; node < num_nodes; node++) {
+			const Curveball::hnode_t hnode = h.hash(node);
+			ASSERT_GE(hnode, 0);
+			ASSERT_LT(hnode, num_nodes);
+			ASSERT_FALSE(seen[hnode]);
+			seen[hnode] = true;
+
+			ASSERT_EQ(h.invert(hnode), node);
+		}
+
+		ASSERT_EQ(h.hash(h.min_value()), 0);
+		ASSERT_EQ(h.hash(h.max_value()), num_nodes - 1);
+	}
+}
+
+TEST_F(TestHashing, feistel_seeds) {
+	const node_t num_nodes = 10000;
+	const Curveball::FeistelHash h1(num_nodes, 1);
+	const Curveball::FeistelHash h2(num_nodes, 2);
+
+	node_t num_equal = 0;
+	for (node_t node = 0; node < num_nodes; node++)
+		num_equal += (h1.hash(node) == h2.hash(node));
+
+	ASSERT_LT(num_equal, num_nodes / 100);
+}
+
+TEST_F(TestHashing, get_identity_feistel) {
+	Curveball::FeistelHash id = Curveball::FeistelHash::get_identity(10000);
+
+	for (node_t i = 0; i < 10000; i++) {
+		ASSERT_EQ(i, id.hash(i));
+	}
+}
+
+TEST_F(TestHashing, feistel_outside_domain) {
+	const node_t num_nodes = 1000;
+	const Curveball::FeistelHash h(num_nodes, 1234);
+	const Curveball::FeistelHash id = Curveball::FeistelHash::get_identity(num_nodes);
+
+	for (node_t node : {num_nodes, num_nodes + 1, 1023, 4096, INVALID_NODE}) {
+		ASSERT_EQ(h.hash(node), node);
+		ASSERT_EQ(h.invert(node), node);
+		ASSERT_EQ(id.hash(node), node);
+		ASSERT_EQ(id.invert(node), node);
+	}
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <Curveball/IMCurveball.h>
+#include <Curveball/EdgeRelabeller.h>
+#include <Utils/NodeHash.h>
+
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+//! Parameters are the number of threads and whether FeistelHash is used instead of ModHash
+class TestIMCurveball : public ::testing::TestWithParam<std::tuple<int, bool>> {
+protected:
+    struct EdgeVector : public std::vector<edge_t> {
+        void push(const edge_t & e) {push_back(e);}
+    };
+
+    template <typename HashFactory, typename Receiver>
+    void _randomise_with(const std::vector<degree_t> & degrees, const std::set<edge_t> & edges,
+                         Curveball::tradeid_t num_rounds, Receiver & out) {
+        Curveball::IMCurveball<HashFactory> algo(degrees, num_rounds, std::get<0>(GetParam()));
+        for (const auto & e : edges)
+            algo.push(e);
+        algo.run();
+
+        algo.forward_edges(out);
+    }
+
+    //! Randomises the graph with the hash-functions selected by the parameter
+    template <typename Receiver>
+    void _randomise(const std::vector<degree_t> & degrees, const std::set<edge_t> & edges,
+                    Curveball::tradeid_t num_rounds, Receiver & out) {
+        if (std::get<1>(GetParam()))
+            _randomise_with<Curveball::FeistelHash>(degrees, edges, num_rounds, out);
+        else
+            _randomise_with<Curveball::ModHash>(degrees, edges, num_rounds, out);
+    }
+
+    //! Randomises the graph and checks that the degrees are kept and the result is simple
+    EdgeVector _run(const std::set<edge_t> & edges, node_t num_nodes, Curveball::tradeid_t num_rounds) {
+        std::vector<degree_t> degrees(static_cast<size_t>(num_nodes), 0);
+        for (const auto & e : edges) {
+            degrees[e.first]++;
+            degrees[e.second]++;
+        }
+
+        EdgeVector out;
+        _randomise(degrees, edges, num_rounds, out);
+
+        EXPECT_EQ(out.size(), edges.size());
+
+        std::vector<degree_t> out_degrees(static_cast<size_t>(num_nodes), 0);
+        for (size_t i = 0; i < out.size(); i++) {
+            EXPECT_LT(out[i].first, out[i].second);
+            if (i)
+                EXPECT_LT(out[i - 1], out[i]);
+            out_degrees[out[i].first]++;
+            out_degrees[out[i].second]++;
+        }
+
+        EXPECT_EQ(degrees, out_degrees);
+
+        return out;
+    }
+};
+
+TEST_P(TestIMCurveball, tinyGraphs) {
+    _run({{0, 1}}, 2, 3);
+    _run({{0, 1}, {1, 2}}, 3, 3);
+    _run({{0, 1}, {0, 2}, {1, 2}, {2, 3}, {3, 4}}, 5, 5);
+}
+
+TEST_P(TestIMCurveball, randomGraph) {
+    constexpr node_t num_nodes = 1001;
+    std::mt19937_64 prng(1);
+    std::uniform_int_distribution<node_t> distr(0, num_nodes - 1);
+
+    std::set<edge_t> edges;
+    // a hub ensures that trades depend on each other
+    for (node_t u = 1; u < num_nodes; u += 2)
+        edges.insert({0, u});
+    while (edges.size() < 10000) {
+        edge_t e(distr(prng), distr(prng));
+        e.normalize();
+        if (!e.is_loop())
+            edges.insert(e);
+    }
+
+    const auto out = _run(edges, num_nodes, 10);
+
+    size_t num_kept = 0;
+    for (const auto & e : out)
+        num_kept += edges.count(e);
+
+    ASSERT_LT(num_kept, edges.size() / 2);
+}
+
+TEST_P(TestIMCurveball, relabelledOutput) {
+    const std::set<edge_t> edges{{0, 1}, {0, 2}, {1, 2}, {2, 3}, {3, 4}};
+    const std::vector<node_t> node_ids{40, 30, 20, 10, 0};
+
+    std::vector<degree_t> degrees(node_ids.size(), 0);
+    for (const auto & e : edges) {
+        degrees[e.first]++;
+        degrees[e.second]++;
+    }
+
+    EdgeVector out;
+    auto relabeller = Curveball::make_edge_relabeller(node_ids, out);
+    _randomise(degrees, edges, 3, relabeller);
+
+    ASSERT_EQ(out.size(), edges.size());
+
+    std::vector<degree_t> out_degrees(node_ids.size(), 0);
+    for (const auto & e : out) {
+        EXPECT_LT(e.first, e.second);
+        out_degrees[e.first / 10]++;
+        out_degrees[e.second / 10]++;
+    }
+
+    // node u is relabelled to 10 * (4 - u)
+    EXPECT_EQ(std::vector<degree_t>(degrees.rbegin(), degrees.rend()), out_degrees);
+}
+
+INSTANTIATE_TEST_CASE_P(TestIMCurveballThreadsAndHashes, TestIMCurveball,
+                        ::testing::Combine(::testing::Values(1, 4), ::testing::Bool()));
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <LFR/LFR.h>
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+class TestLFRWeights : public ::testing::Test {
+protected:
+    //! Exposes the weight assignment on a given graph
+    class WeightedLFR : public LFR::LFR {
+    public:
+        WeightedLFR(node_t num_nodes)
+            : LFR::LFR({1, num_nodes - 1, num_nodes, 1.0, -2.0},
+                       {1, num_nodes, 1, 1.0, -1.0},
+                       0.5, 64 * UIntScale::Gi)
+        {}
+
+        //! Edges have to be sorted and intra[i] tells whether the i-th edge lies in a community
+        void assign_weights(const std::set<edge_t> & edges, const std::vector<bool> & intra) {
+            _edges.clear();
+            _intra_edge_flags.clear();
+            size_t i = 0;
+            for (const auto & e : edges) {
+                _edges.push(e);
+                _intra_edge_flags.push(intra[i++]);
+            }
+            _edges.consume();
+            _intra_edge_flags.consume();
+
+            _assign_edge_weights();
+        }
+    };
+};
+
+TEST_F(TestLFRWeights, strengthsAndMixing) {
+    constexpr node_t num_nodes = 300;
+    constexpr node_t community_size = 30;
+    constexpr double exponent = 1.5;
+    constexpr double weight_mixing = 0.2;
+
+    // dense communities of consecutive nodes joined by sparse random edges
+    std::mt19937_64 prng(1);
+    std::bernoulli_distribution intra_dist(0.3);
+    std::bernoulli_distribution inter_dist(0.02);
+
+    std::set<edge_t> edges;
+    std::vector<bool> intra;
+    for (node_t u = 0; u < num_nodes; u++) {
+        for (node_t v = u + 1; v < num_nodes; v++) {
+            const bool same_community = (u / community_size == v / community_size);
+            if (same_community ? intra_dist(prng) : inter_dist(prng)) {
+                edges.insert({u, v});
+                intra.push_back(same_community);
+            }
+        }
+    }
+
+    WeightedLFR lfr(num_nodes);
+    lfr.setWeighted(exponent, weight_mixing, 100);
+    lfr.assign_weights(edges, intra);
+
+    auto & weights = lfr.get_edge_weights();
+    ASSERT_EQ(weights.size(), edges.size());
+
+    std::vector<degree_t> degrees(num_nodes, 0);
+    std::vector<double> strengths(num_nodes, 0.0);
+    double inter_strength = 0.0;
+    double total_strength = 0.0;
+    {
+        size_t i = 0;
+        auto weight = weights.cbegin();
+        for (const auto & e : edges) {
+            ASSERT_GE(*weight, 0);
+            degrees[e.first]++;
+            degrees[e.second]++;
+            strengths[e.first] += *weight;
+            strengths[e.second] += *weight;
+            total_strength += 2 * *weight;
+            if (!intra[i])
+                inter_strength += 2 * *weight;
+            ++weight;
+            ++i;
+        }
+    }
+
+    // strengths are close to the powers of the degrees
+    double deviation = 0.0;
+    double wished_total = 0.0;
+    for (node_t u = 0; u < num_nodes; u++) {
+        const double wished = std::pow(static_cast<double>(degrees[u]), exponent);
+        deviation += std::abs(strengths[u] - wished);
+        wished_total += wished;
+    }
+    ASSERT_LT(deviation, 0.1 * wished_total);
+
+    // the share of the strength on inter-community edges is close to the weight mixing
+    ASSERT_NEAR(inter_strength / total_strength, weight_mixing, 0.05);
+}
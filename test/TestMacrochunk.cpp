@@ -9,6 +9,10 @@
 #include "defs.h"
 #include "Curveball/IMMacrochunk.h"
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
 class TestMacrochunk : public ::testing::Test {
 };
 
@@ -44,4 +48,48 @@ TEST_F(TestMacrochunk, insertion) {
 		ASSERT_EQ((*const_it).neighbour, 0ul);
 		ASSERT_EQ((*const_it).target, 0ul);
 	}
-}
\ No newline at end of file
+}
+
+TEST_F(TestMacrochunk, compressed_insertion) {
+	Curveball::IMMacrochunk msg_chunk(0, 200000, true);
+
+	// single messages and a bulk covering large and zero values
+	std::vector<Curveball::NeighbourMsg> sent;
+	for (int i = 0; i < 5000; i++) {
+		sent.emplace_back((i * 7919) % 3001, i);
+		msg_chunk.push_sequential(sent.back());
+	}
+
+	std::vector<Curveball::NeighbourMsg> bulk;
+	for (int i = 0; i < 3000; i++)
+		bulk.emplace_back(std::numeric_limits<Curveball::hnode_t>::max() - i, (i % 2 ? 0 : std::numeric_limits<node_t>::max()));
+	msg_chunk.bulk_push(bulk);
+	sent.insert(sent.end(), bulk.begin(), bulk.end());
+
+	ASSERT_EQ(msg_chunk.get_msg_count(), static_cast<Curveball::msgid_t>(sent.size()));
+
+	Curveball::msg_vector loaded_msgs;
+	ASSERT_TRUE(msg_chunk.load_messages(loaded_msgs));
+	ASSERT_EQ(loaded_msgs.size(), sent.size());
+
+	auto msg_less = [] (const Curveball::NeighbourMsg &a, const Curveball::NeighbourMsg &b) {
+		return std::tie(a.target, a.neighbour) < std::tie(b.target, b.neighbour);
+	};
+	std::sort(sent.begin(), sent.end(), msg_less);
+	std::sort(loaded_msgs.begin(), loaded_msgs.end(), msg_less);
+
+	for (size_t i = 0; i < sent.size(); i++) {
+		ASSERT_EQ(loaded_msgs[i].target, sent[i].target);
+		ASSERT_EQ(loaded_msgs[i].neighbour, sent[i].neighbour);
+	}
+
+	// a reset chunk is empty and stays compressed
+	msg_chunk.reset();
+	msg_chunk.push_sequential(Curveball::NeighbourMsg{3, 4});
+
+	Curveball::msg_vector reloaded_msgs;
+	ASSERT_TRUE(msg_chunk.load_messages(reloaded_msgs));
+	ASSERT_EQ(reloaded_msgs.size(), 1ul);
+	ASSERT_EQ(reloaded_msgs[0].target, 3);
+	ASSERT_EQ(reloaded_msgs[0].neighbour, 4);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <EdgeStream.h>
+#include <SwapGenerator.h>
+#include <EdgeSwaps/ParallelIMEdgeSwap.h>
+#include "CirculantGraph.h"
+
+class TestParallelIMEdgeSwap : public ::testing::Test {};
+
+TEST_F(TestParallelIMEdgeSwap, simpleGraphWithSameDegrees) {
+    constexpr node_t num_nodes = 20000;
+    constexpr node_t k = 4;
+
+    // circulant graph, i.e. each node is connected to its next k neighbours
+    const auto edge_list = circulant_graph(num_nodes, k);
+
+    for(int threads : {1, 4}) {
+        EdgeStream edge_stream;
+        for(const auto & e : edge_list)
+            edge_stream.push(e);
+        edge_stream.consume();
+
+        // large batches, s.t. levels are executed concurrently
+        uint_t batches = 0;
+        ParallelIMEdgeSwap algo(edge_stream, threads, edge_list.size() / 2, [&batches](uint_t) {batches++;});
+
+        for(SwapGenerator gen(4 * edge_list.size(), edge_list.size(), 1234 + threads); !gen.empty(); ++gen)
+            algo.push(*gen);
+        algo.run();
+
+        ASSERT_EQ(batches, 8u);
+        ASSERT_EQ(edge_stream.size(), edge_list.size());
+
+        std::vector<degree_t> degrees(num_nodes, 0);
+        edge_t last = edge_t::invalid();
+        uint_t unchanged = 0;
+        for(; !edge_stream.empty(); ++edge_stream) {
+            const auto & e = *edge_stream;
+            ASSERT_FALSE(e.is_loop());
+            ASSERT_TRUE(last.is_invalid() || last < e);
+            degrees[e.first]++;
+            degrees[e.second]++;
+            unchanged += std::binary_search(edge_list.cbegin(), edge_list.cend(), e);
+            last = e;
+        }
+
+        for(const auto & d : degrees)
+            ASSERT_EQ(d, 2 * k);
+
+        ASSERT_LT(unchanged, edge_list.size() / 10);
+
+#ifdef EDGE_SWAP_DEBUG_VECTOR
+        ASSERT_EQ(algo.debugVector().size(), 4 * edge_list.size());
+#endif
+    }
+}
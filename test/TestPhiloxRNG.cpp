@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <Utils/PhiloxRNG.h>
+
+class TestPhiloxRNG : public ::testing::Test {};
+
+TEST_F(TestPhiloxRNG, knownAnswer) {
+    // Random123 known answer test for philox4x32-10 with zero counter and key
+    PhiloxRNG rng(0, 0);
+    ASSERT_EQ(rng(), 0xe169c58d6627e8d5llu);
+    ASSERT_EQ(rng(), 0x9b00dbd8bc57ac4cllu);
+}
+
+TEST_F(TestPhiloxRNG, fillConsistentWithOperator) {
+    for(size_t offset : {0, 1, 31, 32, 33}) {
+        for(size_t n : {0, 1, 2, 63, 64, 1001}) {
+            PhiloxRNG a(1234, 5);
+            PhiloxRNG b(1234, 5);
+
+            for(size_t i = 0; i < offset; ++i)
+                ASSERT_EQ(a(), b());
+
+            std::vector<uint64_t> values(n);
+            a.fill(values.data(), n);
+            for(size_t i = 0; i < n; ++i)
+                ASSERT_EQ(values[i], b()) << "offset=" << offset << " i=" << i;
+
+            ASSERT_EQ(a(), b());
+        }
+    }
+}
+
+TEST_F(TestPhiloxRNG, streams) {
+    PhiloxRNG a(1234, 0);
+    PhiloxRNG b(1234, 1);
+    PhiloxRNG c(1235, 0);
+
+    unsigned int equal = 0;
+    for(int i = 0; i < 1000; ++i) {
+        const auto x = a();
+        equal += (x == b()) + (x == c());
+    }
+
+    ASSERT_EQ(equal, 0u);
+
+    a.seed(1234, 1);
+    PhiloxRNG d(1234, 1);
+    for(int i = 0; i < 100; ++i)
+        ASSERT_EQ(a(), d());
+}
+
+TEST_F(TestPhiloxRNG, bounded) {
+    constexpr uint64_t range = 10;
+    constexpr size_t n = 100000;
+
+    PhiloxRNG rng(1);
+    std::vector<int64_t> values(n);
+    rng.fill_bounded(values.data(), n, range);
+
+    std::vector<size_t> counts(range, 0);
+    for(const auto x : values) {
+        ASSERT_GE(x, 0);
+        ASSERT_LT(x, static_cast<int64_t>(range));
+        counts[x]++;
+    }
+
+    for(uint64_t i = 0; i < n; ++i)
+        counts[rng.bounded(range)]++;
+
+    // expected count is 2n/range = 20000 with a standard deviation of ~134
+    for(const auto c : counts) {
+        ASSERT_GT(c, 19000u);
+        ASSERT_LT(c, 21000u);
+    }
+}
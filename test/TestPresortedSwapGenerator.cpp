@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <EdgeStream.h>
+#include <EdgeSwaps/EdgeSwapTFP.h>
+#include <EdgeSwaps/PresortedSwapGenerator.h>
+#include "CirculantGraph.h"
+
+class TestPresortedSwapGenerator : public ::testing::Test {};
+
+TEST_F(TestPresortedSwapGenerator, orderAndPermutation) {
+    using Generator = PresortedSwapGenerator<EdgeSwapTFP::EdgeSwapMsg>;
+
+    for(swapid_t swaps : {1, 10, 1000, 100000}) {
+        for(edgeid_t edges : {2, 17, 100000}) {
+            Generator gen(swaps, edges, 1234 * swaps + edges);
+            ASSERT_EQ(gen.size(), 2u * swaps);
+
+            std::vector<bool> seen(2 * swaps, false);
+            EdgeSwapTFP::EdgeSwapMsg last(-1, 0);
+
+            for(; !gen.empty(); ++gen) {
+                const auto & msg = *gen;
+                ASSERT_LT(last, msg);
+                ASSERT_GE(msg.edge_id, 0);
+                ASSERT_LT(msg.edge_id, edges);
+                ASSERT_LT(msg.swap_id, 2 * swaps);
+                ASSERT_FALSE(seen[msg.swap_id]);
+                seen[msg.swap_id] = true;
+                last = msg;
+            }
+
+            for(const bool s : seen)
+                ASSERT_TRUE(s);
+        }
+    }
+}
+
+TEST_F(TestPresortedSwapGenerator, edgeSwapTFP) {
+    constexpr node_t num_nodes = 1000;
+    constexpr node_t k = 4;
+
+    // circulant graph, i.e. each node is connected to its next k neighbours
+    const auto edge_list = circulant_graph(num_nodes, k);
+
+    EdgeStream edge_stream;
+    for(const auto & e : edge_list)
+        edge_stream.push(e);
+    edge_stream.consume();
+
+    EdgeSwapTFP::EdgeSwapTFP algo(edge_stream, edge_list.size() / 4, num_nodes, 1llu << 30);
+    algo.runPresorted(4 * edge_list.size(), 1234);
+
+    // the result has to be a simple graph with the same degree sequence
+    ASSERT_EQ(edge_stream.size(), edge_list.size());
+
+    std::vector<degree_t> degrees(num_nodes, 0);
+    edge_t last = edge_t::invalid();
+    uint_t unchanged = 0;
+    for(; !edge_stream.empty(); ++edge_stream) {
+        const auto & e = *edge_stream;
+        ASSERT_FALSE(e.is_loop());
+        ASSERT_TRUE(last.is_invalid() || last < e);
+        degrees[e.first]++;
+        degrees[e.second]++;
+        unchanged += std::binary_search(edge_list.cbegin(), edge_list.cend(), e);
+        last = e;
+    }
+
+    for(const auto & d : degrees)
+        ASSERT_EQ(d, 2 * k);
+
+    ASSERT_LT(unchanged, edge_list.size() / 2);
+}
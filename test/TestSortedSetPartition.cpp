@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <Curveball/SortedSetPartition.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using CurveballImpl::SetPartitionKernel;
+
+class TestSortedSetPartition : public ::testing::TestWithParam<SetPartitionKernel> {
+protected:
+    void SetUp() override {
+        const SetPartitionKernel best = CurveballImpl::best_set_partition_kernel();
+        if (static_cast<int>(GetParam()) > static_cast<int>(best))
+            skipped = true;
+    }
+
+    bool skipped = false;
+
+    std::vector<node_t> _random_set(std::mt19937_64 & prng, size_t size, node_t max) {
+        std::uniform_int_distribution<node_t> distr(0, max);
+        std::vector<node_t> set;
+        for (size_t i = 0; i < size; i++)
+            set.push_back(distr(prng));
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+        return set;
+    }
+
+    void _check(const std::vector<node_t> & a, const std::vector<node_t> & b) {
+        std::vector<node_t> common;
+        std::vector<node_t> disjoint;
+        CurveballImpl::sorted_set_partition(a.cbegin(), a.cend(), b.cbegin(), b.cend(),
+                                            common, disjoint, GetParam());
+
+        std::vector<node_t> expected_common;
+        std::vector<node_t> expected_disjoint;
+        std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(),
+                              std::back_inserter(expected_common));
+        std::set_difference(a.cbegin(), a.cend(), b.cbegin(), b.cend(),
+                            std::back_inserter(expected_disjoint));
+        std::set_difference(b.cbegin(), b.cend(), a.cbegin(), a.cend(),
+                            std::back_inserter(expected_disjoint));
+
+        ASSERT_EQ(common, expected_common);
+        ASSERT_EQ(disjoint, expected_disjoint);
+    }
+};
+
+TEST_P(TestSortedSetPartition, smallSets) {
+    if (skipped) return;
+
+    _check({}, {});
+    _check({1, 2, 3}, {});
+    _check({}, {1, 2, 3});
+    _check({1, 2, 3, 4, 5, 6, 7, 8, 9}, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+    _check({0, 2, 4, 6, 8, 10, 12, 14, 16}, {1, 3, 5, 7, 9, 11, 13, 15, 17});
+}
+
+TEST_P(TestSortedSetPartition, randomSets) {
+    if (skipped) return;
+
+    std::mt19937_64 prng(GetParam() == SetPartitionKernel::Scalar ? 1 : 2);
+    for (size_t size : {5, 17, 100, 1000, 10000}) {
+        for (node_t max : {10, 100, 100000}) {
+            const auto a = _random_set(prng, size, max);
+            const auto b = _random_set(prng, size / 3 + 1, max);
+            _check(a, b);
+            _check(b, a);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(TestSortedSetPartitionKernels, TestSortedSetPartition,
+                        ::testing::Values(SetPartitionKernel::Scalar,
+                                          SetPartitionKernel::SSE4,
+                                          SetPartitionKernel::AVX2));
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <EdgeStream.h>
+#include <EdgeSwaps/SwapConvergenceMonitor.h>
+#include "CirculantGraph.h"
+
+class TestSwapConvergenceMonitor : public ::testing::Test {
+protected:
+    constexpr static node_t num_nodes = 1000;
+
+    //! Fills the stream with a circulant graph, i.e. every node is connected to the next (u+offset) nodes
+    void _circulant(EdgeStream & edges, node_t offset, node_t k) const {
+        edges.clear();
+        for(const auto & e : circulant_graph(num_nodes, k, false, offset))
+            edges.push(e);
+        edges.consume();
+    }
+};
+
+TEST_F(TestSwapConvergenceMonitor, disabled) {
+    EdgeStream edges;
+    _circulant(edges, 1, 3);
+
+    SwapConvergenceMonitor monitor(num_nodes);
+    for(int i = 0; i < 5; ++i)
+        ASSERT_FALSE(monitor.observe(edges));
+}
+
+TEST_F(TestSwapConvergenceMonitor, edgesChanged) {
+    EdgeStream edges;
+    _circulant(edges, 1, 3);
+
+    SwapConvergenceMonitor::Config config;
+    config.min_edges_changed = 0.9;
+    SwapConvergenceMonitor monitor(num_nodes, config);
+
+    // first observation stores initial graph
+    ASSERT_FALSE(monitor.observe(edges));
+    ASSERT_FALSE(monitor.observe(edges));
+    ASSERT_DOUBLE_EQ(monitor.edgesChanged(), 0.0);
+
+    // stream is rewound after observation
+    ASSERT_FALSE(edges.empty());
+
+    // same degree sequence, but all edges differ
+    _circulant(edges, 100, 3);
+    ASSERT_TRUE(monitor.observe(edges));
+    ASSERT_GE(monitor.edgesChanged(), 0.9);
+    ASSERT_TRUE(monitor.converged());
+}
+
+TEST_F(TestSwapConvergenceMonitor, interval) {
+    EdgeStream edges;
+    _circulant(edges, 1, 3);
+
+    SwapConvergenceMonitor::Config config;
+    config.min_edges_changed = 0.9;
+    config.interval = 3;
+    SwapConvergenceMonitor monitor(num_nodes, config);
+
+    ASSERT_FALSE(monitor.observe(edges));
+    _circulant(edges, 100, 3);
+
+    ASSERT_FALSE(monitor.observe(edges));
+    ASSERT_FALSE(monitor.observe(edges));
+    ASSERT_TRUE(monitor.observe(edges));
+}
+
+TEST_F(TestSwapConvergenceMonitor, assortativityWindow) {
+    EdgeStream edges;
+    _circulant(edges, 1, 3);
+
+    SwapConvergenceMonitor::Config config;
+    config.assortativity_tolerance = 1e-3;
+    config.assortativity_window = 3;
+    SwapConvergenceMonitor monitor(num_nodes, config);
+
+    ASSERT_FALSE(monitor.observe(edges));
+
+    // regular graph, so assortativity is constant; criterion met after a full window
+    ASSERT_FALSE(monitor.observe(edges));
+    ASSERT_FALSE(monitor.observe(edges));
+    ASSERT_TRUE(monitor.observe(edges));
+}